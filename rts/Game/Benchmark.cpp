@@ -10,7 +10,11 @@
 #include "Rendering/GlobalRendering.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Features/FeatureHandler.h"
+#include "Sim/Path/IPathManager.h"
+#include "Sim/Projectiles/ProjectileHandler.h"
+#include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
+#include "System/Sync/SyncChecker.h"
 
 static std::map<float, float> realFPS;
 static std::map<float, float> drawFPS;
@@ -20,19 +24,78 @@ static std::map<int, size_t>  features;
 static std::map<int, float>   gameSpeed;
 static std::map<int, float>   luaUsage;
 
+// timers (see SCOPED_TIMER) whose per-SimFrame deltas are written by WriteTimings
+static const char* simTimerNames[] = {
+	"SimFrame",
+	"EventHandler::GameFrame",
+	"PathManager::Update",
+	"UnitHandler::Update",
+	"Unit::MoveType::Update",
+	"Unit::MoveType::UpdateCompute",
+	"Unit::Update",
+	"Unit::SlowUpdate",
+	"Unit::UpdatePieceMatrices",
+	"ProjectileHandler::CheckCollisions",
+	"ProjectileHandler::Update",
+	"FeatureHandler::Update",
+	"CobEngine::Tick",
+	"UnitScriptEngine::Tick",
+	"LOSHandler::Update",
+	"LOSHandler::UpdatePendingLosAdds",
+};
+
+static const size_t numSimTimers = sizeof(simTimerNames) / sizeof(simTimerNames[0]);
+
+static unsigned int GetSyncChecksum()
+{
+#ifdef SYNCCHECK
+	// running checksum over the synced state, as sent in SYNCRESPONSE's
+	return CSyncChecker::GetChecksum();
+#else
+	return 0;
+#endif
+}
+
 bool CBenchmark::enabled = false;
 int CBenchmark::startFrame = 0;
 int CBenchmark::endFrame = 5 * 60 * GAME_SPEED;
+std::string CBenchmark::timingsFileName;
+std::string CBenchmark::pathSearchesFileName;
 
 
 CBenchmark::CBenchmark()
 	: CEventClient("[CBenchmark]", 271990, false)
+	, timingsFile(NULL)
+	, lastTimerTotals(numSimTimers, spring_notime)
 {
 	eventHandler.AddClient(this);
+
+	if (timingsFileName.empty())
+		return;
+
+	if ((timingsFile = fopen(timingsFileName.c_str(), "w")) == NULL) {
+		LOG_L(L_ERROR, "[%s] could not open \"%s\" for writing", __FUNCTION__, timingsFileName.c_str());
+		return;
+	}
+
+	// one tab-separated row per SimFrame, all times in milliseconds
+	// the sync checksum lets runs with different (unsynced) settings, e.g.
+	// MultiThreadedUnitUpdate, be checked for identical simulation results
+	fprintf(timingsFile, "frame\tsync_checksum\tnum_units\tnum_features\tnum_projectiles");
+
+	for (size_t n = 0; n < numSimTimers; n++) {
+		fprintf(timingsFile, "\t%s", simTimerNames[n]);
+	}
+
+	fprintf(timingsFile, "\n");
 }
 
 CBenchmark::~CBenchmark()
 {
+	if (timingsFile != NULL) {
+		fclose(timingsFile);
+	}
+
 	FILE* pFile = fopen("benchmark.data", "w");
 	std::map<float, float>::const_iterator rit = realFPS.begin();
 	std::map<float, float>::const_iterator dit = drawFPS.begin();
@@ -61,22 +124,73 @@ CBenchmark::~CBenchmark()
 	fclose(pFile);
 }
 
+void CBenchmark::WriteTimings(int simFrame)
+{
+	fprintf(timingsFile, "%d\t%08x\t" _STPF_ "\t" _STPF_ "\t" _STPF_, simFrame,
+		GetSyncChecksum(),
+		unitHandler->units.size(),
+		featureHandler->GetActiveFeatures().size(),
+		projectileHandler->syncedProjectiles.size());
+
+	for (size_t n = 0; n < numSimTimers; n++) {
+		const spring_time total = profiler.GetTotal(simTimerNames[n]);
+
+		fprintf(timingsFile, "\t%.3f", (total - lastTimerTotals[n]).toMilliSecsf());
+		lastTimerTotals[n] = total;
+	}
+
+	fprintf(timingsFile, "\n");
+}
+
 void CBenchmark::GameFrame(int gameFrame)
 {
-	if (gameFrame == 0 && (startFrame - 45 * GAME_SPEED > 0)) {
+	if (WantsTimings()) {
+		// run the whole replay as fast as the simulation allows
+		if (gameFrame == 0) {
+			std::vector<string> cmds;
+			cmds.push_back("@@setmaxspeed 100");
+			cmds.push_back("@@setminspeed 100");
+			guihandler->RunCustomCommands(cmds, false);
+		}
+
+		// GameFrame(N) is sent before the sim-updates of frame N run,
+		// so the profiler deltas seen here belong to frame N-1
+		if (timingsFile != NULL) {
+			if (gameFrame > startFrame && gameFrame <= (endFrame + 1)) {
+				WriteTimings(gameFrame - 1);
+			} else {
+				// discard everything accumulated before the measured range
+				for (size_t n = 0; n < numSimTimers; n++) {
+					lastTimerTotals[n] = profiler.GetTotal(simTimerNames[n]);
+				}
+			}
+		}
+	} else if (gameFrame == 0 && (startFrame - 45 * GAME_SPEED > 0)) {
 		std::vector<string> cmds;
 		cmds.push_back("@@setmaxspeed 100");
 		cmds.push_back("@@setminspeed 100");
 		guihandler->RunCustomCommands(cmds, false);
 	}
 
-	if (gameFrame == (startFrame - 45 * GAME_SPEED)) {
+	if (!WantsTimings() && gameFrame == (startFrame - 45 * GAME_SPEED)) {
 		std::vector<string> cmds;
 		cmds.push_back("@@setminspeed 1");
 		cmds.push_back("@@setmaxspeed 1");
 		guihandler->RunCustomCommands(cmds, false);
 	}
 
+	// once, on the map as it is when measuring starts
+	if (gameFrame == startFrame && !pathSearchesFileName.empty()) {
+		FILE* pathSearchesFile = fopen(pathSearchesFileName.c_str(), "w");
+
+		if (pathSearchesFile != NULL) {
+			pathManager->BenchmarkSearches(pathSearchesFile);
+			fclose(pathSearchesFile);
+		} else {
+			LOG_L(L_ERROR, "[%s] could not open \"%s\" for writing", __FUNCTION__, pathSearchesFileName.c_str());
+		}
+	}
+
 	if (gameFrame >= startFrame) {
 		simFPS[gameFrame] = (gu->avgSimFrameTime == 0.0f)? 0.0f: 1000.0f / gu->avgSimFrameTime;
 		units[gameFrame] = unitHandler->units.size();
@@ -85,7 +199,8 @@ void CBenchmark::GameFrame(int gameFrame)
 		luaUsage[gameFrame] = profiler.GetPercent("Lua");
 	}
 
-	if (gameFrame == endFrame) {
+	// with timings enabled, stay one more frame to also catch those of endFrame
+	if (gameFrame == (WantsTimings()? endFrame + 1: endFrame)) {
 		gu->globalQuit = true;
 	}
 }
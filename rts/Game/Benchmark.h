@@ -4,6 +4,9 @@
 #define _ROAM_MESH_DRAWER_H_
 
 #include "System/EventHandler.h"
+#include "System/Misc/SpringTime.h"
+#include <cstdio>
+#include <string>
 #include <vector>
 
 
@@ -14,6 +17,14 @@ public:
 	static int startFrame;
 	static int endFrame;
 
+	/// if non-empty, per-SimFrame subsystem timings are written here
+	static std::string timingsFileName;
+	/// if non-empty, the costs of a fixed set of path-searches are written here
+	static std::string pathSearchesFileName;
+
+	/// true if the simulation should run unthrottled (no speed changes, no headless sleeps)
+	static bool WantsTimings() { return (enabled && !timingsFileName.empty()); }
+
 public:
 	// CEventClient interface
 	bool WantsEvent(const std::string& eventName) {
@@ -28,6 +39,15 @@ public:
 public:
 	CBenchmark();
 	~CBenchmark();
+
+private:
+	void WriteTimings(int simFrame);
+
+private:
+	FILE* timingsFile;
+
+	/// profiler totals as of the previous GameFrame event, one per timer
+	std::vector<spring_time> lastTimerTotals;
 };
 
 #endif // _ROAM_MESH_DRAWER_H_
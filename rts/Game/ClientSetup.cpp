@@ -20,6 +20,7 @@ static const std::string DEFAULT_HOST_PORT_STR = IntToString(DEFAULT_HOST_PORT);
 ClientSetup::ClientSetup()
 	: hostIP(DEFAULT_HOST_IP)
 	, hostPort(DEFAULT_HOST_PORT)
+	, relayHostPort(DEFAULT_HOST_PORT)
 	, isHost(false)
 {
 }
@@ -48,6 +49,9 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 	file.GetDef(hostIP,       DEFAULT_HOST_IP,       "GAME\\HostIP");
 	file.GetDef(hostPort,     DEFAULT_HOST_PORT_STR, "GAME\\HostPort");
 
+	file.GetDef(relayHostIP,   "",                    "GAME\\RelayHostIP");
+	file.GetDef(relayHostPort, DEFAULT_HOST_PORT_STR, "GAME\\RelayHostPort");
+
 	file.GetDef(myPlayerName, "", "GAME\\MyPlayerName");
 	file.GetDef(myPasswd,     "", "GAME\\MyPasswd");
 
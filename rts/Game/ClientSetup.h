@@ -25,6 +25,12 @@ public:
 	//! if this client is the server player, the port over which we accept incoming connections
 	int hostPort;
 
+	//! if set, the dedicated server relays the game hosted at this address
+	//! (as a spectator) instead of hosting one; hostIP and hostPort are then
+	//! where it accepts its own spectators
+	std::string relayHostIP;
+	int relayHostPort;
+
 	bool isHost;
 };
 
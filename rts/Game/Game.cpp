@@ -145,6 +145,7 @@
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/VFSHandler.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
 #include "System/Net/PackPacket.h"
@@ -172,6 +173,7 @@ CONFIG(int, ShowPlayerInfo).defaultValue(1);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
 CONFIG(bool, LuaModUICtrl).defaultValue(true);
+CONFIG(int, DemoKeyframeInterval).defaultValue(0).minimumValue(0).description("While watching a demo, write a savegame every N seconds of game-time to demos/keyframes/. Loading one of these resumes the demo from that point. 0 disables.");
 
 
 CGame* game = NULL;
@@ -341,6 +343,7 @@ CGame::CGame(const std::string& mapName, const std::string& modName, ILoadSaveHa
 	, skipOldUserSpeed(0.0f)
 	, skipLastDrawTime(spring_gettime())
 	, speedControl(-1)
+	, demoKeyframeInterval(0)
 	, infoConsole(NULL)
 	, consoleHistory(NULL)
 	, worldDrawer(NULL)
@@ -367,6 +370,9 @@ CGame::CGame(const std::string& mapName, const std::string& modName, ILoadSaveHa
 
 	speedControl = configHandler->GetInt("SpeedControl");
 
+	if (gameSetup->hostDemo)
+		demoKeyframeInterval = configHandler->GetInt("DemoKeyframeInterval") * GAME_SPEED;
+
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
 	CInputReceiver::guiAlpha = configHandler->GetFloat("GuiOpacity");
@@ -1568,7 +1574,8 @@ void CGame::SimFrame() {
 	eventHandler.DbgTimingInfo(TIMING_SIM, lastFrameTime, lastSimFrameTime);
 
 	#ifdef HEADLESS
-	{
+	// benchmark timings want the replay to run as fast as possible
+	if (!CBenchmark::WantsTimings()) {
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
 		const float msecDifSimFrameTime = (lastSimFrameTime - lastFrameTime).toMilliSecsf();
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
@@ -1583,6 +1590,10 @@ void CGame::SimFrame() {
 	// usefull for desync-debugging enter (enter instead of -1 start & end frame of the range you want to debug)
 	DumpState(-1, -1, 1);
 
+	if (demoKeyframeInterval > 0 && (gs->frameNum % demoKeyframeInterval) == 0) {
+		SaveDemoKeyframe();
+	}
+
 	LEAVE_SYNCED_CODE();
 }
 
@@ -1947,6 +1958,21 @@ void CGame::SaveGame(const std::string& filename, bool overwrite)
 }
 
 
+void CGame::SaveDemoKeyframe()
+{
+	const std::string fileName = CDemo::GetKeyframeFileName(gameSetup->demoName, gs->frameNum);
+
+	if (!FileSystem::CreateDirectory(FileSystem::GetDirectory(fileName)))
+		return;
+
+	// always creg, the Lua handler does not capture the full sim-state
+	CCregLoadSaveHandler ls;
+	ls.mapName = gameSetup->mapName;
+	ls.modName = gameSetup->modName;
+	ls.SaveGame(fileName);
+}
+
+
 void CGame::ReloadGame()
 {
 	if (saveFile) {
@@ -94,6 +94,7 @@ public:
 
 	void ReloadGame();
 	void SaveGame(const std::string& filename, bool overwrite);
+	void SaveDemoKeyframe();
 
 	void ResizeEvent();
 	void SetupRenderingParams();
@@ -209,6 +210,9 @@ public:
 	 */
 	int speedControl;
 
+	/// frames between demo keyframe savegames, 0 if disabled or not watching a demo
+	int demoKeyframeInterval;
+
 	CInfoConsole* infoConsole;
 	CConsoleHistory* consoleHistory;
 
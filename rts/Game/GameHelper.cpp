@@ -51,6 +51,7 @@ CGameHelper* helper;
 
 
 CGameHelper::CGameHelper()
+	: targetCandidatesQuadField(NULL)
 {
 	stdExplosionGenerator = new CStdExplosionGenerator();
 	waitingDamageLists.resize(NUM_WAITING_DAMAGE_LISTS);
@@ -367,8 +368,8 @@ static inline void QueryUnits(TFilter filter, TQuery& query)
 			if (!filter.Team(t)) {
 				continue;
 			}
-			std::list<CUnit*>::const_iterator ui;
-			const std::list<CUnit*>& allyTeamUnits = quad.teamUnits[t];
+			std::vector<CUnit*>::const_iterator ui;
+			const std::vector<CUnit*>& allyTeamUnits = quad.teamUnits[t];
 			for (ui = allyTeamUnits.begin(); ui != allyTeamUnits.end(); ++ui) {
 				if ((*ui)->tempNum != tempNum) {
 					(*ui)->tempNum = tempNum;
@@ -636,7 +637,51 @@ namespace {
 static int tempTargetUnits[MAX_UNITS] = {0};
 static int targetTempNum = 2;
 
-void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, std::multimap<float, CUnit*>& targets)
+CUnit* CGameHelper::WeaponTargetQueue::pop()
+{
+	assert(!empty());
+
+	const size_t heapSize = size();
+
+	if (!heapified) {
+		std::make_heap(entries.begin(), entries.end());
+		heapified = true;
+	}
+
+	std::pop_heap(entries.begin(), entries.begin() + heapSize);
+	numPopped++;
+
+	return entries[heapSize - 1].unit;
+}
+
+
+const std::vector<CUnit*>& CGameHelper::GetEnemyTargetCandidates(int allyTeam, int quadIdx)
+{
+	const int numQuads = quadField->GetNumQuadsX() * quadField->GetNumQuadsZ();
+	const int numAllyTeams = teamHandler->ActiveAllyTeams();
+
+	const CQuadField::Quad& quad = quadField->GetQuad(quadIdx);
+	TargetCandidates& candidates = targetCandidates[allyTeam * numQuads + quadIdx];
+
+	if (candidates.frameNum == gs->frameNum && candidates.quadVersion == quad.unitsVersion)
+		return candidates.units;
+
+	candidates.frameNum = gs->frameNum;
+	candidates.quadVersion = quad.unitsVersion;
+	candidates.units.clear();
+
+	for (int t = 0; t < numAllyTeams; ++t) {
+		if (teamHandler->Ally(allyTeam, t))
+			continue;
+
+		candidates.units.insert(candidates.units.end(), quad.teamUnits[t].begin(), quad.teamUnits[t].end());
+	}
+
+	return candidates.units;
+}
+
+
+void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, WeaponTargetQueue& targets)
 {
 	const CUnit* attacker = weapon->owner;
 	const float radius    = weapon->range;
@@ -650,107 +695,118 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* last
 	const float secDamage = weaponDef->damages.GetDefaultDamage() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
 	const bool paralyzer  = (weaponDef->damages.paralyzeDamageTime != 0);
 
-	const std::vector<int>& quads = quadField->GetQuads(pos, radius + (aHeight - std::max(0.0f, readMap->GetInitMinHeight())) * heightMod);
+	{
+		// (re)size the caches for the current quadfield
+		const unsigned int numQuads = quadField->GetNumQuadsX() * quadField->GetNumQuadsZ();
+		const unsigned int numAllyTeams = teamHandler->ActiveAllyTeams();
 
-	const int tempNum = targetTempNum++;
+		if (targetCandidatesQuadField != quadField || targetCandidates.size() != (numQuads * numAllyTeams)) {
+			targetCandidates.clear();
+			targetCandidates.resize(numQuads * numAllyTeams);
+			targetQuads.resize(numQuads);
 
-	typedef std::vector<int>::const_iterator VectorIt;
-	typedef std::list<CUnit*>::const_iterator ListIt;
+			targetCandidatesQuadField = quadField;
+		}
+	}
 
-	for (VectorIt qi = quads.begin(); qi != quads.end(); ++qi) {
-		for (int t = 0; t < teamHandler->ActiveAllyTeams(); ++t) {
-			if (teamHandler->Ally(attacker->allyteam, t)) {
-				continue;
-			}
+	int* begQuad = &targetQuads[0];
+	int* endQuad = &targetQuads[0];
 
-			const std::list<CUnit*>& allyTeamUnits = quadField->GetQuad(*qi).teamUnits[t];
+	quadField->GetQuads(pos, radius + (aHeight - std::max(0.0f, readMap->GetInitMinHeight())) * heightMod, begQuad, endQuad);
 
-			for (ListIt ui = allyTeamUnits.begin(); ui != allyTeamUnits.end(); ++ui) {
-				CUnit* targetUnit = *ui;
-				float targetPriority = 1.0f;
+	const int tempNum = targetTempNum++;
 
-				if (!(targetUnit->category & weapon->onlyTargetCategory)) {
-					continue;
-				}
-				if (targetUnit->GetTransporter() != NULL) {
-					if (!modInfo.targetableTransportedUnits)
-						continue;
-					// the transportee might be "hidden" below terrain, in which case we can't target it
-					if (targetUnit->pos.y < CGround::GetHeightReal(targetUnit->pos.x, targetUnit->pos.z))
-						continue;
-				}
-				if (tempTargetUnits[targetUnit->id] == tempNum) {
-					continue;
-				}
+	typedef std::vector<CUnit*>::const_iterator ListIt;
 
-				tempTargetUnits[targetUnit->id] = tempNum;
+	for (const int* qi = begQuad; qi != endQuad; ++qi) {
+		// all enemies of attacker->allyteam in this quad, in ally-team order
+		const std::vector<CUnit*>& candidates = GetEnemyTargetCandidates(attacker->allyteam, *qi);
 
-				if (targetUnit->IsUnderWater() && !weaponDef->waterweapon) {
+		for (ListIt ui = candidates.begin(); ui != candidates.end(); ++ui) {
+			CUnit* targetUnit = *ui;
+			float targetPriority = 1.0f;
+
+			if (!(targetUnit->category & weapon->onlyTargetCategory)) {
+				continue;
+			}
+			if (targetUnit->GetTransporter() != NULL) {
+				if (!modInfo.targetableTransportedUnits)
 					continue;
-				}
-				if (targetUnit->isDead) {
+				// the transportee might be "hidden" below terrain, in which case we can't target it
+				if (targetUnit->pos.y < CGround::GetHeightReal(targetUnit->pos.x, targetUnit->pos.z))
 					continue;
-				}
+			}
+			if (tempTargetUnits[targetUnit->id] == tempNum) {
+				continue;
+			}
 
-				float3 targPos;
-				const unsigned short targetLOSState = targetUnit->losStatus[attacker->allyteam];
+			tempTargetUnits[targetUnit->id] = tempNum;
 
-				if (targetLOSState & LOS_INLOS) {
-					targPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targPos = targetUnit->aimPos + (targetUnit->posErrorVector * radarHandler->GetAllyTeamRadarErrorSize(attacker->allyteam));
-					targetPriority *= 10.0f;
-				} else {
-					continue;
-				}
+			if (targetUnit->IsUnderWater() && !weaponDef->waterweapon) {
+				continue;
+			}
+			if (targetUnit->isDead) {
+				continue;
+			}
 
-				const float modRange = radius + (aHeight - targPos.y) * heightMod;
+			float3 targPos;
+			const unsigned short targetLOSState = targetUnit->losStatus[attacker->allyteam];
 
-				if ((pos - targPos).SqLength2D() > modRange * modRange) {
-					continue;
-				}
+			if (targetLOSState & LOS_INLOS) {
+				targPos = targetUnit->aimPos;
+			} else if (targetLOSState & LOS_INRADAR) {
+				targPos = targetUnit->aimPos + (targetUnit->posErrorVector * radarHandler->GetAllyTeamRadarErrorSize(attacker->allyteam));
+				targetPriority *= 10.0f;
+			} else {
+				continue;
+			}
 
-				const float dist2D = (pos - targPos).Length2D();
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = weaponDef->damages[targetUnit->armorType] * targetUnit->curArmorMultiple;
+			const float modRange = radius + (aHeight - targPos.y) * heightMod;
 
-				targetPriority *= rangeMul;
+			if ((pos - targPos).SqLength2D() > modRange * modRange) {
+				continue;
+			}
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+			const float dist2D = (pos - targPos).Length2D();
+			const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+			const float damageMul = weaponDef->damages[targetUnit->armorType] * targetUnit->curArmorMultiple;
 
-					if (targetUnit == lastTargetUnit) {
-						targetPriority *= weapon->avoidTarget ? 10.0f : 0.4f;
-					}
+			targetPriority *= rangeMul;
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health)) {
-						targetPriority *= 4.0f;
-					}
+			if (targetLOSState & LOS_INLOS) {
+				targetPriority *= (secDamage + targetUnit->health);
 
-					if (weapon->hasTargetWeight) {
-						targetPriority *= weapon->TargetWeight(targetUnit);
-					}
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
+				if (targetUnit == lastTargetUnit) {
+					targetPriority *= weapon->avoidTarget ? 10.0f : 0.4f;
 				}
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power * (0.7f + gs->randFloat() * 0.6f));
+				if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health)) {
+					targetPriority *= 4.0f;
+				}
 
-					if (targetUnit->category & weapon->badTargetCategory) {
-						targetPriority *= 100.0f;
-					}
-					if (targetUnit->IsCrashing()) {
-						targetPriority *= 1000.0f;
-					}
+				if (weapon->hasTargetWeight) {
+					targetPriority *= weapon->TargetWeight(targetUnit);
 				}
+			} else {
+				targetPriority *= (secDamage + 10000.0f);
+			}
 
-				if (!eventHandler.AllowWeaponTarget(attacker->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority)) {
-					continue;
+			if (targetLOSState & LOS_PREVLOS) {
+				targetPriority /= (damageMul * targetUnit->power * (0.7f + gs->randFloat() * 0.6f));
+
+				if (targetUnit->category & weapon->badTargetCategory) {
+					targetPriority *= 100.0f;
 				}
+				if (targetUnit->IsCrashing()) {
+					targetPriority *= 1000.0f;
+				}
+			}
 
-				targets.insert(std::pair<float, CUnit*>(targetPriority, targetUnit));
+			if (!eventHandler.AllowWeaponTarget(attacker->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority)) {
+				continue;
 			}
+
+			targets.push(targetPriority, targetUnit);
 		}
 	}
 
@@ -758,8 +814,9 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* last
 	{
 		tracefile << "[GenerateWeaponTargets] attackerID, attackRadius: " << attacker->id << ", " << radius << " ";
 
-		for (std::multimap<float, CUnit*>::const_iterator ti = targets.begin(); ti != targets.end(); ++ti)
-			tracefile << "\tpriority: " << (ti->first) <<  ", targetID: " << (ti->second)->id <<  " ";
+		targets.for_each([](float priority, const CUnit* unit) {
+			tracefile << "\tpriority: " << priority <<  ", targetID: " << unit->id <<  " ";
+		});
 
 		tracefile << "\n";
 	}
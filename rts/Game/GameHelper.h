@@ -10,11 +10,13 @@
 #include "System/type2.h"
 #include "System/MemPool.h"
 
+#include <cassert>
 #include <list>
 #include <map>
 #include <vector>
 
 class CGame;
+class CQuadField;
 class CUnit;
 class CWeapon;
 class CSolidObject;
@@ -64,6 +66,61 @@ public:
 		unsigned int projectileID;
 	};
 
+	/**
+	 * Candidate targets of a weapon, handed out in INCREASING order of
+	 * priority (lower is better) and in insertion order among equal
+	 * priorities, ie. the order std::multimap gave before. The entries
+	 * are only heapified on the first pop so callers that stop after a
+	 * few acceptable targets never sort the rest; the storage is kept
+	 * between uses.
+	 */
+	class WeaponTargetQueue {
+	public:
+		WeaponTargetQueue(): numPopped(0), heapified(false) {}
+
+		void clear() {
+			entries.clear();
+			numPopped = 0;
+			heapified = false;
+		}
+		void push(float priority, CUnit* unit) {
+			assert(!heapified);
+			entries.push_back(Entry(priority, entries.size(), unit));
+		}
+
+		bool empty() const { return (numPopped == entries.size()); }
+		size_t size() const { return (entries.size() - numPopped); }
+
+		CUnit* pop();
+
+		/// unordered view of the remaining entries
+		template<typename F> void for_each(F f) const {
+			for (size_t n = 0; n < size(); n++) {
+				f(entries[n].priority, entries[n].unit);
+			}
+		}
+
+	private:
+		struct Entry {
+			Entry(float p, unsigned int o, CUnit* u): priority(p), order(o), unit(u) {}
+
+			// "a > b" for a min-heap with std::{make,pop}_heap
+			bool operator < (const Entry& e) const {
+				if (priority != e.priority)
+					return (priority > e.priority);
+				return (order > e.order);
+			}
+
+			float priority;
+			unsigned int order;
+			CUnit* unit;
+		};
+
+		std::vector<Entry> entries;
+		size_t numPopped;
+		bool heapified;
+	};
+
 	CGameHelper();
 	~CGameHelper();
 
@@ -119,7 +176,7 @@ public:
 	 */
 	static float3 ClosestBuildSite(int team, const UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0);
 
-	static void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, std::multimap<float, CUnit*>& targets);
+	void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, WeaponTargetQueue& targets);
 
 	void Update();
 
@@ -151,9 +208,31 @@ public:
 	void DamageObjectsInExplosionRadius(const ExplosionParams& params, const float expRad, const int weaponDefID);
 	void Explosion(const ExplosionParams& params);
 
+private:
+	const std::vector<CUnit*>& GetEnemyTargetCandidates(int allyTeam, int quadIdx);
+
 private:
 	CStdExplosionGenerator* stdExplosionGenerator;
 
+	/**
+	 * Units in one quad that belong to any enemy of some ally-team, in the
+	 * order GenerateWeaponTargets used to visit them. Shared by all weapons
+	 * (of that ally-team) that cover the quad during one frame; rebuilt if
+	 * the quad's unit-list changed in between.
+	 */
+	struct TargetCandidates {
+		TargetCandidates(): frameNum(-1), quadVersion(0) {}
+
+		int frameNum;
+		unsigned int quadVersion;
+		std::vector<CUnit*> units;
+	};
+
+	/// indexed by allyTeam * numQuads + quadIdx
+	std::vector<TargetCandidates> targetCandidates;
+	std::vector<int> targetQuads;
+	const CQuadField* targetCandidatesQuadField;
+
 	struct WaitingDamage {
 #if !defined(SYNCIFY)
 		inline void* operator new(size_t size) {
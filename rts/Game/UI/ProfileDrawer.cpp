@@ -18,6 +18,7 @@
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Units/Scripts/CobEngine.h"
 #include "lib/lua/include/LuaUser.h"
 
 ProfileDrawer* ProfileDrawer::instance = NULL;
@@ -354,7 +355,7 @@ static void DrawInfoText()
 	    globalRendering->FPS, gu->simFPS, gs->frameNum, gs->speedFactor, gs->wantedSpeedFactor, projectileHandler->syncedProjectiles.size() + projectileHandler->unsyncedProjectiles.size(), projectileHandler->currentParticles);
 
 	// 16ms := 60fps := 30simFPS + 30drawFPS
-	font->glFormat(0.01f, 0.07f, 0.7f, DBG_FONT_FLAGS, "avgFrame: %s%2.1fms\b avgDrawFrame: %s%2.1fms\b avgSimFrame: %s%2.1fms\b",
+	font->glFormat(0.01f, 0.06f, 0.7f, DBG_FONT_FLAGS, "avgFrame: %s%2.1fms\b avgDrawFrame: %s%2.1fms\b avgSimFrame: %s%2.1fms\b",
 	   (gu->avgFrameTime     > 30) ? "\xff\xff\x01\x01" : "", gu->avgFrameTime,
 	   (gu->avgDrawFrameTime > 16) ? "\xff\xff\x01\x01" : "", gu->avgDrawFrameTime,
 	   (gu->avgSimFrameTime  > 16) ? "\xff\xff\x01\x01" : "", gu->avgSimFrameTime
@@ -365,10 +366,12 @@ static void DrawInfoText()
 
 	switch (pathManager->GetPathFinderType()) {
 		case PFS_TYPE_DEFAULT: {
-			font->glFormat(0.01f, 0.12f, 0.7f, DBG_FONT_FLAGS, fmtString, "DEFAULT", pfsUpdates.x, pfsUpdates.y);
+			const int2 pfsPriorityUpdates = pathManager->GetNumPriorityUpdates();
+
+			font->glFormat(0.01f, 0.095f, 0.7f, DBG_FONT_FLAGS, "[%s-PFS] queued updates: %i %i (on paths: %i %i), queued requests: %u", "DEFAULT", pfsUpdates.x, pfsUpdates.y, pfsPriorityUpdates.x, pfsPriorityUpdates.y, pathManager->GetNumQueuedRequests());
 		} break;
 		case PFS_TYPE_QTPFS: {
-			font->glFormat(0.01f, 0.12f, 0.7f, DBG_FONT_FLAGS, fmtString, "QT", pfsUpdates.x, pfsUpdates.y);
+			font->glFormat(0.01f, 0.095f, 0.7f, DBG_FONT_FLAGS, fmtString, "QT", pfsUpdates.x, pfsUpdates.y);
 		} break;
 	}
 
@@ -376,13 +379,23 @@ static void DrawInfoText()
 	spring_lua_alloc_get_stats(&luaInfo);
 
 	font->glFormat(
-		0.01f, 0.15f, 0.7f, DBG_FONT_FLAGS,
+		0.01f, 0.125f, 0.7f, DBG_FONT_FLAGS,
 		"Lua-allocated memory: %.1fMB (%.5uK allocs : %.5u usecs : %.1u states)",
 		luaInfo.allocedBytes / 1024.0f / 1024.0f,
 		luaInfo.numLuaAllocs / 1000,
 		luaInfo.luaAllocTime,
 		luaInfo.numLuaStates
 	);
+
+	const CCobEngine::Stats& cobStats = GCobEngine.GetStats();
+
+	font->glFormat(
+		0.01f, 0.155f, 0.7f, DBG_FONT_FLAGS,
+		"COB threads: %u running, %u sleeping, %u woken",
+		cobStats.numRunning,
+		cobStats.numSleeping,
+		cobStats.numWoken
+	);
 }
 
 
@@ -77,9 +77,12 @@
 #include "System/GlobalConfig.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/FileSystem/SimpleParser.h"
+#include "System/FileSystem/Archives/ArchiveFileCache.h"
+#include "System/FileSystem/Archives/BufferedArchive.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/SoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/TimeUtil.h"
 #include "System/Util.h"
 #include "System/EventHandler.h"
 
@@ -2971,15 +2974,20 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor("DebugInfo",
 			"Print debug info to the chat/log-file about either:"
-			" sound, profiling") {}
+			" sound, profiling, trace (dumps the recent timer events as a"
+			" Chrome trace-event JSON file), archivecache") {}
 
 	bool Execute(const UnsyncedAction& action) const {
 		if (action.GetArgs() == "sound") {
 			sound->PrintDebugInfo();
 		} else if (action.GetArgs() == "profiling") {
 			profiler.PrintProfilingInfo();
+		} else if (action.GetArgs() == "trace") {
+			profiler.DumpTrace("profiling-trace-" + CTimeUtil::GetCurrentTimeStr() + ".json");
+		} else if (action.GetArgs() == "archivecache") {
+			CBufferedArchive::GetFileCache().PrintStats();
 		} else {
-			LOG_L(L_WARNING, "Give either of these as argument: sound, profiling");
+			LOG_L(L_WARNING, "Give either of these as argument: sound, profiling, trace, archivecache");
 		}
 		return true;
 	}
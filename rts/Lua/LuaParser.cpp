@@ -25,7 +25,7 @@
 #include "System/ScopedFPUSettings.h"
 #include "System/Util.h"
 
-LuaParser* LuaParser::currentParser = NULL;
+__thread LuaParser* LuaParser::currentParser = NULL;
 
 
 /******************************************************************************/
@@ -205,7 +205,8 @@ class LuaParser {
 		static int FileExists(lua_State* L);
 
 	private:
-		static LuaParser* currentParser;
+		/// parsers may run in parallel, eg. when scanning archives
+		static __thread LuaParser* currentParser;
 };
 
 
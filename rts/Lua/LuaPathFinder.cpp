@@ -56,6 +56,7 @@ bool LuaPathFinder::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetPathNodeCosts);
 	REGISTER_LUA_CFUNC(SetPathNodeCost);
 	REGISTER_LUA_CFUNC(GetPathNodeCost);
+	REGISTER_LUA_CFUNC(GetPathUpdateStats);
 
 	return true;
 }
@@ -368,5 +369,19 @@ int LuaPathFinder::GetPathNodeCost(lua_State* L)
 	return 1;
 }
 
+int LuaPathFinder::GetPathUpdateStats(lua_State* L)
+{
+	// blocks (or layers) queued for an update after terrain changes, per
+	// estimator, and how many of those are updated first for lying on paths
+	const int2 queuedUpdates = pathManager->GetNumQueuedUpdates();
+	const int2 priorityUpdates = pathManager->GetNumPriorityUpdates();
+
+	lua_pushnumber(L, queuedUpdates.x);
+	lua_pushnumber(L, queuedUpdates.y);
+	lua_pushnumber(L, priorityUpdates.x);
+	lua_pushnumber(L, priorityUpdates.y);
+	return 4;
+}
+
 /******************************************************************************/
 /******************************************************************************/
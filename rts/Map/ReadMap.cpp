@@ -49,6 +49,7 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(currMinHeight),
 	CR_IGNORED(currMaxHeight),
 	CR_MEMBER(mapChecksum),
+	CR_IGNORED(syncedTerrainVersion),
 	//CR_MEMBER(heightMapSyncedPtr),
 	//CR_MEMBER(heightMapUnsyncedPtr),
 	CR_MEMBER(originalHeightMap),
@@ -131,6 +132,7 @@ CReadMap::CReadMap()
 	, heightMapSyncedPtr(NULL)
 	, heightMapUnsyncedPtr(NULL)
 	, mapChecksum(0)
+	, syncedTerrainVersion(0)
 	, initMinHeight(0.0f)
 	, initMaxHeight(0.0f)
 	, currMinHeight(0.0f)
@@ -325,6 +327,7 @@ void CReadMap::UpdateHeightMapSynced(SRectangle rect, bool initialize)
 	UpdateMipHeightmaps(rect, initialize);
 	UpdateFaceNormals(rect, initialize);
 	UpdateSlopemap(rect, initialize); // must happen after UpdateFaceNormals()!
+	SyncedTerrainChanged();
 
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	// push the unsynced update
@@ -165,6 +165,11 @@ public:
 
 	unsigned int GetMapChecksum() const { return mapChecksum; }
 
+	/// changes whenever the synced height-, slope- or type-map (or the
+	/// terrain-type speeds) change; lets callers validate cached queries
+	unsigned int GetSyncedTerrainVersion() const { return syncedTerrainVersion; }
+	void SyncedTerrainChanged() { syncedTerrainVersion++; }
+
 private:
 	void UpdateCenterHeightmap(const SRectangle& rect, bool initialize);
 	void UpdateMipHeightmaps(const SRectangle& rect, bool initialize);
@@ -228,6 +233,7 @@ private:
 #endif
 
 	unsigned int mapChecksum;
+	unsigned int syncedTerrainVersion;
 
 	float initMinHeight, initMaxHeight; //< initial minimum- and maximum-height (before any deformations)
 	float currMinHeight, currMaxHeight; //< current minimum- and maximum-height
@@ -74,19 +74,24 @@ void CSMFMapFile::ReadHeightmap(float* sHeightMap, float* uHeightMap, float base
 {
 	const int hmx = header.mapx + 1;
 	const int hmy = header.mapy + 1;
-	unsigned short* temphm = new unsigned short[hmx * hmy];
 
-	ifs.Seek(header.heightmapPtr);
-	ifs.Read(temphm, hmx * hmy * 2);
+	// converted straight from the file contents, no temporary copy
+	const boost::uint8_t* data = ifs.GetData();
+
+	if (data == NULL || ifs.FileSize() < header.heightmapPtr + hmx * hmy * int(sizeof(unsigned short)))
+		throw content_error("Map file is too small to contain its heightmap");
+
+	const unsigned char* hmData = data + header.heightmapPtr;
 
 	for (int y = 0; y < hmx * hmy; ++y) {
-		const float h = base + swabWord(temphm[y]) * mod;
+		unsigned short hmValue;
+		memcpy(&hmValue, hmData + y * sizeof(unsigned short), sizeof(unsigned short));
+
+		const float h = base + swabWord(hmValue) * mod;
 
 		if (sHeightMap != NULL) { sHeightMap[y] = h; }
 		if (uHeightMap != NULL) { uHeightMap[y] = h; }
 	}
-
-	delete[] temphm;
 }
 
 
@@ -26,6 +26,7 @@
 #include "GameParticipant.h"
 #include "GameSkirmishAI.h"
 #include "AutohostInterface.h"
+#include "RelaySource.h"
 #include "Game/GameSetup.h"
 #include "Game/Action.h"
 #include "Game/ChatMessage.h"
@@ -52,6 +53,7 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Net/LocalConnection.h"
+#include "System/Net/PacketBlock.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
@@ -64,7 +66,6 @@
 #endif
 
 #define ALLOW_DEMO_GODMODE
-#define PKTCACHE_VECSIZE 1000
 
 using netcode::RawPacket;
 
@@ -150,8 +151,9 @@ std::set<std::string> CGameServer::commandBlacklist;
 
 CGameServer* gameServer = NULL;
 
-CGameServer::CGameServer(const std::string& hostIP, int hostPort, const GameData* const newGameData, const CGameSetup* const mysetup)
+CGameServer::CGameServer(const std::string& hostIP, int hostPort, const GameData* const newGameData, const CGameSetup* const mysetup, CRelaySource* myRelaySource)
 : setup(mysetup)
+, relaySource(myRelaySource)
 {
 	assert(setup);
 	serverStartTime = spring_gettime();
@@ -160,6 +162,7 @@ CGameServer::CGameServer(const std::string& hostIP, int hostPort, const GameData
 	syncErrorFrame = 0;
 	syncWarningFrame = 0;
 	serverFrameNum = 0;
+	packetCacheTailSize = 0;
 
 	modGameTime = 0.0f;
 	gameTime = 0.0f;
@@ -221,6 +224,13 @@ CGameServer::CGameServer(const std::string& hostIP, int hostPort, const GameData
 		demoReader.reset(new CDemoReader(setup->demoName, modGameTime + 0.1f));
 	}
 
+	if (relaySource != NULL) {
+		// the upstream server decides when the game starts,
+		// from here on we only forward what it sends us
+		Message(RelayStart);
+		gameHasStarted = true;
+	}
+
 	{
 		const std::vector<PlayerBase>& playerStartData = setup->GetPlayerStartingDataCont();
 		const std::vector<TeamBase>& teamStartData = setup->GetTeamStartingDataCont();
@@ -284,7 +294,7 @@ CGameServer::CGameServer(const std::string& hostIP, int hostPort, const GameData
 	streflop::streflop_init<streflop::Simple>();
 #endif
 
-	if (!demoReader) {
+	if (demoReader == NULL && relaySource == NULL) {
 		GenerateAndSendGameID();
 		rng.Seed(gameID.intArray[0] ^ gameID.intArray[1] ^ gameID.intArray[2] ^ gameID.intArray[3]);
 		Broadcast(CBaseNetProtocol::Get().SendRandSeed(rng()));
@@ -411,6 +421,15 @@ void CGameServer::PostLoad(int newServerFrameNum)
 	for (it = players.begin(); it != players.end(); ++it) {
 		it->lastFrameResponse = newServerFrameNum;
 	}
+
+	// savegame written while watching a demo (see CGame::SaveDemoKeyframe)
+	// continue from the frame the savegame was taken at instead of frame 0
+	if (demoReader != NULL && serverFrameNum > 0) {
+		if (!demoReader->SeekToFrame(serverFrameNum, modGameTime + 0.1f)) {
+			Message(str(format("Demo does not contain frame %d, cannot resume playback") %serverFrameNum));
+			demoReader.reset();
+		}
+	}
 }
 
 void CGameServer::SkipTo(int targetFrameNum)
@@ -505,150 +524,220 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 
 	// get all packets from the stream up to <modGameTime>
 	while ((buf = demoReader->GetData(modGameTime))) {
-		boost::shared_ptr<const RawPacket> rpkt(buf);
+		// only check sync when not skipping
+		SendStreamPacket(buf, targetFrameNum == -1);
+	}
 
-		if (buf->length <= 0) {
-			Message(str(format("Warning: Discarding zero size packet in demo")));
+	if (targetFrameNum > 0) {
+		// skipping
+		ret = (serverFrameNum < targetFrameNum);
+	}
+
+	if (demoReader->ReachedEnd()) {
+		demoReader.reset();
+		Message(DemoEnd);
+		gameEndTime = spring_gettime();
+		ret = false;
+	}
+
+	return ret;
+}
+
+void CGameServer::SendRelayData()
+{
+	relaySource->Update();
+
+	if (relaySource->CheckTimeout()) {
+		Message(str(format(RelayEnd) %"timeout"));
+		quitServer = true;
+		return;
+	}
+
+	boost::shared_ptr<const RawPacket> packet;
+
+	while ((packet = relaySource->GetData())) {
+		if (packet->length <= 0)
 			continue;
+
+		if (packet->data[0] == NETMSG_QUIT) {
+			// our clients get their own quit message on shutdown
+			Message(str(format(RelayEnd) %"server quit"));
+			quitServer = true;
+			return;
 		}
 
-		const unsigned msgCode = buf->data[0];
+		// copy, player numbers may need to be adjusted
+		SendStreamPacket(new RawPacket(packet->data, packet->length), true);
+	}
+}
+
+void CGameServer::SendStreamPacket(netcode::RawPacket* buf, bool checkSync)
+{
+	boost::shared_ptr<const RawPacket> rpkt(buf);
 
-		switch (msgCode) {
-			case NETMSG_NEWFRAME:
-			case NETMSG_KEYFRAME: {
-				// we can't use CreateNewFrame() here
-				lastNewFrameTick = spring_gettime();
-				serverFrameNum++;
+	if (buf->length <= 0) {
+		// SendRelayData never passes these on
+		if (demoReader != NULL)
+			Message(str(format("Warning: Discarding zero size packet in demo")));
+
+		return;
+	}
+
+	const unsigned msgCode = buf->data[0];
+
+	switch (msgCode) {
+		case NETMSG_NEWFRAME:
+		case NETMSG_KEYFRAME: {
+			// we can't use CreateNewFrame() here
+			lastNewFrameTick = spring_gettime();
+			serverFrameNum++;
 #ifdef SYNCCHECK
-				if (targetFrameNum == -1) {
-					// not skipping
-					outstandingSyncFrames.insert(serverFrameNum);
-				}
-				CheckSync();
-#endif
-				Broadcast(rpkt);
-				break;
+			if (checkSync) {
+				outstandingSyncFrames.insert(serverFrameNum);
 			}
+			CheckSync();
+#endif
+			Broadcast(rpkt);
+			break;
+		}
 
-			case NETMSG_AI_STATE_CHANGED: /* many of these messages are not likely to be sent by a spec, but there are cheats */
-			case NETMSG_ALLIANCE:
-			case NETMSG_DC_UPDATE:
-			case NETMSG_DIRECT_CONTROL:
-			case NETMSG_PATH_CHECKSUM:
-			case NETMSG_PAUSE: /* this is a synced message and must not be excluded */
-			case NETMSG_PLAYERINFO:
-			case NETMSG_PLAYERLEFT:
-			case NETMSG_PLAYERSTAT:
-			case NETMSG_SETSHARE:
-			case NETMSG_SHARE:
-			case NETMSG_STARTPOS:
-			case NETMSG_TEAM: {
-				// TODO: more messages may need adjusted player numbers, or maybe there is a better solution
-				if (!AdjustPlayerNumber(buf, 1))
-					continue;
-				Broadcast(rpkt);
-				break;
-			}
+		case NETMSG_AI_STATE_CHANGED: /* many of these messages are not likely to be sent by a spec, but there are cheats */
+		case NETMSG_ALLIANCE:
+		case NETMSG_DC_UPDATE:
+		case NETMSG_DIRECT_CONTROL:
+		case NETMSG_PATH_CHECKSUM:
+		case NETMSG_PAUSE: /* this is a synced message and must not be excluded */
+		case NETMSG_PLAYERINFO:
+		case NETMSG_PLAYERLEFT:
+		case NETMSG_PLAYERSTAT:
+		case NETMSG_SETSHARE:
+		case NETMSG_SHARE:
+		case NETMSG_STARTPOS:
+		case NETMSG_TEAM: {
+			// TODO: more messages may need adjusted player numbers, or maybe there is a better solution
+			if (!AdjustPlayerNumber(buf, 1))
+				return;
+			Broadcast(rpkt);
+			break;
+		}
 
-			case NETMSG_AI_CREATED:
-			case NETMSG_MAPDRAW:
-			case NETMSG_PLAYERNAME: {
-				if (!AdjustPlayerNumber(buf, 2))
-					continue;
-				Broadcast(rpkt);
-				break;
-			}
+		case NETMSG_AI_CREATED:
+		case NETMSG_MAPDRAW:
+		case NETMSG_PLAYERNAME: {
+			if (!AdjustPlayerNumber(buf, 2))
+				return;
+			Broadcast(rpkt);
+			break;
+		}
 
-			case NETMSG_CHAT: {
-				if (!AdjustPlayerNumber(buf, 2) || !AdjustPlayerNumber(buf, 3))
-					continue;
-				Broadcast(rpkt);
-				break;
-			}
+		case NETMSG_CHAT: {
+			if (!AdjustPlayerNumber(buf, 2) || !AdjustPlayerNumber(buf, 3))
+				return;
+			Broadcast(rpkt);
+			break;
+		}
 
-			case NETMSG_AICOMMAND:
-			case NETMSG_AISHARE:
-			case NETMSG_COMMAND:
-			case NETMSG_LUAMSG:
-			case NETMSG_SELECT:
-			case NETMSG_SYSTEMMSG: {
-				if (!AdjustPlayerNumber(buf ,3))
-					continue;
-				Broadcast(rpkt);
-				break;
+		case NETMSG_AICOMMAND:
+		case NETMSG_AISHARE:
+		case NETMSG_COMMAND:
+		case NETMSG_LUAMSG:
+		case NETMSG_SELECT:
+		case NETMSG_SYSTEMMSG: {
+			if (!AdjustPlayerNumber(buf ,3))
+				return;
+			Broadcast(rpkt);
+			break;
+		}
+
+		case NETMSG_CREATE_NEWPLAYER: {
+			if (!AdjustPlayerNumber(buf, 3, players.size()))
+				return;
+			try {
+				netcode::UnpackPacket pckt(rpkt, 3);
+				unsigned char spectator, team, playerNum;
+				std::string name;
+				pckt >> playerNum;
+				pckt >> spectator;
+				pckt >> team;
+				pckt >> name;
+				AddAdditionalUser(name, "", true,(bool)spectator,(int)team); // even though this is a demo, keep the players vector properly updated
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(str(format("Warning: Discarding invalid new player packet in demo: %s") %ex.what()));
+				return;
 			}
 
-			case NETMSG_CREATE_NEWPLAYER: {
-				if (!AdjustPlayerNumber(buf, 3, players.size()))
-					continue;
-				try {
-					netcode::UnpackPacket pckt(rpkt, 3);
-					unsigned char spectator, team, playerNum;
-					std::string name;
-					pckt >> playerNum;
-					pckt >> spectator;
-					pckt >> team;
-					pckt >> name;
-					AddAdditionalUser(name, "", true,(bool)spectator,(int)team); // even though this is a demo, keep the players vector properly updated
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(str(format("Warning: Discarding invalid new player packet in demo: %s") %ex.what()));
-					continue;
-				}
+			Broadcast(rpkt);
+			break;
+		}
 
-				Broadcast(rpkt);
-				break;
-			}
+		case NETMSG_GAMEID: {
+			if (relaySource != NULL && buf->length >= (1 + sizeof(gameID))) {
+				// relayed games keep the ID given by the upstream server
+				std::copy(buf->data + 1, buf->data + 1 + sizeof(gameID), gameID.charArray);
 
-			case NETMSG_GAMEDATA:
-			case NETMSG_SETPLAYERNUM:
-			case NETMSG_USER_SPEED:
-			case NETMSG_INTERNAL_SPEED: {
-				// never send these from demos
-				break;
-			}
-			case NETMSG_CCOMMAND: {
-				if (!AdjustPlayerNumber(buf ,3))
-					continue;
-				try {
-					CommandMessage msg(rpkt);
-					const Action& action = msg.GetAction();
-					if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
-						SetBoolArg(cheating, action.extra);
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(str(format("Warning: Discarding invalid command message packet in demo: %s") %ex.what()));
-					continue;
-				}
-				Broadcast(rpkt);
-				break;
-			}
-			default: {
-				Broadcast(rpkt);
-				break;
+				if (demoRecorder != NULL)
+					demoRecorder->SetGameID(gameID.charArray);
+
+				generatedGameID = true;
 			}
+			Broadcast(rpkt);
+			break;
 		}
-	}
 
-	if (targetFrameNum > 0) {
-		// skipping
-		ret = (serverFrameNum < targetFrameNum);
-	}
+		case NETMSG_USER_SPEED: {
+			// a relayed game runs at the pace of the upstream server
+			if (relaySource == NULL || !AdjustPlayerNumber(buf, 1))
+				return;
+			Broadcast(rpkt);
+			break;
+		}
+		case NETMSG_INTERNAL_SPEED: {
+			if (relaySource == NULL)
+				return;
+			Broadcast(rpkt);
+			break;
+		}
 
-	if (demoReader->ReachedEnd()) {
-		demoReader.reset();
-		Message(DemoEnd);
-		gameEndTime = spring_gettime();
-		ret = false;
-	}
+		case NETMSG_GAME_FRAME_PROGRESS: {
+			// skips the cache, see CreateNewFrame
+			for (size_t p = 0; p < players.size(); ++p)
+				players[p].SendData(rpkt);
+			break;
+		}
 
-	return ret;
+		case NETMSG_GAMEDATA:
+		case NETMSG_SETPLAYERNUM: {
+			// never send these from demos
+			break;
+		}
+		case NETMSG_CCOMMAND: {
+			if (!AdjustPlayerNumber(buf ,3))
+				return;
+			try {
+				CommandMessage msg(rpkt);
+				const Action& action = msg.GetAction();
+				if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
+					SetBoolArg(cheating, action.extra);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(str(format("Warning: Discarding invalid command message packet in demo: %s") %ex.what()));
+				return;
+			}
+			Broadcast(rpkt);
+			break;
+		}
+		default: {
+			Broadcast(rpkt);
+			break;
+		}
+	}
 }
 
 void CGameServer::Broadcast(boost::shared_ptr<const netcode::RawPacket> packet)
 {
 	for (size_t p = 0; p < players.size(); ++p)
 		players[p].SendData(packet);
-	if (canReconnect || bypassScriptPasswordCheck || !gameHasStarted)
+	// relays always accept late joiners
+	if (canReconnect || bypassScriptPasswordCheck || !gameHasStarted || relaySource != NULL)
 		AddToPacketCache(packet);
 
 	if (demoRecorder != NULL) {
@@ -868,7 +957,7 @@ void CGameServer::Update()
 
 	if (!gameHasStarted)
 		CheckForGameStart();
-	else if (serverFrameNum > 0 || demoReader != NULL)
+	else if (serverFrameNum > 0 || demoReader != NULL || relaySource != NULL)
 		CreateNewFrame(true, false);
 
 	if (hostif) {
@@ -888,7 +977,8 @@ void CGameServer::Update()
 	}
 
 	const bool pregameTimeoutReached = (spring_gettime() > serverStartTime + spring_secs(globalConfig->initialNetworkTimeout));
-	if (pregameTimeoutReached || gameHasStarted) {
+	// a relay keeps running until the upstream game ends, with or without spectators
+	if ((pregameTimeoutReached || gameHasStarted) && relaySource == NULL) {
 		bool hasPlayers = false;
 		for (size_t i = 0; i < players.size(); ++i) {
 			if (players[i].link) {
@@ -954,8 +1044,8 @@ void CGameServer::LagProtection()
 		refCpuUsage = medianCpu;
 	}
 
-	// adjust game speed
-	if (refCpuUsage > 0.0f && !isPaused) {
+	// adjust game speed (not ours to decide when relaying)
+	if (refCpuUsage > 0.0f && !isPaused && relaySource == NULL) {
 		//userSpeedFactor holds the wanted speed adjusted manually by user ( normally 1)
 		//internalSpeed holds the current speed the sim is running
 		//refCpuUsage holds the highest cpu if curSpeedCtrl == 0 or median if curSpeedCtrl == 1
@@ -1315,6 +1405,11 @@ void CGameServer::ProcessPacket(const unsigned playerNum, boost::shared_ptr<cons
 			if (outstandingSyncFrames.find(frameNum) != outstandingSyncFrames.end())
 				players[a].syncResponse[frameNum] = checkSum;
 
+			// the upstream server expects a checksum from us like from any
+			// spectator, we can only pass on those of our own spectators
+			if (relaySource != NULL)
+				relaySource->SendSyncResponse(frameNum, checkSum);
+
 			// update player's ping (if !defined(SYNCCHECK) this is done in NETMSG_KEYFRAME)
 			if (frameNum <= serverFrameNum && frameNum > players[a].lastFrameResponse)
 				players[a].lastFrameResponse = frameNum;
@@ -2008,7 +2103,7 @@ void CGameServer::StartGame(bool forced)
 	gameHasStarted = true;
 	startTime = gameTime;
 	if (!canReconnect && !bypassScriptPasswordCheck)
-		packetCache.clear(); // free memory
+		ClearPacketCache(); // free memory
 
 	if (UDPNet && !canReconnect && !bypassScriptPasswordCheck)
 		UDPNet->SetAcceptingConnections(false); // do not accept new connections
@@ -2378,9 +2473,14 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 		return;
 	}
 
-	Threading::RecursiveScopedLock(gameServerMutex, !fromServerThread);
+	Threading::RecursiveScopedLock scoped_lock(gameServerMutex, !fromServerThread);
 	CheckSync();
 
+	if (relaySource != NULL) {
+		SendRelayData();
+		return;
+	}
+
 	const bool vidRecording = videoCapturing->IsCapturing();
 	const bool normalFrame = !isPaused && !vidRecording;
 	const bool videoFrame = !isPaused && fixedFrameTime;
@@ -2678,7 +2778,7 @@ unsigned CGameServer::BindConnection(std::string name, const std::string& passwd
 	}
 
 	if (newPlayerNumber >= players.size() && errmsg == "") {
-		if (demoReader || bypassScriptPasswordCheck)
+		if (demoReader || relaySource || bypassScriptPasswordCheck)
 			AddAdditionalUser(name, passwd);
 		else
 			errmsg = "User name not authorized to connect";
@@ -2739,9 +2839,7 @@ unsigned CGameServer::BindConnection(std::string name, const std::string& passwd
 	newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
 
 	// after gamedata and playerNum, the player can start loading
-	for (std::list< std::vector<boost::shared_ptr<const netcode::RawPacket> > >::const_iterator lit = packetCache.begin(); lit != packetCache.end(); ++lit)
-		for (std::vector<boost::shared_ptr<const netcode::RawPacket> >::const_iterator vit = lit->begin(); vit != lit->end(); ++vit)
-			newPlayer.SendData(*vit); // throw at him all stuff he missed until now
+	SendPacketCache(newPlayer); // throw at him all stuff he missed until now
 
 	if (demoReader == NULL || setup->demoName.empty()) { // gamesetup from demo?
 		if (!newPlayer.spectator) {
@@ -2817,9 +2915,50 @@ void CGameServer::FreeSkirmishAIId(const unsigned char skirmishAIId) {
 }
 
 void CGameServer::AddToPacketCache(boost::shared_ptr<const netcode::RawPacket> &pckt) {
-	if (packetCache.empty() || packetCache.back().size() >= PKTCACHE_VECSIZE) {
-		packetCache.push_back(std::vector<boost::shared_ptr<const netcode::RawPacket> >());
-		packetCache.back().reserve(PKTCACHE_VECSIZE);
+	if ((packetCacheTailSize + pckt->length) > netcode::PacketBlock::MAX_CONTENT_SIZE)
+		SealPacketCacheTail();
+
+	packetCacheTail.push_back(pckt);
+	packetCacheTailSize += pckt->length;
+}
+
+void CGameServer::SealPacketCacheTail() {
+	if (packetCacheTail.empty())
+		return;
+
+	RawPacket* block = netcode::PacketBlock::Pack(packetCacheTail);
+
+	if (block != NULL) {
+		packetCache.push_back(boost::shared_ptr<const RawPacket>(block));
+	} else {
+		// a single packet too large for any block, keep it as it is
+		packetCache.insert(packetCache.end(), packetCacheTail.begin(), packetCacheTail.end());
+	}
+
+	packetCacheTail.clear();
+	packetCacheTailSize = 0;
+}
+
+void CGameServer::ClearPacketCache() {
+	packetCache.clear();
+	packetCacheTail.clear();
+	packetCacheTailSize = 0;
+}
+
+void CGameServer::SendPacketCache(GameParticipant& player) {
+	for (size_t n = 0; n < packetCache.size(); ++n)
+		player.SendData(packetCache[n]);
+
+	if (packetCacheTail.empty())
+		return;
+
+	// the tail is still growing, compress a snapshot of it for this player
+	RawPacket* block = netcode::PacketBlock::Pack(packetCacheTail);
+
+	if (block != NULL) {
+		player.SendData(boost::shared_ptr<const RawPacket>(block));
+	} else {
+		for (size_t n = 0; n < packetCacheTail.size(); ++n)
+			player.SendData(packetCacheTail[n]);
 	}
-	packetCache.back().push_back(pckt);
 }
@@ -37,6 +37,7 @@ namespace netcode
 	class UDPListener;
 }
 class CDemoReader;
+class CRelaySource;
 class Action;
 class CDemoRecorder;
 class AutohostInterface;
@@ -68,7 +69,11 @@ class CGameServer
 {
 	friend class CCregLoadSaveHandler; // For initializing server state after load
 public:
-	CGameServer(const std::string& hostIP, int hostPort, const GameData* const gameData, const CGameSetup* const setup);
+	/**
+	 * @param relaySource if given, the server relays the game this source
+	 *   is connected to instead of hosting one (takes ownership)
+	 */
+	CGameServer(const std::string& hostIP, int hostPort, const GameData* const gameData, const CGameSetup* const setup, CRelaySource* relaySource = NULL);
 	~CGameServer();
 
 	CGameServer(const CGameServer&) = delete; // no-copy
@@ -147,6 +152,10 @@ private:
 	void WriteDemoData();
 	/// read data from demo and send it to clients
 	bool SendDemoData(int targetFrameNum);
+	/// forward data received from the relay upstream to clients
+	void SendRelayData();
+	/// send one packet of a demo or relayed stream to clients
+	void SendStreamPacket(netcode::RawPacket* buf, bool checkSync);
 
 	void Broadcast(boost::shared_ptr<const netcode::RawPacket> packet);
 
@@ -162,6 +171,9 @@ private:
 	void PrivateMessage(int playerNum, const std::string& message);
 
 	void AddToPacketCache(boost::shared_ptr<const netcode::RawPacket>& pckt);
+	void SealPacketCacheTail();
+	void ClearPacketCache();
+	void SendPacketCache(GameParticipant& player);
 
 	bool AdjustPlayerNumber(netcode::RawPacket* buf, int pos, int val = -1);
 	void UpdatePlayerNumberMap();
@@ -235,7 +247,11 @@ private:
 	bool logDebugMessages;
 	bool logWarnMessages;
 
-	std::list< std::vector<boost::shared_ptr<const netcode::RawPacket> > > packetCache;
+	/// what late joiners are sent to catch up: compressed blocks of older
+	/// packets (see netcode::PacketBlock), followed by the newest packets
+	std::vector< boost::shared_ptr<const netcode::RawPacket> > packetCache;
+	std::vector< boost::shared_ptr<const netcode::RawPacket> > packetCacheTail;
+	unsigned int packetCacheTailSize;
 
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
@@ -258,6 +274,7 @@ private:
 
 	boost::scoped_ptr<netcode::UDPListener> UDPNet;
 	boost::scoped_ptr<CDemoReader> demoReader;
+	boost::scoped_ptr<CRelaySource> relaySource;
 	boost::scoped_ptr<CDemoRecorder> demoRecorder;
 	boost::scoped_ptr<AutohostInterface> hostif;
 
@@ -105,6 +105,8 @@ enum NETMSG {
 
 	NETMSG_GAME_FRAME_PROGRESS= 77, // int frameNum # this special packet skips queue & cache entirely, indicates current game progress for clients fast-forwarding to current point the game #
 
+	NETMSG_PACKET_BLOCK     = 78, // /* ushort messageSize */, uint contentSize, std::vector<uint8_t> compressedPackets # expanded by the receiving connection, see netcode::PacketBlock #
+
 
 	NETMSG_LAST //max types of netmessages, internal only
 };
@@ -0,0 +1,204 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+// NOTE: must be included before BaseNetProtocol.h (see NetProtocol.cpp)
+#include "System/Net/UDPConnection.h"
+
+#include "RelaySource.h"
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Game/GameData.h"
+#include "Game/GameVersion.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/GlobalConfig.h"
+#include "System/TdfParser.h"
+#include "System/Util.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UnpackPacket.h"
+#include "System/Log/ILog.h"
+
+#include <sstream>
+
+using netcode::RawPacket;
+
+
+CRelaySource::CRelaySource(const std::string& hostIP, int hostPort, const std::string& _myName, const std::string& myPasswd)
+	: myName(_myName)
+	, playerNum(-1)
+	, lastSyncResponseFrame(-1)
+{
+	netcode::UDPConnection* conn = new netcode::UDPConnection(configHandler->GetInt("SourcePort"), hostIP, hostPort);
+	conn->Unmute();
+	link.reset(conn);
+	link->SendData(CBaseNetProtocol::Get().SendAttemptConnect(myName, myPasswd, SpringVersion::GetFull(), globalConfig->networkLossFactor));
+	link->Flush(true);
+
+	LOG("[RelaySource] connecting to %s:%i using name %s", hostIP.c_str(), hostPort, myName.c_str());
+}
+
+CRelaySource::~CRelaySource()
+{
+	link->SendData(CBaseNetProtocol::Get().SendQuit(""));
+	link->Close(true);
+}
+
+
+bool CRelaySource::Connect(spring_time timeout)
+{
+	const spring_time endTime = spring_gettime() + timeout;
+
+	while (playerNum < 0) {
+		link->Update();
+		ReadHandshake();
+
+		if (!quitReason.empty()) {
+			LOG_L(L_ERROR, "[RelaySource] upstream server refused connection: %s", quitReason.c_str());
+			return false;
+		}
+		if (playerNum >= 0)
+			break;
+
+		if (spring_gettime() > endTime || link->CheckTimeout(0, true)) {
+			LOG_L(L_ERROR, "[RelaySource] no response from upstream server");
+			return false;
+		}
+
+		spring_msecs(10).sleep();
+	}
+
+	// makes us count as ingame upstream, which a pending game start waits for
+	link->SendData(CBaseNetProtocol::Get().SendPlayerName(playerNum, myName));
+	link->Flush();
+
+	LOG("[RelaySource] connected to %s (player number %i)", link->GetFullAddress().c_str(), playerNum);
+	return true;
+}
+
+
+void CRelaySource::ReadHandshake()
+{
+	boost::shared_ptr<const RawPacket> packet;
+
+	while ((packet = link->GetData())) {
+		if (packet->length <= 0)
+			continue;
+
+		switch (packet->data[0]) {
+			case NETMSG_QUIT: {
+				try {
+					netcode::UnpackPacket pckt(packet, 3);
+					pckt >> quitReason;
+				} catch (const netcode::UnpackPacketException& ex) {
+					quitReason = ex.what();
+				}
+
+				if (quitReason.empty())
+					quitReason = "unknown reason";
+				return;
+			}
+
+			case NETMSG_GAMEDATA: {
+				GameData* data = NULL;
+
+				try {
+					data = new GameData(packet);
+				} catch (const netcode::UnpackPacketException& ex) {
+					quitReason = std::string("invalid game data: ") + ex.what();
+					return;
+				}
+
+				// modify the script so the server can use it for playback
+				TdfParser script(data->GetSetup().c_str(), data->GetSetup().size());
+				TdfParser::TdfSection* tgame = script.GetRootSection()->sections["game"];
+
+				if (tgame == NULL) {
+					delete data;
+					quitReason = "game data contains no GAME section";
+					return;
+				}
+
+				tgame->AddPair("OnlyLocal", 0);
+
+				for (std::map<std::string, TdfParser::TdfSection*>::iterator it = tgame->sections.begin(); it != tgame->sections.end(); ++it) {
+					if (StringToLower(it->first).find("player") == 0) {
+						it->second->AddPair("isfromdemo", 1);
+					}
+				}
+
+				std::ostringstream buf;
+				script.print(buf);
+
+				data->SetSetup(buf.str());
+				gameData.reset(data);
+			} break;
+
+			case NETMSG_SETPLAYERNUM: {
+				if (gameData == NULL) {
+					quitReason = "no game data received before player number";
+					return;
+				}
+
+				playerNum = packet->data[1];
+			} break;
+
+			default: {
+				// anything sent before the game data (eg. the message
+				// announcing a midgame join) is repeated in the packet
+				// cache which follows our player number
+				if (playerNum >= 0)
+					pending.push_back(packet);
+			} break;
+		}
+	}
+}
+
+
+boost::shared_ptr<const RawPacket> CRelaySource::GetData()
+{
+	boost::shared_ptr<const RawPacket> packet;
+
+	if (!pending.empty()) {
+		packet = pending.front();
+		pending.pop_front();
+	} else {
+		packet = link->GetData();
+	}
+
+	if (packet && packet->length > 0 && packet->data[0] == NETMSG_KEYFRAME)
+		AnswerKeyFrame(packet);
+
+	return packet;
+}
+
+void CRelaySource::AnswerKeyFrame(boost::shared_ptr<const RawPacket> packet)
+{
+	try {
+		netcode::UnpackPacket pckt(packet, 1);
+
+		int frameNum;
+		pckt >> frameNum;
+
+		// same reply as CGame::ClientReadNet, the server derives our ping from it
+		link->SendData(CBaseNetProtocol::Get().SendKeyFrame(frameNum));
+	} catch (const netcode::UnpackPacketException& ex) {
+		LOG_L(L_WARNING, "[RelaySource] invalid keyframe: %s", ex.what());
+	}
+}
+
+void CRelaySource::SendSyncResponse(int frameNum, unsigned int checksum)
+{
+	if (frameNum <= lastSyncResponseFrame)
+		return;
+
+	lastSyncResponseFrame = frameNum;
+	link->SendData(CBaseNetProtocol::Get().SendSyncResponse(playerNum, frameNum, checksum));
+}
+
+void CRelaySource::Update()
+{
+	link->Update();
+}
+
+bool CRelaySource::CheckTimeout() const
+{
+	return link->CheckTimeout();
+}
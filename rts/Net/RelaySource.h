@@ -0,0 +1,89 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _RELAY_SOURCE_H
+#define _RELAY_SOURCE_H
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <deque>
+#include <string>
+
+#include "System/Misc/SpringTime.h"
+
+namespace netcode
+{
+	class RawPacket;
+	class CConnection;
+}
+class GameData;
+
+/**
+ * @brief Spectator connection to an upstream game server
+ *
+ * A server in relay mode does not run a game of its own: it joins another
+ * CGameServer as a spectator and re-serves everything received from there
+ * to its own (downstream) spectators, the same way a hosted demo is played
+ * back. Large games can so be fanned out across several machines.
+ */
+class CRelaySource
+{
+public:
+	CRelaySource(const std::string& hostIP, int hostPort, const std::string& myName, const std::string& myPasswd);
+	~CRelaySource();
+
+	/**
+	 * @brief wait for the upstream server to accept us
+	 * @return false on rejection or if nothing was received within <timeout>
+	 */
+	bool Connect(spring_time timeout);
+
+	/**
+	 * @brief game data to hand out to downstream spectators
+	 * Its script lists all upstream players as "isfromdemo", so their
+	 * numbers are translated like those of players recorded in a demo.
+	 * @pre Connect() succeeded
+	 */
+	const GameData* GetGameData() const { return gameData.get(); }
+
+	/**
+	 * @brief next packet of the upstream stream, or NULL if none is waiting
+	 * Keyframes are answered upstream here, as a spectator client does, so
+	 * the upstream server sees our ping.
+	 */
+	boost::shared_ptr<const netcode::RawPacket> GetData();
+
+	/**
+	 * @brief pass a checksum computed by a downstream spectator upstream
+	 * We do not simulate, so the first checksum received for a frame is
+	 * sent in place of our own (later ones for that frame are ignored).
+	 */
+	void SendSyncResponse(int frameNum, unsigned int checksum);
+
+	void Update();
+	bool CheckTimeout() const;
+
+	int GetPlayerNum() const { return playerNum; }
+
+private:
+	/// handles the packets preceding the stream
+	void ReadHandshake();
+	void AnswerKeyFrame(boost::shared_ptr<const netcode::RawPacket> packet);
+
+private:
+	boost::scoped_ptr<netcode::CConnection> link;
+	boost::scoped_ptr<GameData> gameData;
+
+	/// stream packets which arrived together with the handshake
+	std::deque< boost::shared_ptr<const netcode::RawPacket> > pending;
+
+	std::string myName;
+	std::string quitReason;
+
+	/// our player number on the upstream server, -1 until assigned
+	int playerNum;
+	/// last frame a sync response was sent upstream for
+	int lastSyncResponseFrame;
+};
+
+#endif // _RELAY_SOURCE_H
@@ -246,6 +246,7 @@ struct LocalModelPiece
 
 	void SetPosition(const float3& p) { pos = p; ++numUpdatesSynced; }
 	void SetRotation(const float3& r) { rot = r; ++numUpdatesSynced; }
+	void SetDirty() { lastMatrixUpdate = numUpdatesSynced - 1; }
 	void SetDirection(const float3& d) { dir = d; } // unused
 
 	const float3& GetPosition() const { return pos; }
@@ -329,6 +330,14 @@ struct LocalModel
 		dirtyPieces = 0;
 	}
 
+	// forces the next UpdatePieceMatrices to recompute every piece
+	void SetAllPiecesDirty() {
+		for (unsigned int i = 0; i < pieces.size(); i++) {
+			pieces[i]->SetDirty();
+		}
+		dirtyPieces = pieces.size();
+	}
+
 
 
 	void DrawPieces() const;
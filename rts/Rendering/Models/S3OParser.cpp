@@ -24,8 +24,13 @@ S3DModel* CS3OParser::Load(const std::string& name)
 		throw content_error("[S3OParser] could not find model-file " + name);
 	}
 
-	unsigned char* fileBuf = new unsigned char[file.FileSize()];
-	file.Read(fileBuf, file.FileSize());
+	// read-only, possibly mapped straight from the file
+	const unsigned char* fileBuf = file.GetData();
+
+	if (fileBuf == NULL || file.FileSize() < int(sizeof(S3OHeader))) {
+		throw content_error("[S3OParser] could not read model-file " + name);
+	}
+
 	S3OHeader header;
 	memcpy(&header, fileBuf, sizeof(header));
 	header.swap();
@@ -34,8 +39,8 @@ S3DModel* CS3OParser::Load(const std::string& name)
 		model->name = name;
 		model->type = MODELTYPE_S3O;
 		model->numPieces = 0;
-		model->tex1 = (char*) &fileBuf[header.texture1];
-		model->tex2 = (char*) &fileBuf[header.texture2];
+		model->tex1 = (const char*) &fileBuf[header.texture1];
+		model->tex2 = (const char*) &fileBuf[header.texture2];
 		model->mins = DEF_MIN_SIZE;
 		model->maxs = DEF_MAX_SIZE;
 	texturehandlerS3O->LoadS3OTexture(model);
@@ -48,23 +53,26 @@ S3DModel* CS3OParser::Load(const std::string& name)
 	model->drawRadius = float3::max(float3::fabs(model->maxs), float3::fabs(model->mins)).Length();
 	model->relMidPos = float3(header.midx, header.midy, header.midz);
 
-	delete[] fileBuf;
 	return model;
 }
 
-SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned char* buf, int offset)
+SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, const unsigned char* buf, int offset)
 {
 	model->numPieces++;
 
-	Piece* fp = (Piece*)&buf[offset];
-	fp->swap(); // Does it matter we mess with the original buffer here? Don't hope so.
+	// the buffer is read-only (and possibly shared), swap a copy
+	Piece filePiece;
+	memcpy(&filePiece, &buf[offset], sizeof(Piece));
+	filePiece.swap();
+
+	const Piece* fp = &filePiece;
 
 	SS3OPiece* piece = new SS3OPiece();
 		piece->offset.x = fp->xoffset;
 		piece->offset.y = fp->yoffset;
 		piece->offset.z = fp->zoffset;
 		piece->primType = fp->primitiveType;
-		piece->name = (char*) &buf[fp->name];
+		piece->name = (const char*) &buf[fp->name];
 		piece->parent = parent;
 		if (parent != NULL) {
 			piece->parentName = parent->name;
@@ -77,8 +85,11 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned ch
 	int vertexOffset = fp->vertices;
 
 	for (int a = 0; a < fp->numVertices; ++a) {
-		Vertex* v = reinterpret_cast<Vertex*>(&buf[vertexOffset]);
-			v->swap();
+		Vertex fileVertex;
+		memcpy(&fileVertex, &buf[vertexOffset], sizeof(Vertex));
+		fileVertex.swap();
+
+		const Vertex* v = &fileVertex;
 
 		SS3OVertex sv;
 		sv.pos = float3(v->xpos, v->ypos, v->zpos);
@@ -94,7 +105,7 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned ch
 	int vertexTableOffset = fp->vertexTable;
 
 	for (int a = 0; a < fp->vertexTableSize; ++a) {
-		const int vertexDrawIdx = swabDWord(*(int*) &buf[vertexTableOffset]);
+		const int vertexDrawIdx = swabDWord(*(const int*) &buf[vertexTableOffset]);
 
 		piece->SetVertexDrawIndex(a, vertexDrawIdx);
 		vertexTableOffset += sizeof(int);
@@ -115,7 +126,7 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned ch
 	int childTableOffset = fp->children;
 
 	for (int a = 0; a < fp->numchildren; ++a) {
-		int childOffset = swabDWord(*(int*) &buf[childTableOffset]);
+		int childOffset = swabDWord(*(const int*) &buf[childTableOffset]);
 
 		SS3OPiece* childPiece = LoadPiece(model, piece, buf, childOffset);
 		piece->children.push_back(childPiece);
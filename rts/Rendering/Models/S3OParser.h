@@ -61,7 +61,7 @@ public:
 	ModelType GetType() const { return MODELTYPE_S3O; }
 
 private:
-	SS3OPiece* LoadPiece(S3DModel*, SS3OPiece*, unsigned char* buf, int offset);
+	SS3OPiece* LoadPiece(S3DModel*, SS3OPiece*, const unsigned char* buf, int offset);
 };
 
 #endif /* S3O_PARSER_H */
@@ -275,11 +275,13 @@ bool CBitmap::Load(std::string const& filename, unsigned char defaultAlpha)
 	channels = 4;
 
 	CFileHandler file(filename);
-	if (file.FileExists() == false) {
+	if (file.FileExists() == false || file.FileSize() <= 0) {
 		AllocDummy();
 		return false;
 	}
 
+	// ilLoadL takes a non-const buffer, so never hand it a
+	// (read-only) view of the file; keep the usual padding
 	unsigned char* buffer = new unsigned char[file.FileSize() + 2];
 	file.Read(buffer, file.FileSize());
 
@@ -308,7 +310,6 @@ bool CBitmap::Load(std::string const& filename, unsigned char defaultAlpha)
 	{
 		if (!IsValidImageFormat(ilGetInteger(IL_IMAGE_FORMAT))) {
 			LOG_L(L_ERROR, "Invalid image format for %s: %d", filename.c_str(), ilGetInteger(IL_IMAGE_FORMAT));
-			delete[] buffer;
 			return false;
 		}
 	}
@@ -342,7 +343,7 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 	channels = 1;
 
 	CFileHandler file(filename);
-	if (!file.FileExists()) {
+	if (!file.FileExists() || file.FileSize() <= 0) {
 		return false;
 	}
 
@@ -524,8 +524,8 @@ void CFeatureHandler::TerrainChanged(int x1, int y1, int x2, int y2)
 	);
 
 	for (std::vector<int>::const_iterator qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CFeature*>::const_iterator fi;
-		const std::list<CFeature*>& features = quadField->GetQuad(*qi).features;
+		std::vector<CFeature*>::const_iterator fi;
+		const std::vector<CFeature*>& features = quadField->GetQuad(*qi).features;
 
 		for (fi = features.begin(); fi != features.end(); ++fi) {
 			CFeature* feature = *fi;
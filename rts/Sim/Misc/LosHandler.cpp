@@ -12,6 +12,7 @@
 #include "Sim/Misc/TeamHandler.h"
 #include "Map/ReadMap.h"
 #include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
 #include "System/creg/STL_Deque.h"
 #include "System/creg/STL_List.h"
@@ -34,7 +35,8 @@ CR_REG_METADATA(LosInstance,(
 	CR_MEMBER(baseAirPos),
 	CR_MEMBER(hashNum),
 	CR_MEMBER(baseHeight),
-	CR_MEMBER(toBeDeleted)
+	CR_MEMBER(toBeDeleted),
+	CR_IGNORED(pendingIndex)
 ));
 
 void CLosHandler::PostLoad()
@@ -46,12 +48,15 @@ void CLosHandler::PostLoad()
 			}
 		}
 	}
+
+	UpdatePendingLosAdds();
 }
 
 CR_REG_METADATA(CLosHandler,(
 	CR_MEMBER(instanceHash),
 	CR_MEMBER(toBeDeleted),
 	CR_MEMBER(delayQue),
+	CR_IGNORED(pendingLosAdds),
 	CR_RESERVED(8),
 	CR_POSTLOAD(PostLoad)
 ));
@@ -188,10 +193,59 @@ void CLosHandler::LosAdd(LosInstance* instance)
 	assert(instance);
 	assert(teamHandler->IsValidAllyTeam(instance->allyteam));
 
-	losAlgo.LosAdd(instance->basePos, instance->losSize, instance->baseHeight, instance->losSquares);
+	if (!modInfo.losBatchedRaycasts) {
+		losAlgo.LosAdd(instance->basePos, instance->losSize, instance->baseHeight, instance->losSquares);
+
+		if (instance->losSize > 0) { losMaps[instance->allyteam].AddMapSquares(instance->losSquares, instance->allyteam, 1); }
+		if (instance->airLosSize > 0) { airLosMaps[instance->allyteam].AddMapArea(instance->baseAirPos, instance->allyteam, instance->airLosSize, 1); }
+		return;
+	}
+
+	if (instance->pendingIndex >= 0)
+		return;
+
+	instance->pendingIndex = pendingLosAdds.size();
+	pendingLosAdds.push_back(instance);
+}
+
+
+void CLosHandler::UpdatePendingLosAdds()
+{
+	if (pendingLosAdds.empty())
+		return;
+
+	SCOPED_TIMER("LOSHandler::UpdatePendingLosAdds");
+
+	// the raycasts only read the heightmap and write into their own instance
+	// (the workers run with the same FPU settings as the main thread, see
+	// ThreadPool's WorkerLoop)
+	for_mt(0, pendingLosAdds.size(), [&](const int i) {
+		LosInstance* instance = pendingLosAdds[i];
 
-	if (instance->losSize > 0) { losMaps[instance->allyteam].AddMapSquares(instance->losSquares, instance->allyteam, 1); }
-	if (instance->airLosSize > 0) { airLosMaps[instance->allyteam].AddMapArea(instance->baseAirPos, instance->allyteam, instance->airLosSize, 1); }
+		if (instance == NULL)
+			return;
+
+		instance->losSquares.clear();
+		losAlgo.LosAdd(instance->basePos, instance->losSize, instance->baseHeight, instance->losSquares);
+	});
+
+	// apply per ally-team (queue order within each) to keep the LOS-map
+	// updates and the unsynced events they trigger thread-count agnostic
+	for (int allyteam = 0; allyteam < teamHandler->ActiveAllyTeams(); ++allyteam) {
+		for (std::vector<LosInstance*>::const_iterator it = pendingLosAdds.begin(); it != pendingLosAdds.end(); ++it) {
+			LosInstance* instance = *it;
+
+			if (instance == NULL || instance->allyteam != allyteam)
+				continue;
+
+			if (instance->losSize > 0) { losMaps[allyteam].AddMapSquares(instance->losSquares, allyteam, 1); }
+			if (instance->airLosSize > 0) { airLosMaps[allyteam].AddMapArea(instance->baseAirPos, allyteam, instance->airLosSize, 1); }
+
+			instance->pendingIndex = -1;
+		}
+	}
+
+	pendingLosAdds.clear();
 }
 
 
@@ -267,6 +321,13 @@ void CLosHandler::AllocInstance(LosInstance* instance)
 
 void CLosHandler::CleanupInstance(LosInstance* instance)
 {
+	if (instance->pendingIndex >= 0) {
+		// nothing was added to the LOS maps yet, just dequeue
+		pendingLosAdds[instance->pendingIndex] = NULL;
+		instance->pendingIndex = -1;
+		return;
+	}
+
 	if (instance->losSize > 0) { losMaps[instance->allyteam].AddMapSquares(instance->losSquares, instance->allyteam, -1); }
 	if (instance->airLosSize > 0) { airLosMaps[instance->allyteam].AddMapArea(instance->baseAirPos, instance->allyteam, instance->airLosSize, -1); }
 }
@@ -274,10 +335,14 @@ void CLosHandler::CleanupInstance(LosInstance* instance)
 
 void CLosHandler::Update()
 {
+	SCOPED_TIMER("LOSHandler::Update");
+
 	while (!delayQue.empty() && delayQue.front().timeoutTime < gs->frameNum) {
 		FreeInstance(delayQue.front().instance);
 		delayQue.pop_front();
 	}
+
+	UpdatePendingLosAdds();
 }
 
 
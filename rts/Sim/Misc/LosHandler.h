@@ -49,6 +49,7 @@ private:
 		, hashNum(-1)
 		, baseHeight(0.0f)
 		, toBeDeleted(false)
+		, pendingIndex(-1)
 	{}
 
 public:
@@ -64,6 +65,7 @@ public:
 		, hashNum(hashNum)
 		, baseHeight(baseHeight)
 		, toBeDeleted(false)
+		, pendingIndex(-1)
 	{}
 
  	std::vector<int> losSquares;
@@ -77,6 +79,8 @@ public:
 	int hashNum;
 	float baseHeight;
 	bool toBeDeleted;
+	/// index in CLosHandler::pendingLosAdds while queued (losSquares not yet applied), -1 otherwise
+	int pendingIndex;
 };
 
 /**
@@ -99,6 +103,14 @@ public:
  * LOS is not removed immediately when a unit gets killed. Instead,
  * DelayedFreeInstance is called. This keeps the LosInstance (including the
  * actual sight) alive until 1.5 game seconds after the unit got killed.
+ *
+ * With modInfo.losBatchedRaycasts, LOS is not added immediately either:
+ * LosAdd only queues the instance, and Update raycasts all queued instances
+ * in parallel (the heightmap is not modified at that point of the frame) and
+ * then applies their squares to the LOS maps serially, grouped per ally-team
+ * in queue order, so the result does not depend on the number of threads.
+ * LOS of units that moved then only changes at the end of the frame, later
+ * than targeting and Lua see it otherwise.
  */
 class CLosHandler : public boost::noncopyable
 {
@@ -212,6 +224,7 @@ private:
 
 	void PostLoad();
 	void LosAdd(LosInstance* instance);
+	void UpdatePendingLosAdds();
 	int GetHashNum(CUnit* unit);
 	void AllocInstance(LosInstance* instance);
 	void CleanupInstance(LosInstance* instance);
@@ -222,6 +235,9 @@ private:
 
 	std::deque<LosInstance*> toBeDeleted;
 
+	/// instances whose LOS is added by the next UpdatePendingLosAdds (NULL if cleaned up since)
+	std::vector<LosInstance*> pendingLosAdds;
+
 	struct DelayedInstance {
 		CR_DECLARE_STRUCT(DelayedInstance);
 		LosInstance* instance;
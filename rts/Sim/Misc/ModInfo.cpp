@@ -50,6 +50,9 @@ void CModInfo::Init(const char* modArchive)
 		// system
 		const LuaTable& system = root.SubTable("system");
 		pathFinderSystem = system.GetInt("pathFinderSystem", PFS_TYPE_DEFAULT) % PFS_NUM_TYPES;
+		pathFinderSearchesPerFrame = std::max(0, system.GetInt("pathFinderSearchesPerFrame", 0));
+		pathFinderGoalFields = system.GetBool("pathFinderGoalFields", false);
+		pathFinderEstimatorLevels = std::max(0, system.GetInt("pathFinderEstimatorLevels", 0));
 
 	}
 
@@ -174,6 +177,7 @@ void CModInfo::Init(const char* modArchive)
 		// bitshifts with signed integers
 		airMipLevel = los.GetInt("airMipLevel", 2);
 		airLosMul = los.GetFloat("airLosMul", 1.0f);
+		losBatchedRaycasts = los.GetBool("batchedRaycasts", false);
 
 		if ((losMipLevel < 0) || (losMipLevel > 6)) {
 			throw content_error("Sensors\\Los\\LosMipLevel out of bounds. "
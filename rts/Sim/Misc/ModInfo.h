@@ -47,8 +47,12 @@ public:
 		, losMul(1.0f)
 		, airLosMul(1.0f)
 		, requireSonarUnderWater(true)
+		, losBatchedRaycasts(false)
 		, featureVisibility(FEATURELOS_NONE)
 		, pathFinderSystem(PFS_TYPE_DEFAULT)
+		, pathFinderSearchesPerFrame(0)
+		, pathFinderGoalFields(false)
+		, pathFinderEstimatorLevels(0)
 	{}
 
 
@@ -165,6 +169,9 @@ public:
 	float airLosMul;
 	/// when underwater, units are not in LOS unless also in sonar
 	bool requireSonarUnderWater;
+	/// if true, LOS added during a frame is raycast in parallel and only
+	/// applied at the end of the frame (after all units moved)
+	bool losBatchedRaycasts;
 
 	enum {
 		FEATURELOS_NONE = 0, FEATURELOS_GAIAONLY, FEATURELOS_GAIAALLIED, FEATURELOS_ALL,
@@ -175,6 +182,18 @@ public:
 
 	// which pathfinder system (DEFAULT/legacy or QTPFS) the mod will use
 	int pathFinderSystem;
+	// if non-zero, the default pathfinder queues the path-requests of ground
+	// units and performs at most this many (distinct) searches per frame, in
+	// parallel; otherwise every request is searched when it is made
+	int pathFinderSearchesPerFrame;
+	// if true, the estimators of the default pathfinder answer requests for
+	// the same goal made within a few seconds (eg. by a group of units ordered
+	// to one position) from one shared cost-field instead of searching each
+	bool pathFinderGoalFields;
+	// number of coarser estimator levels the default pathfinder stacks on
+	// top of its low-resolution one; long searches of an estimator go along
+	// the path found on the next coarser level first
+	int pathFinderEstimatorLevels;
 };
 
 extern CModInfo modInfo;
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "QuadField.h"
+#include "QuadFieldProjectileCells.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GlobalConstants.h"
@@ -10,7 +11,7 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Projectiles/Projectile.h"
-#include "System/creg/STL_List.h"
+#include "System/Util.h"
 
 #define CELL_IDX_X(wpx) Clamp(int((wpx) / quadSizeX), 0, numQuadsX - 1)
 #define CELL_IDX_Z(wpz) Clamp(int((wpz) / quadSizeZ), 0, numQuadsZ - 1)
@@ -30,7 +31,8 @@ CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_MEMBER(units),
 	CR_MEMBER(teamUnits),
 	CR_MEMBER(features),
-	CR_MEMBER(projectiles)
+	CR_MEMBER(projectiles),
+	CR_MEMBER(unitsVersion)
 ));
 
 CQuadField* quadField = NULL;
@@ -55,21 +57,21 @@ void CQuadField::Resize(unsigned int nqx, unsigned int nqz)
 			//   if a unit exists in multiple quads in the old field, it will
 			//   be removed from all of them and there is no danger of double
 			//   re-insertion (important if new grid has higher resolution)
-			const std::list<CUnit*      > units       = quad.units;
-			const std::list<CFeature*   > features    = quad.features;
-			const std::list<CProjectile*> projectiles = quad.projectiles;
+			const std::vector<CUnit*      > units       = quad.units;
+			const std::vector<CFeature*   > features    = quad.features;
+			const std::vector<CProjectile*> projectiles = quad.projectiles;
 
-			for (std::list<CUnit*>::const_iterator it = units.begin(); it != units.end(); ++it) {
+			for (std::vector<CUnit*>::const_iterator it = units.begin(); it != units.end(); ++it) {
 				oldQuadField->RemoveUnit(*it);
 				newQuadField->MovedUnit(*it); // handles addition
 			}
 
-			for (std::list<CFeature*>::const_iterator it = features.begin(); it != features.end(); ++it) {
+			for (std::vector<CFeature*>::const_iterator it = features.begin(); it != features.end(); ++it) {
 				oldQuadField->RemoveFeature(*it);
 				newQuadField->AddFeature(*it);
 			}
 
-			for (std::list<CProjectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); ++it) {
+			for (std::vector<CProjectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); ++it) {
 				oldQuadField->RemoveProjectile(*it);
 				newQuadField->AddProjectile(*it);
 			}
@@ -84,7 +86,7 @@ void CQuadField::Resize(unsigned int nqx, unsigned int nqz)
 
 
 
-CQuadField::Quad::Quad() : teamUnits(teamHandler->ActiveAllyTeams())
+CQuadField::Quad::Quad() : teamUnits(teamHandler->ActiveAllyTeams()), unitsVersion(0)
 {
 }
 
@@ -154,8 +156,8 @@ unsigned int CQuadField::GetQuads(float3 pos, float radius, int*& begQuad, int*&
 	pos.ClampInBounds();
 	pos.AssertNaNs();
 
-	assert(begQuad == &tempQuads[0]);
-	assert(endQuad == &tempQuads[0]);
+	assert(begQuad != NULL);
+	assert(begQuad == endQuad);
 
 	const int maxx = std::min((int(pos.x + radius)) / quadSizeX + 1, numQuadsX - 1);
 	const int maxz = std::min((int(pos.z + radius)) / quadSizeZ + 1, numQuadsZ - 1);
@@ -195,7 +197,7 @@ std::vector<CUnit*> CQuadField::GetUnits(const float3& pos, float radius)
 	GetQuads(pos, radius, begQuad, endQuad);
 
 	std::vector<CUnit*> units;
-	std::list<CUnit*>::iterator ui;
+	std::vector<CUnit*>::iterator ui;
 
 	for (int* a = begQuad; a != endQuad; ++a) {
 		Quad& quad = baseQuads[*a];
@@ -222,7 +224,7 @@ std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& pos, float radius, b
 	GetQuads(pos, radius, begQuad, endQuad);
 
 	std::vector<CUnit*> units;
-	std::list<CUnit*>::iterator ui;
+	std::vector<CUnit*>::iterator ui;
 
 	for (int* a = begQuad; a != endQuad; ++a) {
 		Quad& quad = baseQuads[*a];
@@ -257,8 +259,8 @@ std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& mins, const float3&
 	std::vector<int>::const_iterator qi;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CUnit*>& quadUnits = baseQuads[*qi].units;
-		std::list<CUnit*>::iterator ui;
+		std::vector<CUnit*>& quadUnits = baseQuads[*qi].units;
+		std::vector<CUnit*>::iterator ui;
 
 		for (ui = quadUnits.begin(); ui != quadUnits.end(); ++ui) {
 			CUnit* unit = *ui;
@@ -449,22 +451,15 @@ void CQuadField::MovedUnit(CUnit* unit)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = unit->quads.begin(); qi != unit->quads.end(); ++qi) {
-		std::list<CUnit*>& quadUnits     = baseQuads[*qi].units;
-		std::list<CUnit*>& quadAllyUnits = baseQuads[*qi].teamUnits[unit->allyteam];
-		std::list<CUnit*>::iterator ui;
-
-		ui = std::find(quadUnits.begin(), quadUnits.end(), unit);
-		if (ui != quadUnits.end())
-			quadUnits.erase(ui);
-
-		ui = std::find(quadAllyUnits.begin(), quadAllyUnits.end(), unit);
-		if (ui != quadAllyUnits.end())
-			quadAllyUnits.erase(ui);
+		VectorErase(baseQuads[*qi].units, unit);
+		VectorErase(baseQuads[*qi].teamUnits[unit->allyteam], unit);
+		baseQuads[*qi].unitsVersion++;
 	}
 
 	for (qi = newQuads.begin(); qi != newQuads.end(); ++qi) {
-		baseQuads[*qi].units.push_front(unit);
-		baseQuads[*qi].teamUnits[unit->allyteam].push_front(unit);
+		baseQuads[*qi].units.push_back(unit);
+		baseQuads[*qi].teamUnits[unit->allyteam].push_back(unit);
+		baseQuads[*qi].unitsVersion++;
 	}
 	unit->quads = newQuads;
 }
@@ -473,17 +468,9 @@ void CQuadField::RemoveUnit(CUnit* unit)
 {
 	std::vector<int>::const_iterator qi;
 	for (qi = unit->quads.begin(); qi != unit->quads.end(); ++qi) {
-		std::list<CUnit*>& quadUnits     = baseQuads[*qi].units;
-		std::list<CUnit*>& quadAllyUnits = baseQuads[*qi].teamUnits[unit->allyteam];
-		std::list<CUnit*>::iterator ui;
-
-		ui = std::find(quadUnits.begin(), quadUnits.end(), unit);
-		if (ui != quadUnits.end())
-			quadUnits.erase(ui);
-
-		ui = std::find(quadAllyUnits.begin(), quadAllyUnits.end(), unit);
-		if (ui != quadAllyUnits.end())
-			quadAllyUnits.erase(ui);
+		VectorErase(baseQuads[*qi].units, unit);
+		VectorErase(baseQuads[*qi].teamUnits[unit->allyteam], unit);
+		baseQuads[*qi].unitsVersion++;
 	}
 	unit->quads.clear();
 }
@@ -496,7 +483,7 @@ void CQuadField::AddFeature(CFeature* feature)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = newQuads.begin(); qi != newQuads.end(); ++qi) {
-		baseQuads[*qi].features.push_front(feature);
+		baseQuads[*qi].features.push_back(feature);
 	}
 }
 
@@ -506,16 +493,16 @@ void CQuadField::RemoveFeature(CFeature* feature)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		baseQuads[*qi].features.remove(feature);
+		VectorErase(baseQuads[*qi].features, feature);
 	}
 
 	#ifdef DEBUG_QUADFIELD
 	for (int x = 0; x < numQuadsX; x++) {
 		for (int z = 0; z < numQuadsZ; z++) {
 			const Quad& q = baseQuads[z * numQuadsX + x];
-			const std::list<CFeature*>& f = q.features;
+			const std::vector<CFeature*>& f = q.features;
 
-			std::list<CFeature*>::const_iterator fIt;
+			std::vector<CFeature*>::const_iterator fIt;
 
 			for (fIt = f.begin(); fIt != f.end(); ++fIt) {
 				assert((*fIt) != feature);
@@ -549,87 +536,50 @@ void CQuadField::MovedProjectile(CProjectile* p)
 	}
 }
 
+// maps cell coordinates to the projectile array of their quad
+struct ProjectileCellLookup {
+	ProjectileCellLookup(std::vector<CQuadField::Quad>& quads, int numQuadsX): quads(quads), numQuadsX(numQuadsX) {}
+
+	std::vector<CProjectile*>& operator () (const int2& coor) const {
+		return quads[numQuadsX * coor.y + coor.x].projectiles;
+	}
+
+	std::vector<CQuadField::Quad>& quads;
+	int numQuadsX;
+};
+
 void CQuadField::AddProjectile(CProjectile* p)
 {
 	assert(p->synced);
 
-	CProjectile::QuadFieldCellData qfcd;
+	CProjectile::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
 
-	typedef CQuadField::Quad Cell;
-	typedef std::list<CProjectile*> List;
+	// all coordinates always map to a valid quad
+	qfcd.SetCoor(0, int2(CELL_IDX_X(p->pos.x), CELL_IDX_Z(p->pos.z)));
 
 	if (p->hitscan) {
-		// all coordinates always map to a valid quad
-		qfcd.SetCoor(0, int2(CELL_IDX_X(p->pos.x                    ), CELL_IDX_Z(p->pos.z                    )));
-		qfcd.SetCoor(1, int2(CELL_IDX_X(p->pos.x + p->speed.x * 0.5f), CELL_IDX_Z(p->pos.z + p->speed.z * 0.5f)));
-		qfcd.SetCoor(2, int2(CELL_IDX_X(p->pos.x + p->speed.x       ), CELL_IDX_Z(p->pos.z + p->speed.z       )));
-
-		Cell& cell = baseQuads[numQuadsX * qfcd.GetCoor(0).y + qfcd.GetCoor(0).x];
-		List& list = cell.projectiles;
-
 		// projectiles are point-objects so they exist
 		// only in a single cell EXCEPT hit-scan types
-		qfcd.SetIter(0, list.insert(list.end(), p));
-
-		for (unsigned int n = 1; n < 3; n++) {
-			Cell& ncell = baseQuads[numQuadsX * qfcd.GetCoor(n).y + qfcd.GetCoor(n).x];
-			List& nlist = ncell.projectiles;
-
-			// prevent possible double insertions (into the same quad-list)
-			// if case p->speed is not large enough to reach adjacent quads
-			if (qfcd.GetCoor(n) != qfcd.GetCoor(n - 1)) {
-				qfcd.SetIter(n, nlist.insert(nlist.end(), p));
-			} else {
-				qfcd.SetIter(n, nlist.end());
-			}
-		}
-	} else {
-		qfcd.SetCoor(0, int2(CELL_IDX_X(p->pos.x), CELL_IDX_Z(p->pos.z)));
-
-		Cell& cell = baseQuads[numQuadsX * qfcd.GetCoor(0).y + qfcd.GetCoor(0).x];
-		List& list = cell.projectiles;
-
-		qfcd.SetIter(0, list.insert(list.end(), p));
+		// (Add skips repeated cells if p->speed is not
+		// large enough to reach adjacent quads)
+		qfcd.SetCoor(1, int2(CELL_IDX_X(p->pos.x + p->speed.x * 0.5f), CELL_IDX_Z(p->pos.z + p->speed.z * 0.5f)));
+		qfcd.SetCoor(2, int2(CELL_IDX_X(p->pos.x + p->speed.x       ), CELL_IDX_Z(p->pos.z + p->speed.z       )));
 	}
 
-	p->SetQuadFieldCellData(qfcd);
+	QuadFieldProjectileCells::Add(p, (p->hitscan)? 3: 1, ProjectileCellLookup(baseQuads, numQuadsX));
 }
 
 void CQuadField::RemoveProjectile(CProjectile* p)
 {
 	assert(p->synced);
+	assert(p->GetQuadFieldCellData().GetIndex(0) >= 0);
 
-	CProjectile::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
-
-	typedef CQuadField::Quad Cell;
-	typedef std::list<CProjectile*> List;
-
-	if (p->hitscan) {
-		for (unsigned int n = 0; n < 3; n++) {
-			Cell& cell = baseQuads[numQuadsX * qfcd.GetCoor(n).y + qfcd.GetCoor(n).x];
-			List& list = cell.projectiles;
-
-			if (qfcd.GetIter(n) != list.end()) {
-				// this is O(1) instead of O(n) and crucially
-				// important for projectiles, but less clean
-				list.erase(qfcd.GetIter(n));
-			}
-
-			qfcd.SetIter(n, list.end());
-		}
-	} else {
-		Cell& cell = baseQuads[numQuadsX * qfcd.GetCoor(0).y + qfcd.GetCoor(0).x];
-		List& list = cell.projectiles;
-
-		assert(qfcd.GetIter(0) != list.end());
-
-		list.erase(qfcd.GetIter(0));
-		qfcd.SetIter(0, list.end());
-	}
+	QuadFieldProjectileCells::Remove(p, ProjectileCellLookup(baseQuads, numQuadsX));
 }
 
 
 
+
 std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float radius)
 {
 	const std::vector<int>& quads = GetQuads(pos, radius);
@@ -637,7 +587,7 @@ std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float rad
 
 	std::vector<CFeature*> features;
 	std::vector<int>::const_iterator qi;
-	std::list<CFeature*>::iterator fi;
+	std::vector<CFeature*>::iterator fi;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
 		for (fi = baseQuads[*qi].features.begin(); fi != baseQuads[*qi].features.end(); ++fi) {
@@ -659,7 +609,7 @@ std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float rad
 
 	std::vector<CFeature*> features;
 	std::vector<int>::const_iterator qi;
-	std::list<CFeature*>::iterator fi;
+	std::vector<CFeature*>::iterator fi;
 	const float totRadSq = radius * radius;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
@@ -685,10 +635,10 @@ std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& mins, const fl
 
 	std::vector<CFeature*> features;
 	std::vector<int>::const_iterator qi;
-	std::list<CFeature*>::iterator fi;
+	std::vector<CFeature*>::iterator fi;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CFeature*>& quadFeatures = baseQuads[*qi].features;
+		std::vector<CFeature*>& quadFeatures = baseQuads[*qi].features;
 
 		for (fi = quadFeatures.begin(); fi != quadFeatures.end(); ++fi) {
 			CFeature* feature = *fi;
@@ -714,10 +664,10 @@ std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& pos, flo
 
 	std::vector<CProjectile*> projectiles;
 	std::vector<int>::const_iterator qi;
-	std::list<CProjectile*>::iterator pi;
+	std::vector<CProjectile*>::iterator pi;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CProjectile*>& quadProjectiles = baseQuads[*qi].projectiles;
+		std::vector<CProjectile*>& quadProjectiles = baseQuads[*qi].projectiles;
 
 		for (pi = quadProjectiles.begin(); pi != quadProjectiles.end(); ++pi) {
 			if ((pos - (*pi)->pos).SqLength() >= Square(radius + (*pi)->radius)) {
@@ -737,10 +687,10 @@ std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& mins, co
 
 	std::vector<CProjectile*> projectiles;
 	std::vector<int>::const_iterator qi;
-	std::list<CProjectile*>::iterator pi;
+	std::vector<CProjectile*>::iterator pi;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CProjectile*>& quadProjectiles = baseQuads[*qi].projectiles;
+		std::vector<CProjectile*>& quadProjectiles = baseQuads[*qi].projectiles;
 
 		for (pi = quadProjectiles.begin(); pi != quadProjectiles.end(); ++pi) {
 			CProjectile* projectile = *pi;
@@ -770,8 +720,8 @@ std::vector<CSolidObject*> CQuadField::GetSolidsExact(
 	std::vector<CSolidObject*> solids;
 	std::vector<int>::const_iterator qi;
 
-	std::list<CUnit*>::iterator ui;
-	std::list<CFeature*>::iterator fi;
+	std::vector<CUnit*>::iterator ui;
+	std::vector<CFeature*>::iterator fi;
 
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
 		for (ui = baseQuads[*qi].units.begin(); ui != baseQuads[*qi].units.end(); ++ui) {
@@ -873,8 +823,8 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 	GetQuads(pos, radius, begQuad, endQuad);
 
-	std::list<CUnit*>::const_iterator ui;
-	std::list<CFeature*>::const_iterator fi;
+	std::vector<CUnit*>::const_iterator ui;
+	std::vector<CFeature*>::const_iterator fi;
 
 	for (int* a = begQuad; a != endQuad; ++a) {
 		const Quad& quad = baseQuads[*a];
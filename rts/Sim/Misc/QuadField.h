@@ -3,9 +3,7 @@
 #ifndef QUAD_FIELD_H
 #define QUAD_FIELD_H
 
-#include <set>
 #include <vector>
-#include <list>
 #include <boost/noncopyable.hpp>
 
 #include "System/creg/creg_cond.h"
@@ -102,13 +100,22 @@ public:
 	void AddProjectile(CProjectile* projectile);
 	void RemoveProjectile(CProjectile* projectile);
 
+	/**
+	 * Objects are kept in contiguous arrays (queries are linear scans) and
+	 * removed by swapping in the last element, so the order of objects in
+	 * a quad is NOT their insertion order. Projectiles store their index
+	 * in each array (CProjectile::QuadFieldCellData) to make removal O(1).
+	 */
 	struct Quad {
 		CR_DECLARE_STRUCT(Quad);
 		Quad();
-		std::list<CUnit*> units;
-		std::vector< std::list<CUnit*> > teamUnits;
-		std::list<CFeature*> features;
-		std::list<CProjectile*> projectiles;
+		std::vector<CUnit*> units;
+		std::vector< std::vector<CUnit*> > teamUnits;
+		std::vector<CFeature*> features;
+		std::vector<CProjectile*> projectiles;
+
+		/// bumped whenever <units> changes, lets callers cache derived lists
+		unsigned int unitsVersion;
 	};
 
 	const Quad& GetQuad(int i) const {
@@ -0,0 +1,82 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QUAD_FIELD_PROJECTILE_CELLS_H
+#define QUAD_FIELD_PROJECTILE_CELLS_H
+
+#include <cassert>
+#include <vector>
+
+#include "System/type2.h"
+
+/**
+ * Projectile bookkeeping of CQuadField. A projectile is in up to three
+ * cells (only one unless hit-scan) and stores its index in each of their
+ * arrays (its QuadFieldCellData), so removal swaps the last element of
+ * the array into its place; the index of that element is patched.
+ *
+ * Templated on the projectile type and a cell-lookup functor (int2 ->
+ * std::vector<P*>&) so it can be tested without the engine.
+ */
+namespace QuadFieldProjectileCells {
+	/**
+	 * Adds <p> to the cells at the first <numCoors> coordinates of its
+	 * cell-data, skipping each that repeats the previous one.
+	 */
+	template<typename P, typename GetCell>
+	static inline void Add(P* p, unsigned int numCoors, GetCell getCell) {
+		typename P::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
+
+		for (unsigned int n = 0; n < numCoors; n++) {
+			if (n > 0 && qfcd.GetCoor(n) == qfcd.GetCoor(n - 1))
+				continue;
+
+			std::vector<P*>& cell = getCell(qfcd.GetCoor(n));
+
+			qfcd.SetIndex(n, cell.size());
+			cell.push_back(p);
+		}
+	}
+
+	/// removes <p> from all cells it was added to
+	template<typename P, typename GetCell>
+	static inline void Remove(P* p, GetCell getCell) {
+		typename P::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
+
+		for (unsigned int n = 0; n < 3; n++) {
+			const int2 coor = qfcd.GetCoor(n);
+			const int index = qfcd.GetIndex(n);
+
+			if (index < 0)
+				continue;
+
+			std::vector<P*>& cell = getCell(coor);
+
+			assert(index < int(cell.size()));
+			assert(cell[index] == p);
+
+			P* q = cell.back();
+
+			cell[index] = q;
+			cell.pop_back();
+			qfcd.SetIndex(n, -1);
+
+			if (q == p)
+				continue;
+
+			// <q> was at the end of this cell before
+			typename P::QuadFieldCellData& mqfcd = q->GetQuadFieldCellData();
+
+			for (unsigned int m = 0; m < 3; m++) {
+				if (mqfcd.GetIndex(m) != int(cell.size()))
+					continue;
+				if (mqfcd.GetCoor(m) != coor)
+					continue;
+
+				mqfcd.SetIndex(m, index);
+				break;
+			}
+		}
+	}
+}
+
+#endif // QUAD_FIELD_PROJECTILE_CELLS_H
@@ -125,6 +125,8 @@ CR_REG_METADATA(CGroundMoveType, (
 	CR_MEMBER(skidRotSpeed),
 	CR_MEMBER(skidRotAccel),
 
+	CR_IGNORED(terrainQueries),
+
 	CR_POSTLOAD(PostLoad)
 ));
 
@@ -181,6 +183,8 @@ CGroundMoveType::CGroundMoveType(CUnit* owner):
 
 	wantedHeading(0)
 {
+	terrainQueries.moveDef = NULL;
+
 	if (owner == NULL)
 		return;
 
@@ -266,6 +270,25 @@ bool CGroundMoveType::OwnerMoved(const short oldHeading, const float3& posDif, c
 	return true;
 }
 
+void CGroundMoveType::UpdateCompute()
+{
+	// NOTE:
+	//   runs on a pool thread concurrently with the other units, so only
+	//   the terrain maps and our own owner are read here (no quad-field,
+	//   whose queries stamp tempNum) and nothing but the cache is written
+	if (owner->GetTransporter() != NULL)
+		return;
+
+	const float3& pos = owner->pos;
+
+	terrainQueries.moveDef = owner->moveDef;
+	terrainQueries.terrainVersion = readMap->GetSyncedTerrainVersion();
+	terrainQueries.pos = pos;
+	terrainQueries.dir = flatFrontDir;
+	terrainQueries.slope = CGround::GetSlope(pos.x, pos.z);
+	terrainQueries.speedMod = CMoveMath::GetPosSpeedMod(*owner->moveDef, pos, flatFrontDir);
+}
+
 bool CGroundMoveType::Update()
 {
 	ASSERT_SYNCED(owner->pos);
@@ -559,12 +582,11 @@ void CGroundMoveType::ChangeSpeed(float newWantedSpeed, bool wantReverse, bool f
 	{
 		if (wantedSpeed > 0.0f) {
 			const UnitDef* ud = owner->unitDef;
-			const MoveDef* md = owner->moveDef;
 
 			// the pathfinders do NOT check the entire footprint to determine
 			// passability wrt. terrain (only wrt. structures), so we look at
 			// the center square ONLY for our current speedmod
-			const float groundSpeedMod = CMoveMath::GetPosSpeedMod(*md, owner->pos, flatFrontDir);
+			const float groundSpeedMod = GetGroundSpeedMod(owner->pos, flatFrontDir);
 
 			const float curGoalDistSq = (owner->pos - goalPos).SqLength2D();
 			const float minGoalDistSq = Square(BrakingDistance(currentSpeed, mix(decRate, accRate, reversing)));
@@ -2141,7 +2163,7 @@ bool CGroundMoveType::OnSlope(float minSlideTolerance) {
 	// (otherwise the unit could stop on an invalid path location, and be teleported
 	// back)
 	const float slopeMul = mix(ud->slideTolerance, 1.0f, (minSlideTolerance <= 0.0f));
-	const float curSlope = CGround::GetSlope(pos.x, pos.z);
+	const float curSlope = GetGroundSlope(pos);
 	const float maxSlope = md->maxSlope * slopeMul;
 
 	return (curSlope > maxSlope);
@@ -2174,6 +2196,36 @@ float CGroundMoveType::GetGroundHeight(const float3& p) const
 	return gh;
 }
 
+bool CGroundMoveType::HaveTerrainQueries(const float3& p) const
+{
+	// compare exactly, so a cached result is only used where recomputing
+	// it would give the same bits (keeps both unit-update paths in sync)
+	if (terrainQueries.moveDef != owner->moveDef)
+		return false;
+	if (terrainQueries.terrainVersion != readMap->GetSyncedTerrainVersion())
+		return false;
+
+	return (p.x == terrainQueries.pos.x && p.z == terrainQueries.pos.z);
+}
+
+float CGroundMoveType::GetGroundSlope(const float3& p) const
+{
+	if (HaveTerrainQueries(p))
+		return terrainQueries.slope;
+
+	return (CGround::GetSlope(p.x, p.z));
+}
+
+float CGroundMoveType::GetGroundSpeedMod(const float3& p, const float3& dir) const
+{
+	const float3& cdir = terrainQueries.dir;
+
+	if (HaveTerrainQueries(p) && dir.x == cdir.x && dir.y == cdir.y && dir.z == cdir.z)
+		return terrainQueries.speedMod;
+
+	return (CMoveMath::GetPosSpeedMod(*owner->moveDef, p, dir));
+}
+
 void CGroundMoveType::AdjustPosToWaterLine()
 {
 	if (owner->IsFalling())
@@ -21,6 +21,7 @@ public:
 
 	void PostLoad();
 
+	void UpdateCompute();
 	bool Update();
 	void SlowUpdate();
 
@@ -128,6 +129,9 @@ private:
 
 	const float3& GetGroundNormal(const float3&) const;
 	float GetGroundHeight(const float3&) const;
+	float GetGroundSlope(const float3&) const;
+	float GetGroundSpeedMod(const float3&, const float3&) const;
+	bool HaveTerrainQueries(const float3&) const;
 	void AdjustPosToWaterLine();
 	bool UpdateDirectControl();
 	void UpdateOwnerSpeedAndHeading();
@@ -189,6 +193,21 @@ private:
 	unsigned int numIdlingSlowUpdates;
 
 	short wantedHeading;
+
+	/// terrain queries at the owner's position, made by UpdateCompute() and
+	/// used by Update() only where its inputs still match (never saved)
+	struct TerrainQueries {
+		const MoveDef* moveDef; // NULL until the first UpdateCompute()
+		unsigned int terrainVersion;
+
+		float3 pos;
+		float3 dir;
+
+		float slope;
+		float speedMod;
+	};
+
+	TerrainQueries terrainQueries;
 };
 
 #endif // GROUNDMOVETYPE_H
@@ -43,6 +43,10 @@ public:
 	virtual void SetMaxSpeed(float speed) { maxSpeed = std::max(0.001f, speed); }
 	virtual void SetWantedMaxSpeed(float speed) { maxWantedSpeed = speed; }
 
+	// read-only part of Update(), run for all units on the thread pool
+	// before their serial Update()'s when MultiThreadedUnitUpdate is set;
+	// may only write state of this move-type that Update() validates
+	virtual void UpdateCompute() {}
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 
@@ -28,10 +28,22 @@ static const unsigned int PATHESTIMATOR_VERSION = 55;
 
 static const unsigned int MEDRES_PE_BLOCKSIZE =  8;
 static const unsigned int LOWRES_PE_BLOCKSIZE = 32;
+// wrt. the block-size of the next finer estimator
+static const unsigned int COARSE_PE_BLOCKSIZE_FACTOR = 4;
 
 static const unsigned int SQUARES_TO_UPDATE = 1000;
 static const unsigned int MAX_SEARCHED_NODES_ON_REFINE = 2000;
 
+// PE goal-fields are calculated once this many requests for the same goal
+// were made less than GOAL_FIELD_LIFETIME frames apart, and recalculated
+// when they get older than that; each covers the requested start-blocks
+// plus a margin (relative to the cost of the most expensive of them)
+static const unsigned int GOAL_FIELD_MIN_REQUESTS = 2;
+static const int GOAL_FIELD_LIFETIME = GAME_SPEED * 4;
+static const int GOAL_FIELD_CALC_INTERVAL = GAME_SPEED / 2;
+static const unsigned int GOAL_FIELD_MAX_CALCS_PER_FRAME = 2;
+static const float GOAL_FIELD_COST_MARGIN = 1.25f;
+
 static const unsigned int PATH_HEATMAP_XSCALE =  1; // wrt. gs->hmapx
 static const unsigned int PATH_HEATMAP_ZSCALE =  1; // wrt. gs->hmapy
 static const unsigned int PATH_FLOWMAP_XSCALE = 32; // wrt. gs->mapx
@@ -67,6 +79,7 @@ static const unsigned int PATHOPT_CLOSED    =  64;
 static const unsigned int PATHOPT_FORBIDDEN = 128;
 static const unsigned int PATHOPT_BLOCKED   = 256;
 static const unsigned int PATHOPT_OBSOLETE  = 512;
+static const unsigned int PATHOPT_PRIORITY  = 1024; // PE-only: obsolete block on a path in use
 
 
 
@@ -4,13 +4,16 @@
 
 #include "PathEstimator.h"
 
+#include <cstdio>
 #include <fstream>
+#include <functional>
+#include <zlib.h>
 #include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/thread/barrier.hpp>
 #include <boost/thread/thread.hpp>
 
-#include "minizip/zip.h"
-
 #include "PathAllocator.h"
 #include "PathCache.h"
 #include "PathFinder.h"
@@ -24,23 +27,74 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/CRC.h"
 #include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
+#include "System/FileSystem/Archives/FileView.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
+#include "System/Misc/SpringTime.h"
 
 
 CONFIG(int, MaxPathCostsMemoryFootPrint).defaultValue(512).minimumValue(64).description("Maximum memusage (in MByte) of mutlithreaded pathcache generator at loading time.");
+CONFIG(bool, CompressPathCache).defaultValue(false).description("Compress newly written pathcache files (smaller, but slower to load).");
 
 
 
 // indexed by PATHDIR*
 static int2 PE_DIRECTION_VECTORS[PATH_DIRECTIONS];
 
+// bump when the layout of the cache files changes
+static const char CACHE_MAGIC[8] = {'S', 'P', 'R', 'P', 'E', 'C', 'C', '\0'};
+static const boost::uint32_t CACHE_VERSION = 1;
+
+/**
+ * Cache files start with this header, followed by the block offsets of
+ * every block (one int2 per MoveDef) and the vertex costs, both 16-byte
+ * aligned; this data is zlib-compressed as a whole if <compressed> is set.
+ */
+struct PathCacheHeader {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t hash;
+	boost::uint32_t checksum;                   ///< pathChecksum of the data
+	boost::uint32_t compressed;
+	boost::uint32_t blockSize;
+	boost::uint32_t numBlocks;
+	boost::uint32_t numMoveDefs;
+	boost::uint32_t numVertexCosts;
+	boost::uint64_t dataSize;                   ///< bytes following the header
+	boost::uint8_t padding[16];
+};
+
+BOOST_STATIC_ASSERT(sizeof(PathCacheHeader) == 64);
+
+struct PathCacheLayout {
+	PathCacheLayout(size_t numBlocks, size_t numMoveDefs, size_t numVertexCosts)
+		: offsetsSize(numBlocks * numMoveDefs * sizeof(int2))
+		, costsOffset((offsetsSize + 15) & ~size_t(15))
+		, costsSize(numVertexCosts * sizeof(float))
+		, dataSize(costsOffset + costsSize)
+	{}
+
+	// CRC of the hash and the data, as it was of the zipped
+	// caches used before (which stored them without padding)
+	boost::uint32_t GetChecksum(boost::uint32_t hash, const boost::uint8_t* data) const {
+		CRC crc;
+		crc.Update(hash);
+		crc.Update(data, offsetsSize);
+		crc.Update(data + costsOffset, costsSize);
+		return crc.GetDigest();
+	}
+
+	size_t offsetsSize;
+	size_t costsOffset;
+	size_t costsSize;
+	size_t dataSize;
+};
+
 
 
 static const std::string GetPathCacheDir() {
@@ -55,7 +109,7 @@ static size_t GetNumThreads() {
 
 
 
-CPathEstimator::CPathEstimator(CPathFinder* pf, unsigned int BSIZE, const std::string& cacheFileName, const std::string& mapFileName):
+CPathEstimator::CPathEstimator(CPathFinder* pf, unsigned int BSIZE, const std::string& cacheFileName, const std::string& mapFileName, const CPathEstimator* bpe):
 	BLOCK_SIZE(BSIZE),
 	BLOCK_PIXEL_SIZE(BSIZE * SQUARE_SIZE),
 	BLOCKS_TO_UPDATE(SQUARES_TO_UPDATE / (BLOCK_SIZE * BLOCK_SIZE) + 1),
@@ -71,23 +125,149 @@ CPathEstimator::CPathEstimator(CPathFinder* pf, unsigned int BSIZE, const std::s
 
 	mStartBlockIdx(0),
 	mGoalHeuristic(0.0f),
-	blockUpdatePenalty(0)
+	blockUpdatePenalty(0),
+	mapChangeMargin(1),
+	numQueuedBlocks(0),
+	numPriorityBlocks(0),
+
+	goalFieldCalcFrame(-1),
+	numGoalFieldCalcsInFrame(0)
 {
  	pathFinder = pf;
+	parent = this;
+	basePE = bpe;
+	coarsePE = NULL;
+	vertexSearches = false;
 
 	mGoalSqrOffset.x = BLOCK_SIZE >> 1;
 	mGoalSqrOffset.y = BLOCK_SIZE >> 1;
 
 	vertexCosts.resize(moveDefHandler->GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
 
+	// structures block every square whose footprint they overlap
+	for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+
+		if (md->udRefCount == 0)
+			continue;
+
+		mapChangeMargin = std::max(mapChangeMargin, 1 + std::max(md->xsizeh, md->zsizeh));
+	}
+
 	// load precalculated data if it exists
 	InitEstimator(cacheFileName, mapFileName);
 }
 
+CPathEstimator::CPathEstimator(const CPathEstimator* pe, bool vs):
+	BLOCK_SIZE(pe->BLOCK_SIZE),
+	BLOCK_PIXEL_SIZE(pe->BLOCK_PIXEL_SIZE),
+	BLOCKS_TO_UPDATE(pe->BLOCKS_TO_UPDATE),
+	nbrOfBlocksX(pe->nbrOfBlocksX),
+	nbrOfBlocksZ(pe->nbrOfBlocksZ),
+
+	nextOffsetMessageIdx(0),
+	nextCostMessageIdx(0),
+	pathChecksum(pe->pathChecksum),
+	offsetBlockNum(0),
+	costBlockNum(0),
+	blockStates(int2(nbrOfBlocksX, nbrOfBlocksZ), int2(gs->mapx, gs->mapy)),
+
+	mStartBlockIdx(0),
+	mGoalHeuristic(0.0f),
+	blockUpdatePenalty(0),
+	mapChangeMargin(1),
+	numQueuedBlocks(0),
+	numPriorityBlocks(0),
+
+	goalFieldCalcFrame(-1),
+	numGoalFieldCalcsInFrame(0)
+{
+	// only the search-state in blockStates is used, the
+	// block offsets and vertex costs are read from <pe>
+	pathFinder = NULL;
+	pathBarrier = NULL;
+	pathCache[0] = NULL;
+	pathCache[1] = NULL;
+	parent = pe;
+	basePE = NULL;
+	// corridor-searches need a helper of the coarser level as well
+	coarsePE = (pe->coarsePE != NULL && !vs)? new CPathEstimator(pe->coarsePE): NULL;
+	vertexSearches = vs;
+
+	mGoalSqrOffset.x = BLOCK_SIZE >> 1;
+	mGoalSqrOffset.y = BLOCK_SIZE >> 1;
+}
+
 CPathEstimator::~CPathEstimator()
 {
+	if (parent != this) {
+		// vertex-searches are not requests, leave them out
+		if (!vertexSearches) {
+			const_cast<CPathEstimator*>(parent)->searchStats += searchStats;
+		}
+	} else {
+		LogSearchStats();
+	}
+
+	delete coarsePE; coarsePE = NULL;
 	delete pathCache[0]; pathCache[0] = NULL;
 	delete pathCache[1]; pathCache[1] = NULL;
+
+	if (!basePEs.empty()) {
+		delete basePEs[0]; basePEs[0] = NULL;
+	}
+}
+
+void CPathEstimator::LogSearchStats() const {
+	if (!LOG_IS_ENABLED(L_DEBUG))
+		return;
+
+	const SearchStats& ss = searchStats;
+
+	LOG_L(L_DEBUG, "[%s(%u)] %u regular searches (%.1f blocks and %.1fus per search)",
+		__FUNCTION__, BLOCK_SIZE, ss.numSearches,
+		ss.numTestedBlocks / std::max(1.0f, float(ss.numSearches)),
+		ss.searchTime / std::max(1.0f, float(ss.numSearches)));
+	LOG_L(L_DEBUG, "[%s(%u)] %u corridor searches, %u failed (%.1f blocks and %.1fus per search)",
+		__FUNCTION__, BLOCK_SIZE, ss.numCorridorSearches, ss.numCorridorFailures,
+		ss.numCorridorTestedBlocks / std::max(1.0f, float(ss.numCorridorSearches)),
+		ss.corridorSearchTime / std::max(1.0f, float(ss.numCorridorSearches)));
+
+	LOG_L(L_DEBUG, "[%s(%u)] %u goal-field calculations (%.1f blocks per calculation), %u goal-field paths",
+		__FUNCTION__, BLOCK_SIZE, ss.numGoalFieldCalcs,
+		ss.numGoalFieldBlocks / std::max(1.0f, float(ss.numGoalFieldCalcs)), ss.numGoalFieldPaths);
+}
+
+CPathEstimator::SearchStats::SearchStats():
+	numSearches(0),
+	numCorridorSearches(0),
+	numCorridorFailures(0),
+	numGoalFieldCalcs(0),
+	numGoalFieldPaths(0),
+
+	numTestedBlocks(0),
+	numCorridorTestedBlocks(0),
+	numGoalFieldBlocks(0),
+
+	searchTime(0),
+	corridorSearchTime(0)
+{
+}
+
+CPathEstimator::SearchStats& CPathEstimator::SearchStats::operator += (const SearchStats& s) {
+	numSearches += s.numSearches;
+	numCorridorSearches += s.numCorridorSearches;
+	numCorridorFailures += s.numCorridorFailures;
+	numGoalFieldCalcs += s.numGoalFieldCalcs;
+	numGoalFieldPaths += s.numGoalFieldPaths;
+
+	numTestedBlocks += s.numTestedBlocks;
+	numCorridorTestedBlocks += s.numCorridorTestedBlocks;
+	numGoalFieldBlocks += s.numGoalFieldBlocks;
+
+	searchTime += s.searchTime;
+	corridorSearchTime += s.corridorSearchTime;
+	return *this;
 }
 
 void* CPathEstimator::operator new(size_t size) { return PathAllocator::Alloc(size); }
@@ -121,17 +301,26 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 	if (threads.size() != numThreads) {
 		threads.resize(numThreads);
 		pathFinders.resize(numThreads);
+		basePEs.resize(numThreads, NULL);
 	}
 
 	pathFinders[0] = pathFinder;
 
+	// coarser levels search a helper of the finer one per thread instead
+	// (the first is kept for the vertices recalculated by Update)
+	if (basePE != NULL) {
+		basePEs[0] = new CPathEstimator(basePE, true);
+	}
+
 	// Not much point in multithreading these...
 	InitBlocks();
 
 	if (!ReadFile(cacheFileName, map)) {
 		// start extra threads if applicable, but always keep the total
 		// memory-footprint made by CPathFinder instances within bounds
-		const unsigned int minMemFootPrint = sizeof(CPathFinder) + pathFinder->GetMemFootPrint();
+		const unsigned int minMemFootPrint = (basePE == NULL)?
+			(sizeof(CPathFinder) + pathFinder->GetMemFootPrint()):
+			(sizeof(CPathEstimator) + basePEs[0]->blockStates.GetMemFootPrint());
 		const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
 		const unsigned int numExtraThreads = std::min(int(numThreads - 1), std::max(0, int(maxMemFootPrint / minMemFootPrint) - 1));
 		const unsigned int reqMemFootPrint = minMemFootPrint * (numExtraThreads + 1);
@@ -150,7 +339,12 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 		pathBarrier = new boost::barrier(numExtraThreads + 1);
 
 		for (unsigned int i = 1; i <= numExtraThreads; i++) {
-			pathFinders[i] = new CPathFinder();
+			if (basePE == NULL) {
+				pathFinders[i] = new CPathFinder();
+			} else {
+				basePEs[i] = new CPathEstimator(basePE, true);
+			}
+
 			threads[i] = new boost::thread(boost::bind(&CPathEstimator::CalcOffsetsAndPathCosts, this, i));
 		}
 
@@ -160,7 +354,8 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 		for (unsigned int i = 1; i <= numExtraThreads; i++) {
 			threads[i]->join();
 			delete threads[i];
-			delete pathFinders[i];
+			delete pathFinders[i]; pathFinders[i] = NULL;
+			delete basePEs[i]; basePEs[i] = NULL;
 		}
 
 		delete pathBarrier;
@@ -175,6 +370,24 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 }
 
 
+CPathEstimator* CPathEstimator::AddCoarseLevel(unsigned int factor, const std::string& cacheFileName, const std::string& mapFileName)
+{
+	assert(parent == this && coarsePE == NULL);
+
+	const unsigned int coarseBlockSize = BLOCK_SIZE * factor;
+
+	// blocks must cover the map exactly (a
+	// start could be in none otherwise)
+	if ((gs->mapx % coarseBlockSize) != 0 || (gs->mapy % coarseBlockSize) != 0)
+		return NULL;
+	if ((gs->mapx / coarseBlockSize) < 4 || (gs->mapy / coarseBlockSize) < 4)
+		return NULL;
+
+	coarsePE = new CPathEstimator(NULL, coarseBlockSize, cacheFileName, mapFileName, this);
+	return coarsePE;
+}
+
+
 
 void CPathEstimator::InitBlocks() {
 	for (unsigned int idx = 0; idx < blockStates.GetSize(); idx++) {
@@ -383,7 +596,13 @@ void CPathEstimator::CalculateVertex(
 	// since CPathFinder::GetPath() is not thread-safe, use
 	// this thread's "private" CPathFinder instance (rather
 	// than locking pathFinder->GetPath()) if we are in one
-	result = pathFinders[threadNum]->GetPath(moveDef, pfDef, NULL, startPos, path, MAX_SEARCHED_NODES_PF >> 2, false, true, false, true, true);
+	if (basePE == NULL) {
+		result = pathFinders[threadNum]->GetPath(moveDef, pfDef, NULL, startPos, path, MAX_SEARCHED_NODES_PF >> 2, false, true, false, true, true);
+	} else {
+		// same for coarser levels, which go through the finer blocks (their
+		// helpers ignore extra- and flow-costs, so this is deterministic)
+		result = basePEs[threadNum]->GetPath(moveDef, pfDef, startPos, path, MAX_SEARCHED_NODES_PE >> 2, false);
+	}
 
 	// store the result
 	if (result == IPath::Ok) {
@@ -398,39 +617,26 @@ void CPathEstimator::CalculateVertex(
  * Mark affected blocks as obsolete
  */
 void CPathEstimator::MapChanged(unsigned int x1, unsigned int z1, unsigned int x2, unsigned z2) {
-	// find the upper and lower corner of the rectangular area
-	int lowerX, upperX;
-	int lowerZ, upperZ;
-
-	if (x1 < x2) {
-		lowerX = (x1 / BLOCK_SIZE) - 1;
-		upperX = (x2 / BLOCK_SIZE);
-	} else {
-		lowerX = (x2 / BLOCK_SIZE) - 1;
-		upperX = (x1 / BLOCK_SIZE);
-	}
-	if (z1 < z2) {
-		lowerZ = (z1 / BLOCK_SIZE) - 1;
-		upperZ = (z2 / BLOCK_SIZE);
-	} else {
-		lowerZ = (z2 / BLOCK_SIZE) - 1;
-		upperZ = (z1 / BLOCK_SIZE);
-	}
-
-	// error-check
-	upperX = std::min(upperX, int(nbrOfBlocksX - 1));
-	upperZ = std::min(upperZ, int(nbrOfBlocksZ - 1));
-	lowerX = std::max(lowerX,                    0 );
-	lowerZ = std::max(lowerZ,                    0 );
+	// find the blocks containing the rectangular area, with a margin of one
+	// square for the speed-modifiers (slopes) of the squares along its edges
+	// plus the largest MoveDef footprint half-size for structures (which
+	// block every square a footprint centered on would overlap them)
+	//
+	// since vertex-searches are constrained to the two blocks they connect,
+	// no other blocks' offsets or vertices can change
+	const int lowerX = std::max(int(std::min(x1, x2)) - mapChangeMargin, 0) / int(BLOCK_SIZE);
+	const int lowerZ = std::max(int(std::min(z1, z2)) - mapChangeMargin, 0) / int(BLOCK_SIZE);
+	const int upperX = std::min(int(std::max(x1, x2)) + mapChangeMargin, gs->mapx - 1) / int(BLOCK_SIZE);
+	const int upperZ = std::min(int(std::max(z1, z2)) + mapChangeMargin, gs->mapy - 1) / int(BLOCK_SIZE);
 
 	// mark the blocks inside the rectangle, enqueue them
-	// from upper to lower because of the placement of the
-	// bi-directional vertices
-	for (int z = upperZ; z >= lowerZ; z--) {
-		for (int x = upperX; x >= lowerX; x--) {
+	for (int z = lowerZ; z <= std::min(upperZ, int(nbrOfBlocksZ - 1)); z++) {
+		for (int x = lowerX; x <= std::min(upperX, int(nbrOfBlocksX - 1)); x++) {
 			if ((blockStates.nodeMask[z * nbrOfBlocksX + x] & PATHOPT_OBSOLETE) != 0)
 				continue;
 
+			const unsigned int numUpdatedBlocks = updatedBlocks.size();
+
 			for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
 				const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
 
@@ -443,20 +649,57 @@ void CPathEstimator::MapChanged(unsigned int x1, unsigned int z1, unsigned int x
 					sb.moveDef = md;
 
 				updatedBlocks.push_back(sb);
-				blockStates.nodeMask[z * nbrOfBlocksX + x] |= PATHOPT_OBSOLETE;
 			}
+
+			if (updatedBlocks.size() == numUpdatedBlocks)
+				continue;
+
+			blockStates.nodeMask[z * nbrOfBlocksX + x] |= PATHOPT_OBSOLETE;
+			numQueuedBlocks += 1;
 		}
 	}
 }
 
 
+void CPathEstimator::PrioritizeBlocks(const IPath::Path& path) {
+	for (unsigned int n = 0; n < path.path.size(); n++) {
+		const unsigned int blockX = std::min(std::max(0, int(path.path[n].x / BLOCK_PIXEL_SIZE)), int(nbrOfBlocksX - 1));
+		const unsigned int blockZ = std::min(std::max(0, int(path.path[n].z / BLOCK_PIXEL_SIZE)), int(nbrOfBlocksZ - 1));
+		const unsigned int blockN = blockZ * nbrOfBlocksX + blockX;
+
+		// only queued blocks not moved ahead yet
+		if ((blockStates.nodeMask[blockN] & (PATHOPT_OBSOLETE | PATHOPT_PRIORITY)) != PATHOPT_OBSOLETE)
+			continue;
+
+		blockStates.nodeMask[blockN] |= PATHOPT_PRIORITY;
+		priorityBlocks.push_back(blockN);
+		numPriorityBlocks += 1;
+	}
+}
+
+
 /**
- * Update some obsolete blocks using the FIFO-principle
+ * Update some obsolete blocks, those on paths in use first
+ * and then using the FIFO-principle
  */
 void CPathEstimator::Update() {
 	pathCache[0]->Update();
 	pathCache[1]->Update();
 
+	// (catches up with the blocks updated here before)
+	if (coarsePE != NULL) {
+		coarsePE->Update();
+	}
+
+	// forget goals no longer requested
+	for (std::map<GoalFieldKey, GoalField>::iterator it = goalFields.begin(); it != goalFields.end(); ) {
+		if ((it->second.lastRequestFrame + GOAL_FIELD_LIFETIME) < gs->frameNum) {
+			goalFields.erase(it++);
+		} else {
+			++it;
+		}
+	}
+
 	static const unsigned int MIN_BLOCKS_TO_UPDATE = std::max(BLOCKS_TO_UPDATE >> 1, 4U);
 	static const unsigned int MAX_BLOCKS_TO_UPDATE = std::min(BLOCKS_TO_UPDATE << 1, MIN_BLOCKS_TO_UPDATE);
 	const unsigned int progressiveUpdates = updatedBlocks.size() * 0.007f * ((BLOCK_SIZE >= 16)? 1.0f : 0.6f);
@@ -467,51 +710,97 @@ void CPathEstimator::Update() {
 	if (blockUpdatePenalty >= blocksToUpdate)
 		return;
 
-	if (updatedBlocks.empty())
+	if (numQueuedBlocks == 0) {
+		// drop the entries of blocks updated ahead of them
+		updatedBlocks.clear();
 		return;
+	}
 
 	std::vector<SingleBlock> consumedBlocks;
 	consumedBlocks.reserve(blocksToUpdate);
 
-	int2 curBatchBlockPos = (updatedBlocks.front()).blockPos;
-	int2 nxtBatchBlockPos = curBatchBlockPos;
-
-	while (!updatedBlocks.empty()) {
-		nxtBatchBlockPos = (updatedBlocks.front()).blockPos;
+	// blocks on paths in use first, with all MoveDefs at once
+	while (!priorityBlocks.empty() && consumedBlocks.size() < blocksToUpdate) {
+		const unsigned int blockN = priorityBlocks.front();
+		priorityBlocks.pop_front();
 
-		if ((blockStates.nodeMask[nxtBatchBlockPos.y * nbrOfBlocksX + nxtBatchBlockPos.x] & PATHOPT_OBSOLETE) == 0) {
-			updatedBlocks.pop_front();
+		if ((blockStates.nodeMask[blockN] & PATHOPT_OBSOLETE) == 0)
 			continue;
+
+		// makes the FIFO skip this block's entries in updatedBlocks
+		numPriorityBlocks -= ((blockStates.nodeMask[blockN] & PATHOPT_PRIORITY) != 0);
+		blockStates.nodeMask[blockN] &= ~(PATHOPT_OBSOLETE | PATHOPT_PRIORITY);
+		numQueuedBlocks -= 1;
+
+		for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
+			const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+
+			if (md->udRefCount == 0)
+				continue;
+
+			SingleBlock sb;
+				sb.blockPos.x = blockN % nbrOfBlocksX;
+				sb.blockPos.y = blockN / nbrOfBlocksX;
+				sb.moveDef = md;
+
+			consumedBlocks.push_back(sb);
 		}
+	}
+
+	if (!updatedBlocks.empty() && consumedBlocks.size() < blocksToUpdate) {
+		int2 curBatchBlockPos = (updatedBlocks.front()).blockPos;
+		int2 nxtBatchBlockPos = curBatchBlockPos;
+
+		while (!updatedBlocks.empty()) {
+			nxtBatchBlockPos = (updatedBlocks.front()).blockPos;
 
-		// MapChanged ensures format of updatedBlocks is {
-		//   (x1,y1,pt1), (x1,y1,pt2), ..., (x1,y1,ptN), // 1st batch
-		//   (x2,y2,pt1), (x2,y2,pt2), ..., (x2,y2,ptN), // 2nd batch
-		//   ...
-		// }
-		//
-		// always process all MoveDefs of a block in one batch (even
-		// if we need to exceed blocksToUpdate to complete the batch)
-		//
-		// needed because blockStates.nodeMask saves PATHOPT_OBSOLETE
-		// for the block as a whole, not for every individual MoveDef
-		// (and terrain changes might affect only a subset of MoveDefs)
-		//
-		// if we didn't use batches, block changes might be missed for
-		// MoveDefs lower in the (path-type) ordering so we only allow
-		// exiting the loop at batch boundaries
-		if (nxtBatchBlockPos != curBatchBlockPos) {
-			curBatchBlockPos = nxtBatchBlockPos;
-
-			if (consumedBlocks.size() >= blocksToUpdate) {
-				break;
+			if ((blockStates.nodeMask[nxtBatchBlockPos.y * nbrOfBlocksX + nxtBatchBlockPos.x] & PATHOPT_OBSOLETE) == 0) {
+				updatedBlocks.pop_front();
+				continue;
 			}
+
+			// MapChanged ensures format of updatedBlocks is {
+			//   (x1,y1,pt1), (x1,y1,pt2), ..., (x1,y1,ptN), // 1st batch
+			//   (x2,y2,pt1), (x2,y2,pt2), ..., (x2,y2,ptN), // 2nd batch
+			//   ...
+			// }
+			//
+			// always process all MoveDefs of a block in one batch (even
+			// if we need to exceed blocksToUpdate to complete the batch)
+			//
+			// needed because blockStates.nodeMask saves PATHOPT_OBSOLETE
+			// for the block as a whole, not for every individual MoveDef
+			// (and terrain changes might affect only a subset of MoveDefs)
+			//
+			// if we didn't use batches, block changes might be missed for
+			// MoveDefs lower in the (path-type) ordering so we only allow
+			// exiting the loop at batch boundaries
+			if (nxtBatchBlockPos != curBatchBlockPos) {
+				curBatchBlockPos = nxtBatchBlockPos;
+
+				if (consumedBlocks.size() >= blocksToUpdate) {
+					break;
+				}
+			}
+
+			// no need to check for duplicates, because FindOffset is deterministic
+			// so even when we compute it multiple times the result will be the same
+			consumedBlocks.push_back(updatedBlocks.front());
+			updatedBlocks.pop_front();
 		}
+	}
+
+	// all batches are complete
+	for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
+		const unsigned int blockN = consumedBlocks[n].blockPos.y * nbrOfBlocksX + consumedBlocks[n].blockPos.x;
+
+		if ((blockStates.nodeMask[blockN] & PATHOPT_OBSOLETE) == 0)
+			continue;
 
-		// no need to check for duplicates, because FindOffset is deterministic
-		// so even when we compute it multiple times the result will be the same
-		consumedBlocks.push_back(updatedBlocks.front());
-		updatedBlocks.pop_front();
+		// (its stale priorityBlocks entry is skipped when reached)
+		numPriorityBlocks -= ((blockStates.nodeMask[blockN] & PATHOPT_PRIORITY) != 0);
+		blockStates.nodeMask[blockN] &= ~(PATHOPT_OBSOLETE | PATHOPT_PRIORITY);
+		numQueuedBlocks -= 1;
 	}
 
 	blockUpdatePenalty += std::max(0, int(consumedBlocks.size()) - int(blocksToUpdate));
@@ -534,30 +823,66 @@ void CPathEstimator::Update() {
 	}
 
 	// CalculateVertices (not threadsafe)
+	//
+	// only the vertices from and to the updated blocks, each once (those
+	// between two updated blocks would be calculated twice otherwise)
 	{
 		SCOPED_TIMER("CPathEstimator::CalculateVertices");
+
+		std::vector<unsigned int> vertexNbrs;
+		vertexNbrs.reserve(consumedBlocks.size() * PATH_DIRECTIONS);
+
 		for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
-			// copy the next block in line
-			const SingleBlock sb = consumedBlocks[n];
+			const SingleBlock& sb = consumedBlocks[n];
 
-			const unsigned int blockX = sb.blockPos.x;
-			const unsigned int blockZ = sb.blockPos.y;
-			const unsigned int blockN = blockZ * nbrOfBlocksX + blockX;
+			for (unsigned int dir = 0; dir < PATH_DIRECTIONS; dir++) {
+				int2 parentBlock = sb.blockPos;
+				unsigned int parentDir = dir;
 
-			// check for batch boundary
-			const MoveDef* currBlockMD = sb.moveDef;
-			const MoveDef* nextBlockMD = ((n + 1) < consumedBlocks.size())? consumedBlocks[n + 1].moveDef: NULL;
+				// vertices in the other directions are stored with the neighbor
+				if (dir >= PATH_DIRECTION_VERTICES) {
+					parentBlock += PE_DIRECTION_VECTORS[dir];
+					parentDir -= PATH_DIRECTION_VERTICES;
+				}
 
-			CalculateVertices(*currBlockMD, blockX, blockZ);
+				if (parentBlock.x < 0 || parentBlock.x >= int(nbrOfBlocksX) || parentBlock.y < 0 || parentBlock.y >= int(nbrOfBlocksZ))
+					continue;
 
-			// each MapChanged() call adds AT MOST <moveDefs.size()> SingleBlock's
-			// in ascending pathType order per (x, z) PE-block, therefore when the
-			// next SingleBlock's pathType is less or equal to the current we know
-			// that all have been processed (for one PE-block)
-			if (nextBlockMD == NULL || nextBlockMD->pathType <= currBlockMD->pathType) {
-				blockStates.nodeMask[blockN] &= ~PATHOPT_OBSOLETE;
+				vertexNbrs.push_back(
+					sb.moveDef->pathType * blockStates.GetSize() * PATH_DIRECTION_VERTICES +
+					(parentBlock.y * nbrOfBlocksX + parentBlock.x) * PATH_DIRECTION_VERTICES +
+					parentDir
+				);
 			}
 		}
+
+		std::sort(vertexNbrs.begin(), vertexNbrs.end());
+		vertexNbrs.erase(std::unique(vertexNbrs.begin(), vertexNbrs.end()), vertexNbrs.end());
+
+		for (unsigned int n = 0; n < vertexNbrs.size(); ++n) {
+			const unsigned int pathType = vertexNbrs[n] / (blockStates.GetSize() * PATH_DIRECTION_VERTICES);
+			const unsigned int blockN = (vertexNbrs[n] / PATH_DIRECTION_VERTICES) % blockStates.GetSize();
+			const unsigned int dir = vertexNbrs[n] % PATH_DIRECTION_VERTICES;
+
+			CalculateVertex(*moveDefHandler->GetMoveDefByPathType(pathType), blockN % nbrOfBlocksX, blockN / nbrOfBlocksX, dir);
+		}
+	}
+
+	if (!consumedBlocks.empty()) {
+		InvalidateGoalFields();
+	}
+
+	// the coarser level has to reconnect its blocks through these
+	if (coarsePE != NULL) {
+		for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
+			const int2 blockPos = consumedBlocks[n].blockPos;
+
+			// once per batch of MoveDefs
+			if (n > 0 && consumedBlocks[n - 1].blockPos == blockPos)
+				continue;
+
+			coarsePE->MapChanged(blockPos.x * BLOCK_SIZE, blockPos.y * BLOCK_SIZE, (blockPos.x + 1) * BLOCK_SIZE - 1, (blockPos.y + 1) * BLOCK_SIZE - 1);
+		}
 	}
 }
 
@@ -592,7 +917,13 @@ IPath::SearchResult CPathEstimator::GetPath(
 	mStartBlock = startBlock;
 	mStartBlockIdx = startBlock.y * nbrOfBlocksX + startBlock.x;
 
-	const CPathCache::CacheItem* ci = pathCache[synced]->GetCachedPath(startBlock, goalBlock, peDef.sqGoalRadius, moveDef.pathType);
+	// follow a goal-field if one was calculated for this goal
+	if (synced && GetGoalFieldPath(moveDef, peDef, mStartBlockIdx, path)) {
+		searchStats.numGoalFieldPaths += 1;
+		return IPath::Ok;
+	}
+
+	const CPathCache::CacheItem* ci = (pathCache[synced] != NULL)? pathCache[synced]->GetCachedPath(startBlock, goalBlock, peDef.sqGoalRadius, moveDef.pathType): NULL;
 
 	if (ci != NULL) {
 		// use a cached path if we have one
@@ -600,14 +931,38 @@ IPath::SearchResult CPathEstimator::GetPath(
 		return ci->result;
 	}
 
-	// oterhwise search
-	const IPath::SearchResult result = InitSearch(moveDef, peDef, synced);
+	// oterhwise search, long distances along the path of the coarser level
+	IPath::SearchResult result = IPath::Error;
+
+	if (coarsePE != NULL) {
+		const int coarseFactor = coarsePE->BLOCK_SIZE / BLOCK_SIZE;
+		const int coarseDistX = std::abs(startBlock.x / coarseFactor - goalBlock.x / coarseFactor);
+		const int coarseDistZ = std::abs(startBlock.y / coarseFactor - goalBlock.y / coarseFactor);
+
+		if (std::max(coarseDistX, coarseDistZ) > 1) {
+			const spring_time t0 = spring_gettime();
+
+			result = InitCorridorSearch(moveDef, peDef, start, synced);
+
+			searchStats.corridorSearchTime += (spring_gettime() - t0).toMicroSecsi();
+		}
+	}
+
+	if (result != IPath::Ok) {
+		const spring_time t0 = spring_gettime();
+
+		result = InitSearch(moveDef, peDef, synced);
+
+		searchStats.searchTime += (spring_gettime() - t0).toMicroSecsi();
+		searchStats.numTestedBlocks += testedBlocks;
+		searchStats.numSearches += 1;
+	}
 
 	// if search successful, generate new path
 	if (result == IPath::Ok || result == IPath::GoalOutOfRange) {
 		FinishSearch(moveDef, path);
 
-		if (result == IPath::Ok) {
+		if (result == IPath::Ok && pathCache[synced] != NULL) {
 			// add succesful paths to the cache
 			pathCache[synced]->AddPath(&path, result, startBlock, goalBlock, peDef.sqGoalRadius, moveDef.pathType);
 		}
@@ -631,9 +986,49 @@ IPath::SearchResult CPathEstimator::GetPath(
 }
 
 
+/**
+ * Searches the coarser level first and then only the blocks within one
+ * coarse block of its path; Error means no corridor-search was possible
+ */
+IPath::SearchResult CPathEstimator::InitCorridorSearch(const MoveDef& moveDef, const CPathFinderDef& peDef, const float3& start, bool synced) {
+	IPath::Path coarsePath;
+
+	if (coarsePE->GetPath(moveDef, peDef, start, coarsePath, maxBlocksToBeSearched, synced) != IPath::Ok) {
+		searchStats.numCorridorSearches += 1;
+		searchStats.numCorridorFailures += 1;
+		return IPath::Error;
+	}
+
+	const int numCoarseBlocksX = coarsePE->nbrOfBlocksX;
+	const int numCoarseBlocksZ = coarsePE->nbrOfBlocksZ;
+
+	corridorBlocks.assign(numCoarseBlocksX * numCoarseBlocksZ, false);
+	coarsePath.path.push_back(start);
+
+	for (unsigned int n = 0; n < coarsePath.path.size(); n++) {
+		const int blockX = coarsePath.path[n].x / coarsePE->BLOCK_PIXEL_SIZE;
+		const int blockZ = coarsePath.path[n].z / coarsePE->BLOCK_PIXEL_SIZE;
+
+		for (int z = std::max(blockZ - 1, 0); z <= std::min(blockZ + 1, numCoarseBlocksZ - 1); z++) {
+			for (int x = std::max(blockX - 1, 0); x <= std::min(blockX + 1, numCoarseBlocksX - 1); x++) {
+				corridorBlocks[z * numCoarseBlocksX + x] = true;
+			}
+		}
+	}
+
+	const CCorridorSearchConstraint corridorDef(peDef, corridorBlocks, numCoarseBlocksX, coarsePE->BLOCK_SIZE);
+	const IPath::SearchResult result = InitSearch(moveDef, corridorDef, synced);
+
+	searchStats.numCorridorTestedBlocks += testedBlocks;
+	searchStats.numCorridorSearches += 1;
+	searchStats.numCorridorFailures += (result != IPath::Ok);
+	return result;
+}
+
+
 // set up the starting point of the search
 IPath::SearchResult CPathEstimator::InitSearch(const MoveDef& moveDef, const CPathFinderDef& peDef, bool synced) {
-	const int2 square = blockStates.peNodeOffsets[mStartBlockIdx][moveDef.pathType];
+	const int2 square = parent->blockStates.peNodeOffsets[mStartBlockIdx][moveDef.pathType];
 	const bool isStartGoal = peDef.IsGoal(square.x, square.y);
 
 	// although our starting square may be inside the goal radius, the starting coordinate may be outside.
@@ -697,8 +1092,8 @@ IPath::SearchResult CPathEstimator::DoSearch(const MoveDef& moveDef, const CPath
 			continue;
 
 		// no, check if the goal is already reached
-		const unsigned int xBSquare = blockStates.peNodeOffsets[ob->nodeNum][moveDef.pathType].x;
-		const unsigned int zBSquare = blockStates.peNodeOffsets[ob->nodeNum][moveDef.pathType].y;
+		const unsigned int xBSquare = parent->blockStates.peNodeOffsets[ob->nodeNum][moveDef.pathType].x;
+		const unsigned int zBSquare = parent->blockStates.peNodeOffsets[ob->nodeNum][moveDef.pathType].y;
 		const unsigned int xGSquare = ob->nodePos.x * BLOCK_SIZE + mGoalSqrOffset.x;
 		const unsigned int zGSquare = ob->nodePos.y * BLOCK_SIZE + mGoalSqrOffset.y;
 
@@ -771,17 +1166,19 @@ void CPathEstimator::TestBlock(
 		return;
 	}
 
-	if (vertexIdx < 0 || vertexIdx >= vertexCosts.size())
+	const std::vector<float>& blockVertexCosts = parent->vertexCosts;
+
+	if (vertexIdx < 0 || vertexIdx >= blockVertexCosts.size())
 		return;
 
-	if (vertexCosts[vertexIdx] >= PATHCOST_INFINITY)
+	if (blockVertexCosts[vertexIdx] >= PATHCOST_INFINITY)
 		return;
 
 	// check if the block is unavailable
 	if (blockStates.nodeMask[blockIdx] & (PATHOPT_FORBIDDEN | PATHOPT_BLOCKED | PATHOPT_CLOSED))
 		return;
 
-	const int2 square = blockStates.peNodeOffsets[blockIdx][moveDef.pathType];
+	const int2 square = parent->blockStates.peNodeOffsets[blockIdx][moveDef.pathType];
 
 	// check if the block is blocked or out of constraints
 	if (!peDef.WithinConstraints(square.x, square.y)) {
@@ -791,9 +1188,10 @@ void CPathEstimator::TestBlock(
 	}
 
 	// evaluate this node (NOTE the max-resolution indexing for {flow,extra}Cost)
-	const float flowCost = (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, PathDir2PathOpt(pathDir));
-	const float extraCost = blockStates.GetNodeExtraCost(square.x, square.y, synced);
-	const float nodeCost = vertexCosts[vertexIdx] + flowCost + extraCost;
+	// vertex-costs of coarser levels only depend on the precalculated data
+	const float flowCost = (!vertexSearches)? (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, PathDir2PathOpt(pathDir)): 0.0f;
+	const float extraCost = (!vertexSearches)? parent->blockStates.GetNodeExtraCost(square.x, square.y, synced): 0.0f;
+	const float nodeCost = blockVertexCosts[vertexIdx] + flowCost + extraCost;
 
 	const float gCost = parentOpenBlock.gCost + nodeCost;
 	const float hCost = peDef.Heuristic(square.x, square.y);
@@ -848,7 +1246,7 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, IPath::Path& foundPath
 		const unsigned int blockIdx = block.y * nbrOfBlocksX + block.x;
 
 		// use offset defined by the block
-		const int2 bsquare = blockStates.peNodeOffsets[blockIdx][moveDef.pathType];
+		const int2 bsquare = parent->blockStates.peNodeOffsets[blockIdx][moveDef.pathType];
 		const float3& pos = SquareToFloat3(bsquare.x, bsquare.y);
 
 		foundPath.path.push_back(pos);
@@ -866,6 +1264,258 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, IPath::Path& foundPath
 }
 
 
+bool CPathEstimator::GoalFieldKey::operator < (const GoalFieldKey& k) const {
+	if (pathType != k.pathType)
+		return (pathType < k.pathType);
+	if (goalBlockIdx != k.goalBlockIdx)
+		return (goalBlockIdx < k.goalBlockIdx);
+
+	return (sqGoalRadius < k.sqGoalRadius);
+}
+
+CPathEstimator::GoalFieldKey CPathEstimator::GetGoalFieldKey(const MoveDef& moveDef, const CPathFinderDef& peDef) const {
+	GoalFieldKey key;
+	key.pathType = moveDef.pathType;
+	key.goalBlockIdx = (peDef.goalSquareZ / BLOCK_SIZE) * nbrOfBlocksX + (peDef.goalSquareX / BLOCK_SIZE);
+	key.sqGoalRadius = peDef.sqGoalRadius;
+	return key;
+}
+
+
+bool CPathEstimator::GoalField::Covers(unsigned int blockIdx) const {
+	if (blockCosts.empty() || (calcFrame + GOAL_FIELD_LIFETIME) < gs->frameNum)
+		return false;
+
+	return (blockCosts[blockIdx] < PATHCOST_INFINITY);
+}
+
+
+void CPathEstimator::AddGoalFieldRequest(const MoveDef& moveDef, const CPathFinderDef& peDef, const float3& startPos) {
+	assert(parent == this);
+
+	GoalField& field = goalFields[GetGoalFieldKey(moveDef, peDef)];
+
+	if (field.moveDef == NULL) {
+		field.moveDef = &moveDef;
+		field.goal = peDef.goal;
+	}
+
+	field.numRequests += 1;
+	field.lastRequestFrame = gs->frameNum;
+
+	float3 start = startPos;
+	start.ClampInBounds();
+
+	const unsigned int startBlockX = std::min(unsigned(start.x / BLOCK_PIXEL_SIZE), nbrOfBlocksX - 1);
+	const unsigned int startBlockZ = std::min(unsigned(start.z / BLOCK_PIXEL_SIZE), nbrOfBlocksZ - 1);
+	const unsigned int startBlockIdx = startBlockZ * nbrOfBlocksX + startBlockX;
+
+	if (field.Covers(startBlockIdx))
+		return;
+	if (std::find(field.startBlocks.begin(), field.startBlocks.end(), startBlockIdx) != field.startBlocks.end())
+		return;
+
+	field.startBlocks.push_back(startBlockIdx);
+}
+
+void CPathEstimator::UpdateGoalFields() {
+	assert(parent == this);
+
+	if (goalFieldCalcFrame != gs->frameNum) {
+		goalFieldCalcFrame = gs->frameNum;
+		numGoalFieldCalcsInFrame = 0;
+	}
+
+	for (std::map<GoalFieldKey, GoalField>::iterator it = goalFields.begin(); it != goalFields.end(); ++it) {
+		GoalField& field = it->second;
+
+		if (numGoalFieldCalcsInFrame >= GOAL_FIELD_MAX_CALCS_PER_FRAME)
+			break;
+
+		if (field.numRequests < GOAL_FIELD_MIN_REQUESTS)
+			continue;
+		if (field.startBlocks.empty())
+			continue;
+		// starts it does not cover meanwhile use regular searches
+		if (field.calcFrame >= 0 && gs->frameNum < (field.calcFrame + GOAL_FIELD_CALC_INTERVAL))
+			continue;
+
+		SCOPED_TIMER("CPathEstimator::CalcGoalField");
+
+		CalcGoalField(it->first, field);
+
+		field.calcFrame = gs->frameNum;
+		field.startBlocks.clear();
+
+		numGoalFieldCalcsInFrame += 1;
+	}
+}
+
+void CPathEstimator::InvalidateGoalFields() {
+	for (std::map<GoalFieldKey, GoalField>::iterator it = goalFields.begin(); it != goalFields.end(); ++it) {
+		it->second.numRequests = 0;
+		it->second.startBlocks.clear();
+		it->second.blockCosts.clear();
+		it->second.nextBlocks.clear();
+	}
+}
+
+
+/**
+ * Dijkstra-search backwards from all goal blocks, which leaves the cheapest
+ * way to the goal from every block it settles; it stops once the requested
+ * start blocks and those up to GOAL_FIELD_COST_MARGIN times as expensive
+ * are settled (search constraints are ignored, they only save CPU)
+ */
+void CPathEstimator::CalcGoalField(const GoalFieldKey& key, GoalField& field) {
+	typedef std::pair<float, unsigned int> OpenBlock;
+
+	const MoveDef& moveDef = *field.moveDef;
+
+	CPathFinderDef peDef(field.goal, 0.0f, 0.0f);
+	peDef.sqGoalRadius = key.sqGoalRadius;
+
+	const unsigned int numBlocks = nbrOfBlocksX * nbrOfBlocksZ;
+	const int2 goalSqrOffset = peDef.GoalSquareOffset(BLOCK_SIZE);
+
+	std::vector<float>& blockCosts = field.blockCosts;
+	std::vector<unsigned int>& nextBlocks = field.nextBlocks;
+	std::vector<float> openCosts(numBlocks, PATHCOST_INFINITY);
+	std::vector<bool> isStartBlock(numBlocks, false);
+	std::priority_queue<OpenBlock, std::vector<OpenBlock>, std::greater<OpenBlock> > openBlocks;
+
+	blockCosts.assign(numBlocks, PATHCOST_INFINITY);
+	nextBlocks.assign(numBlocks, 0);
+
+	unsigned int numOpenStarts = 0;
+	float maxCost = PATHCOST_INFINITY;
+
+	for (unsigned int n = 0; n < field.startBlocks.size(); n++) {
+		numOpenStarts += (!isStartBlock[field.startBlocks[n]]);
+		isStartBlock[field.startBlocks[n]] = true;
+	}
+
+	// start from every block a search would stop at
+	for (unsigned int blockZ = 0; blockZ < nbrOfBlocksZ; blockZ++) {
+		for (unsigned int blockX = 0; blockX < nbrOfBlocksX; blockX++) {
+			const unsigned int blockIdx = blockZ * nbrOfBlocksX + blockX;
+			const int2 square = blockStates.peNodeOffsets[blockIdx][moveDef.pathType];
+
+			if (!peDef.IsGoal(square.x, square.y) && !peDef.IsGoal(blockX * BLOCK_SIZE + goalSqrOffset.x, blockZ * BLOCK_SIZE + goalSqrOffset.y))
+				continue;
+
+			openCosts[blockIdx] = 0.0f;
+			nextBlocks[blockIdx] = blockIdx;
+			openBlocks.push(OpenBlock(0.0f, blockIdx));
+		}
+	}
+
+	while (!openBlocks.empty()) {
+		const OpenBlock ob = openBlocks.top();
+		openBlocks.pop();
+
+		// already reached cheaper
+		if (ob.first > openCosts[ob.second])
+			continue;
+		if (blockCosts[ob.second] < PATHCOST_INFINITY)
+			continue;
+		// all requested starts (and the margin around them) are settled
+		if (ob.first > maxCost)
+			break;
+
+		blockCosts[ob.second] = ob.first;
+		searchStats.numGoalFieldBlocks += 1;
+
+		if (isStartBlock[ob.second] && (--numOpenStarts) == 0) {
+			maxCost = ob.first * GOAL_FIELD_COST_MARGIN;
+		}
+
+		const int2 block = int2(ob.second % nbrOfBlocksX, ob.second / nbrOfBlocksX);
+		const int2 square = blockStates.peNodeOffsets[ob.second][moveDef.pathType];
+
+		// extra-costs are always synced here, fields only serve synced requests
+		const float extraCost = blockStates.GetNodeExtraCost(square.x, square.y, true);
+
+		for (unsigned int dir = 0; dir < PATH_DIRECTIONS; dir++) {
+			// the neighbour in <dir> moves to this block in the opposite direction
+			const unsigned int pathDir = (dir + PATH_DIRECTION_VERTICES) % PATH_DIRECTIONS;
+			const int2 nbrBlock = block + PE_DIRECTION_VECTORS[dir];
+
+			if (nbrBlock.x < 0 || nbrBlock.x >= nbrOfBlocksX || nbrBlock.y < 0 || nbrBlock.y >= nbrOfBlocksZ)
+				continue;
+
+			const unsigned int nbrBlockIdx = nbrBlock.y * nbrOfBlocksX + nbrBlock.x;
+			const int vertexIdx =
+				moveDef.pathType * blockStates.GetSize() * PATH_DIRECTION_VERTICES +
+				nbrBlockIdx * PATH_DIRECTION_VERTICES +
+				GetBlockVertexOffset(pathDir, nbrOfBlocksX);
+
+			if (vertexIdx < 0 || vertexIdx >= vertexCosts.size())
+				continue;
+			if (vertexCosts[vertexIdx] >= PATHCOST_INFINITY)
+				continue;
+
+			// same costs as TestBlock uses moving from the neighbour, except
+			// that (Lua-set) negative extra-costs can not make it negative
+			const float flowCost = (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, PathDir2PathOpt(pathDir));
+			const float nbrCost = ob.first + std::max(0.0f, vertexCosts[vertexIdx] + flowCost + extraCost);
+
+			if (nbrCost >= openCosts[nbrBlockIdx])
+				continue;
+
+			openCosts[nbrBlockIdx] = nbrCost;
+			nextBlocks[nbrBlockIdx] = ob.second;
+			openBlocks.push(OpenBlock(nbrCost, nbrBlockIdx));
+		}
+	}
+
+	searchStats.numGoalFieldCalcs += 1;
+}
+
+/**
+ * Creates the path from <startBlockIdx> to the goal the way FinishSearch
+ * would, if the parent has a current goal-field reaching the start-block
+ */
+bool CPathEstimator::GetGoalFieldPath(const MoveDef& moveDef, const CPathFinderDef& peDef, unsigned int startBlockIdx, IPath::Path& path) const {
+	if (parent->goalFields.empty())
+		return false;
+
+	const std::map<GoalFieldKey, GoalField>::const_iterator it = parent->goalFields.find(GetGoalFieldKey(moveDef, peDef));
+
+	if (it == parent->goalFields.end())
+		return false;
+
+	const GoalField& field = it->second;
+
+	// let a regular search handle starts the field does not reach
+	// (cut off from the goal or beyond where it stopped), and those
+	// inside the goal
+	if (!field.Covers(startBlockIdx))
+		return false;
+	if (field.blockCosts[startBlockIdx] <= 0.0f)
+		return false;
+
+	std::vector<unsigned int> blocks;
+
+	for (unsigned int blockIdx = field.nextBlocks[startBlockIdx]; ; blockIdx = field.nextBlocks[blockIdx]) {
+		blocks.push_back(blockIdx);
+
+		if (field.nextBlocks[blockIdx] == blockIdx)
+			break;
+	}
+
+	// goal first, excluding the start-block
+	for (std::vector<unsigned int>::const_reverse_iterator bit = blocks.rbegin(); bit != blocks.rend(); ++bit) {
+		const int2 bsquare = parent->blockStates.peNodeOffsets[*bit][moveDef.pathType];
+		path.path.push_back(SquareToFloat3(bsquare.x, bsquare.y));
+	}
+
+	path.pathGoal = path.path.front();
+	path.pathCost = field.blockCosts[startBlockIdx];
+	return true;
+}
+
+
 /**
  * Clean lists from last search
  */
@@ -883,7 +1533,6 @@ void CPathEstimator::ResetSearch() {
 
 /**
  * Try to read offset and vertices data from file, return false on failure
- * TODO: Read-error-check.
  */
 bool CPathEstimator::ReadFile(const std::string& cacheFileName, const std::string& map)
 {
@@ -893,61 +1542,71 @@ bool CPathEstimator::ReadFile(const std::string& cacheFileName, const std::strin
 	sprintf(hashString, "%u", hash);
 	LOG("[PathEstimator::%s] hash=%s\n", __FUNCTION__, hashString);
 
-	std::string filename = GetPathCacheDir() + map + hashString + "." + cacheFileName + ".zip";
+	const std::string filename = GetPathCacheDir() + map + hashString + "." + cacheFileName + ".dat";
+
 	if (!FileSystem::FileExists(filename))
 		return false;
-	// open file for reading from a suitable location (where the file exists)
-	IArchive* pfile = archiveLoader.OpenArchive(dataDirsAccess.LocateFile(filename), "sdz");
 
-	if (!pfile || !pfile->IsOpen()) {
-		delete pfile;
+	// map the file rather than reading it, a recently used
+	// cache is then copied straight out of the page-cache
+	boost::scoped_ptr<CMappedFileView> view(CMappedFileView::Open(dataDirsAccess.LocateFile(filename)));
+
+	if (view == NULL || view->GetSize() < sizeof(PathCacheHeader))
 		return false;
-	}
 
 	char calcMsg[512];
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	std::auto_ptr<IArchive> auto_pfile(pfile);
-	IArchive& file(*pfile);
+	PathCacheHeader header;
+	std::memcpy(&header, view->GetData(), sizeof(header));
 
-	const unsigned fid = file.FindFile("pathinfo");
+	const PathCacheLayout layout(blockStates.GetSize(), moveDefHandler->GetNumMoveDefs(), vertexCosts.size());
 
-	if (fid < file.NumFiles()) {
-		pathChecksum = file.GetCrc32(fid);
+	if (!std::equal(header.magic, header.magic + sizeof(header.magic), CACHE_MAGIC) || header.version != CACHE_VERSION || header.hash != hash)
+		return false;
+	if (header.blockSize != BLOCK_SIZE || header.numBlocks != blockStates.GetSize())
+		return false;
+	if (header.numMoveDefs != moveDefHandler->GetNumMoveDefs() || header.numVertexCosts != vertexCosts.size())
+		return false;
+	if (header.dataSize != (view->GetSize() - sizeof(header)))
+		return false;
 
-		std::vector<boost::uint8_t> buffer;
-		file.GetFile(fid, buffer);
+	const boost::uint8_t* data = view->GetData() + sizeof(header);
+	std::vector<boost::uint8_t> buffer;
 
-		if (buffer.size() < 4)
-			return false;
+	if (header.compressed != 0) {
+		uLongf dataSize = layout.dataSize;
+		buffer.resize(layout.dataSize);
 
-		unsigned filehash = *((unsigned*)&buffer[0]);
-		if (filehash != hash)
+		if (uncompress(&buffer[0], &dataSize, data, header.dataSize) != Z_OK || dataSize != layout.dataSize)
 			return false;
 
-		unsigned pos = sizeof(unsigned);
-
-		// Read block-center-offset data.
-		const unsigned blockSize = moveDefHandler->GetNumMoveDefs() * sizeof(int2);
-		if (buffer.size() < pos + blockSize * blockStates.GetSize())
+		data = &buffer[0];
+	} else {
+		if (header.dataSize != layout.dataSize)
 			return false;
+	}
 
-		for (int blocknr = 0; blocknr < blockStates.GetSize(); blocknr++) {
-			std::memcpy(&blockStates.peNodeOffsets[blocknr][0], &buffer[pos], blockSize);
-			pos += blockSize;
-		}
+	const boost::uint32_t checksum = layout.GetChecksum(hash, data);
 
-		// Read vertices data.
-		if (buffer.size() < pos + vertexCosts.size() * sizeof(float))
-			return false;
-		std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+	if (checksum != header.checksum) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] ignoring corrupt cache %s", __FUNCTION__, filename.c_str());
+		return false;
+	}
 
-		// File read successful.
-		return true;
+	// Read block-center-offset data.
+	const size_t blockSize = moveDefHandler->GetNumMoveDefs() * sizeof(int2);
+
+	for (int blocknr = 0; blocknr < blockStates.GetSize(); blocknr++) {
+		std::memcpy(&blockStates.peNodeOffsets[blocknr][0], data + blocknr * blockSize, blockSize);
 	}
 
-	return false;
+	// Read vertices data.
+	std::memcpy(&vertexCosts[0], data + layout.costsOffset, vertexCosts.size() * sizeof(float));
+
+	pathChecksum = checksum;
+	return true;
 }
 
 
@@ -956,52 +1615,91 @@ bool CPathEstimator::ReadFile(const std::string& cacheFileName, const std::strin
  */
 void CPathEstimator::WriteFile(const std::string& cacheFileName, const std::string& map)
 {
+	const unsigned int hash = Hash();
+	const PathCacheLayout layout(blockStates.GetSize(), moveDefHandler->GetNumMoveDefs(), vertexCosts.size());
+
+	// the same data as read from a cache
+	std::vector<boost::uint8_t> data(layout.dataSize, 0);
+
+	// Write block-center-offsets.
+	const size_t blockSize = moveDefHandler->GetNumMoveDefs() * sizeof(int2);
+
+	for (int blocknr = 0; blocknr < blockStates.GetSize(); blocknr++) {
+		std::memcpy(&data[blocknr * blockSize], &blockStates.peNodeOffsets[blocknr][0], blockSize);
+	}
+
+	// Write vertices.
+	std::memcpy(&data[layout.costsOffset], &vertexCosts[0], vertexCosts.size() * sizeof(float));
+
+	// available even if the cache can not be written
+	pathChecksum = layout.GetChecksum(hash, &data[0]);
+
 	// We need this directory to exist
 	if (!FileSystem::CreateDirectory(GetPathCacheDir()))
 		return;
 
-	const unsigned int hash = Hash();
 	char hashString[64] = {0};
 
 	sprintf(hashString, "%u", hash);
 	LOG("[PathEstimator::%s] hash=%s\n", __FUNCTION__, hashString);
 
-	const std::string filename = GetPathCacheDir() + map + hashString + "." + cacheFileName + ".zip";
+	const std::string filename = GetPathCacheDir() + map + hashString + "." + cacheFileName + ".dat";
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(filename, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
+	PathCacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::copy(CACHE_MAGIC, CACHE_MAGIC + sizeof(CACHE_MAGIC), header.magic);
 
-	if (file == NULL)
-		return;
+	header.version = CACHE_VERSION;
+	header.hash = hash;
+	header.checksum = pathChecksum;
+	header.blockSize = BLOCK_SIZE;
+	header.numBlocks = blockStates.GetSize();
+	header.numMoveDefs = moveDefHandler->GetNumMoveDefs();
+	header.numVertexCosts = vertexCosts.size();
+	header.dataSize = data.size();
 
-	zipOpenNewFileInZip(file, "pathinfo", NULL, NULL, 0, NULL, 0, NULL, Z_DEFLATED, Z_BEST_COMPRESSION);
+	if (configHandler->GetBool("CompressPathCache")) {
+		std::vector<boost::uint8_t> compressed(compressBound(data.size()));
+		uLongf compressedSize = compressed.size();
 
-	// Write hash. (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (void*) &hash, 4);
+		if (compress2(&compressed[0], &compressedSize, &data[0], data.size(), Z_BEST_SPEED) == Z_OK) {
+			compressed.resize(compressedSize);
+			data.swap(compressed);
 
-	// Write block-center-offsets.
-	for (int blocknr = 0; blocknr < blockStates.GetSize(); blocknr++)
-		zipWriteInFileInZip(file, (void*) &blockStates.peNodeOffsets[blocknr][0], moveDefHandler->GetNumMoveDefs() * sizeof(int2));
-
-	// Write vertices.
-	zipWriteInFileInZip(file, &vertexCosts[0], vertexCosts.size() * sizeof(float));
+			header.compressed = 1;
+			header.dataSize = data.size();
+		}
+	}
 
-	zipCloseFileInZip(file);
-	zipClose(file, NULL);
+	// open file for writing in a suitable location; the cache is written
+	// next to it and renamed into place afterwards since the old one may
+	// still be mapped by ReadFile (of this or another process)
+	const std::string filePath = dataDirsAccess.LocateFile(filename, FileQueryFlags::WRITE);
+	const std::string tempPath = filePath + ".tmp";
 
+	std::ofstream ofs(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
 
-	// get the CRC over the written path data
-	IArchive* pfile = archiveLoader.OpenArchive(dataDirsAccess.LocateFile(filename), "sdz");
+	if (ofs.is_open()) {
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(&data[0]), data.size());
+		ofs.close();
+	}
 
-	if (pfile == NULL)
+	if (!ofs) {
+		LOG_L(L_ERROR, "[PathEstimator::%s] failed to write to \"%s\"", __FUNCTION__, tempPath.c_str());
+		FileSystem::DeleteFile(tempPath);
 		return;
-
-	if (pfile->IsOpen()) {
-		assert(pfile->FindFile("pathinfo") < pfile->NumFiles());
-		pathChecksum = pfile->GetCrc32(pfile->FindFile("pathinfo"));
 	}
 
-	delete pfile;
+#ifdef _WIN32
+	// rename() does not replace existing files here
+	FileSystem::DeleteFile(filePath);
+#endif
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+		LOG_L(L_ERROR, "[PathEstimator::%s] failed to rename \"%s\" to \"%s\"", __FUNCTION__, tempPath.c_str(), filePath.c_str());
+		FileSystem::DeleteFile(tempPath);
+	}
 }
 
 
@@ -3,9 +3,12 @@
 #ifndef PATHESTIMATOR_H
 #define PATHESTIMATOR_H
 
+#include <deque>
 #include <string>
 #include <list>
+#include <map>
 #include <queue>
+#include <vector>
 
 #include "IPath.h"
 #include "PathConstants.h"
@@ -41,8 +44,21 @@ public:
 	 *   The name given are added to the end of the filename, after the
 	 *   name of the corresponding map.
 	 *   Ex. PE-name "pe" + Mapname "Desert" => "Desert.pe"
+	 *
+	 * @param basePE
+	 *   If non-NULL, vertex-costs are calculated by searching this (finer)
+	 *   estimator instead of with the pathfinder; see AddCoarseLevel.
+	 */
+	CPathEstimator(CPathFinder*, unsigned int BSIZE, const std::string& cacheFileName, const std::string& mapFileName, const CPathEstimator* basePE = NULL);
+	/**
+	 * Creates a helper that searches with the precalculated data and the
+	 * extra-costs of <parent>, so several helpers can search concurrently
+	 * (but not while the parent is updated). Helpers do not cache paths.
+	 * Helpers for <vertexSearches> of a coarser level ignore extra- and
+	 * flow-costs, like the pathfinder searches of the finest level, so
+	 * only synced precalculated data goes into the coarse vertex-costs.
 	 */
-	CPathEstimator(CPathFinder*, unsigned int BSIZE, const std::string& cacheFileName, const std::string& mapFileName);
+	CPathEstimator(const CPathEstimator* parent, bool vertexSearches = false);
 	~CPathEstimator();
 
 	void* operator new(size_t size);
@@ -90,21 +106,68 @@ public:
 	 * This is called whenever the ground structure of the map changes
 	 * (for example on explosions and new buildings).
 	 * The affected rectangular area is defined by (x1, z1)-(x2, z2).
-	 * The estimator itself will decided if an update of the area is needed.
+	 * The blocks containing it are queued for an update, which recalculates
+	 * their offsets and only the vertices between them and their neighbors.
 	 */
 	void MapChanged(unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2);
 
+	/**
+	 * Moves the queued blocks along <path> (one of this estimator's) ahead
+	 * of the other queued blocks, so paths in use are repaired first.
+	 */
+	void PrioritizeBlocks(const IPath::Path& path);
+
+	/// number of blocks queued for an update
+	unsigned int GetNumQueuedBlocks() const { return numQueuedBlocks; }
+	/// number of those moved ahead by PrioritizeBlocks
+	unsigned int GetNumPriorityBlocks() const { return numPriorityBlocks; }
+
 
 	/**
 	 * called every frame
 	 */
 	void Update();
 
+	/**
+	 * Registers a synced request from <startPos> for the goal of <peDef>.
+	 * Once enough were made for the same goal-block, goal-radius and
+	 * MoveDef within a short time, UpdateGoalFields calculates the cost
+	 * to that goal of the blocks around it in one pass (a "goal-field"),
+	 * and synced searches for it starting there just follow the field.
+	 * Must not be called while helpers search.
+	 */
+	void AddGoalFieldRequest(const MoveDef& moveDef, const CPathFinderDef& peDef, const float3& startPos);
+	/**
+	 * (Re)calculates the goal-fields which have requests from blocks they
+	 * do not cover, at most GOAL_FIELD_MAX_CALCS_PER_FRAME per frame and
+	 * not more often than every GOAL_FIELD_CALC_INTERVAL frames each.
+	 */
+	void UpdateGoalFields();
+
+	/**
+	 * Drops all goal-fields, called when the costs they were calculated
+	 * from change. Their requests are forgotten as well, so only goals
+	 * requested again are recalculated.
+	 */
+	void InvalidateGoalFields();
+
+	/**
+	 * Stacks a coarser level onto this estimator, with blocks <factor> times
+	 * as large whose vertices are connected through this one's blocks (like
+	 * the clusters of HPA*). Long searches then first search the coarsest
+	 * level and only the blocks along its path on every finer one.
+	 * Terrain changes reach the coarser level once this one has updated.
+	 * @return the new estimator (owned by this one), NULL if the map is not
+	 *   divisible into at least 4x4 of its blocks
+	 */
+	CPathEstimator* AddCoarseLevel(unsigned int factor, const std::string& cacheFileName, const std::string& mapFileName);
+	CPathEstimator* GetCoarseEstimator() const { return coarsePE; }
+
 	/**
 	 * Returns a checksum that can be used to check if every player has the same
-	 * path data.
+	 * path data (including that of the coarser levels).
 	 */
-	boost::uint32_t GetPathChecksum() const { return pathChecksum; }
+	boost::uint32_t GetPathChecksum() const { return (pathChecksum + ((coarsePE != NULL)? coarsePE->GetPathChecksum(): 0)); }
 
 	unsigned int GetBlockSize() const { return BLOCK_SIZE; }
 	unsigned int GetNumBlocksX() const { return nbrOfBlocksX; }
@@ -128,11 +191,21 @@ private:
 	void CalculateVertex(const MoveDef&, unsigned int, unsigned int, unsigned int, unsigned int threadNum = 0);
 
 	IPath::SearchResult InitSearch(const MoveDef&, const CPathFinderDef&, bool);
+	IPath::SearchResult InitCorridorSearch(const MoveDef&, const CPathFinderDef&, const float3& start, bool);
 	IPath::SearchResult DoSearch(const MoveDef&, const CPathFinderDef&, bool);
 	void TestBlock(const MoveDef&, const CPathFinderDef&, PathNode&, unsigned int pathDir, bool synced);
 	void FinishSearch(const MoveDef& moveDef, IPath::Path& path);
 	void ResetSearch();
 
+	struct GoalFieldKey;
+	struct GoalField;
+
+	GoalFieldKey GetGoalFieldKey(const MoveDef& moveDef, const CPathFinderDef& peDef) const;
+	void CalcGoalField(const GoalFieldKey& key, GoalField& field);
+
+	void LogSearchStats() const;
+	bool GetGoalFieldPath(const MoveDef& moveDef, const CPathFinderDef& peDef, unsigned int startBlockIdx, IPath::Path& path) const;
+
 	bool ReadFile(const std::string& cacheFileName, const std::string& map);
 	void WriteFile(const std::string& cacheFileName, const std::string& map);
 	unsigned int Hash() const;
@@ -146,6 +219,31 @@ private:
 		const MoveDef* moveDef;
 	};
 
+	struct GoalFieldKey {
+		bool operator < (const GoalFieldKey& k) const;
+
+		int pathType;
+		unsigned int goalBlockIdx;
+		float sqGoalRadius;
+	};
+
+	struct GoalField {
+		GoalField(): numRequests(0), lastRequestFrame(0), calcFrame(-1), moveDef(NULL) {}
+
+		bool Covers(unsigned int blockIdx) const;
+
+		unsigned int numRequests;
+		int lastRequestFrame;
+		int calcFrame;                          /// -1 if never calculated
+
+		const MoveDef* moveDef;
+		float3 goal;                            /// of the first request, it serves all others as approximation
+
+		std::vector<unsigned int> startBlocks;  /// requested starts not covered by the field yet
+		std::vector<float> blockCosts;          /// cost from each block to the goal, infinite if not settled
+		std::vector<unsigned int> nextBlocks;   /// next block on the way to the goal from each settled block
+	};
+
 	const unsigned int BLOCK_SIZE;
 	const unsigned int BLOCK_PIXEL_SIZE;
 	const unsigned int BLOCKS_TO_UPDATE;
@@ -169,16 +267,25 @@ private:
 	CPathFinder* pathFinder;
 	CPathCache* pathCache[2];                   /// [0] = !synced, [1] = synced
 
+	const CPathEstimator* parent;               /// owner of the block-data searched, this unless a helper
+	const CPathEstimator* basePE;               /// finer level the vertex-costs are searched with, if any
+	CPathEstimator* coarsePE;                   /// coarser level guiding long searches, if any
+	bool vertexSearches;                        /// helper searching the vertex-costs of a coarser level
+
 	PathNodeBuffer openBlockBuffer;
 	PathNodeStateBuffer blockStates;
 	PathPriorityQueue openBlocks;               /// The priority-queue used to select next block to be searched.
 
 	std::vector<CPathFinder*> pathFinders;
+	std::vector<CPathEstimator*> basePEs;       /// per-thread helpers of basePE
+	std::vector<bool> corridorBlocks;           /// coarse blocks the current search may enter
 	std::vector<boost::thread*> threads;
 
 	std::vector<float> vertexCosts;
 	std::list<unsigned int> dirtyBlocks;        /// List of blocks changed in last search.
 	std::list<SingleBlock> updatedBlocks;       /// Blocks that may need an update due to map changes.
+	std::deque<unsigned int> priorityBlocks;    /// Queued blocks on paths in use, updated before the others.
+	std::map<GoalFieldKey, GoalField> goalFields;
 
 	int2 mStartBlock;
 	int2 mGoalBlock;
@@ -188,6 +295,33 @@ private:
 	float mGoalHeuristic;
 
 	int blockUpdatePenalty;
+	int mapChangeMargin;                        /// in squares, see MapChanged
+	unsigned int numQueuedBlocks;
+	unsigned int numPriorityBlocks;             /// queued blocks with PATHOPT_PRIORITY set
+
+	int goalFieldCalcFrame;
+	unsigned int numGoalFieldCalcsInFrame;
+
+	/// logged (at debug-level) by the estimator, helpers add theirs to it
+	struct SearchStats {
+		SearchStats();
+		SearchStats& operator += (const SearchStats& s);
+
+		unsigned int numSearches;               /// regular searches, including those after failed corridor-searches
+		unsigned int numCorridorSearches;
+		unsigned int numCorridorFailures;
+		unsigned int numGoalFieldCalcs;
+		unsigned int numGoalFieldPaths;
+
+		boost::uint64_t numTestedBlocks;
+		boost::uint64_t numCorridorTestedBlocks;
+		boost::uint64_t numGoalFieldBlocks;
+
+		boost::uint64_t searchTime;             /// in microseconds
+		boost::uint64_t corridorSearchTime;     /// in microseconds, including the coarser search
+	};
+
+	SearchStats searchStats;
 };
 
 #endif
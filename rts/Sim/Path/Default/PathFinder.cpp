@@ -31,7 +31,7 @@ static  float PF_DIRECTION_COSTS[PATH_DIRECTIONS << 1];
 
 
 
-CPathFinder::CPathFinder()
+CPathFinder::CPathFinder(const CPathFinder* parentPF)
 	: start(ZeroVector)
 	, startxSqr(0)
 	, startzSqr(0)
@@ -44,6 +44,7 @@ CPathFinder::CPathFinder()
 	, maxOpenNodes(0)
 	, testedNodes(0)
 	, squareStates(int2(gs->mapx, gs->mapy), int2(gs->mapx, gs->mapy))
+	, parent((parentPF != NULL)? parentPF: this)
 {
 }
 
@@ -461,7 +462,7 @@ bool CPathFinder::TestSquare(
 	const float flowCost = (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, pathOptDir);
 
 	const float dirMoveCost = (1.0f + heatCost + flowCost) * PF_DIRECTION_COSTS[pathOptDir];
-	const float extraCost = squareStates.GetNodeExtraCost(square.x, square.y, synced);
+	const float extraCost = parent->squareStates.GetNodeExtraCost(square.x, square.y, synced);
 	const float nodeCost = (dirMoveCost / squareSpeedMod) + extraCost;
 
 	const float gCost = parentSquare->gCost + nodeCost;      // g
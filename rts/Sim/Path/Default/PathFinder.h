@@ -18,7 +18,13 @@ class CPathFinderDef;
 
 class CPathFinder {
 public:
-	CPathFinder();
+	/**
+	 * @param parent
+	 *   If non-NULL, the new instance reads the node extra-costs of
+	 *   <parent> instead of keeping its own, so it can search on behalf
+	 *   of (and concurrently with other helpers of) the same parent.
+	 */
+	CPathFinder(const CPathFinder* parent = NULL);
 	~CPathFinder();
 
 	void* operator new(size_t size);
@@ -146,6 +152,9 @@ private:
 	PathPriorityQueue openSquares;
 
 	std::vector<unsigned int> dirtySquares;         ///< Squares tested by search.
+
+	/// instance holding the extra-costs, this unless created as a helper
+	const CPathFinder* parent;
 };
 
 #endif // PATH_FINDER_H
@@ -110,3 +110,17 @@ CRectangularSearchConstraint::CRectangularSearchConstraint(
 	childBlockRect.z2 = childBlockZ * blockSize + blockSize;
 }
 
+
+
+CCorridorSearchConstraint::CCorridorSearchConstraint(
+	const CPathFinderDef& def,
+	const std::vector<bool>& blocks,
+	unsigned int blocksX,
+	unsigned int blockSqrs
+): CPathFinderDef(def)
+	, parentDef(def)
+	, corridorBlocks(blocks)
+	, numBlocksX(blocksX)
+	, blockSize(blockSqrs)
+{
+}
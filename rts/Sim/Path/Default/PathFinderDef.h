@@ -3,6 +3,8 @@
 #ifndef PATHFINDERDEF_HDR
 #define PATHFINDERDEF_HDR
 
+#include <vector>
+
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "System/float3.h"
 #include "System/type2.h"
@@ -86,5 +88,31 @@ private:
 	SRectangle  childBlockRect;
 };
 
+
+
+class CCorridorSearchConstraint: public CPathFinderDef {
+public:
+	// note: <blocks> flags the blocks (of <blockSqrs> squares) a search may
+	// enter, in addition to the constraints of <def> whose goal it keeps
+	CCorridorSearchConstraint(
+		const CPathFinderDef& def,
+		const std::vector<bool>& blocks,
+		unsigned int blocksX,
+		unsigned int blockSqrs
+	);
+
+	bool WithinConstraints(unsigned int xSquare, unsigned int zSquare) const {
+		if (!corridorBlocks[(zSquare / blockSize) * numBlocksX + (xSquare / blockSize)]) return false;
+		return (parentDef.WithinConstraints(xSquare, zSquare));
+	}
+
+private:
+	const CPathFinderDef& parentDef;
+	const std::vector<bool>& corridorBlocks;
+
+	unsigned int numBlocksX;
+	unsigned int blockSize;
+};
+
 #endif
 
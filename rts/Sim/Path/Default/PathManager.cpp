@@ -9,11 +9,15 @@
 #include "PathHeatMap.hpp"
 #include "Map/MapInfo.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Objects/SolidObjectDef.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/myMath.h"
+#include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
+#include "System/Util.h"
 
 #define PM_UNCONSTRAINED_MAXRES_FALLBACK_SEARCH 0
 #define PM_UNCONSTRAINED_MEDRES_FALLBACK_SEARCH 1
@@ -21,7 +25,7 @@
 
 
 
-CPathManager::CPathManager(): nextPathID(0)
+CPathManager::CPathManager(): nextPathID(0), numSearcherSlots(1)
 {
 	CPathFinder::InitDirectionVectorsTable();
 	CPathFinder::InitDirectionCostsTable();
@@ -37,6 +41,12 @@ CPathManager::CPathManager(): nextPathID(0)
 
 CPathManager::~CPathManager()
 {
+	for (PathSearchers& searchers: searcherSlots) {
+		delete searchers.lowResPE;
+		delete searchers.medResPE;
+		delete searchers.maxResPF;
+	}
+
 	delete lowResPE; lowResPE = NULL;
 	delete medResPE; medResPE = NULL;
 	delete maxResPF; maxResPF = NULL;
@@ -53,6 +63,27 @@ boost::int64_t CPathManager::Finalize() {
 		medResPE = new CPathEstimator(maxResPF, MEDRES_PE_BLOCKSIZE, "pe",  mapInfo->map.name);
 		lowResPE = new CPathEstimator(maxResPF, LOWRES_PE_BLOCKSIZE, "pe2", mapInfo->map.name);
 
+		// stack coarser levels while the map divides into enough blocks
+		CPathEstimator* coarsePE = lowResPE;
+
+		for (int level = 1; level <= modInfo.pathFinderEstimatorLevels && coarsePE != NULL; level++) {
+			coarsePE = coarsePE->AddCoarseLevel(COARSE_PE_BLOCKSIZE_FACTOR, IntToString(level, "pe2-%i"), mapInfo->map.name);
+		}
+
+		// every helper set holds full-map search-states (the PF's dominate), so
+		// keep the sets within the same budget as the estimator cache threads
+		{
+			const unsigned int memFootPrint =
+				(sizeof(CPathFinder) + maxResPF->GetMemFootPrint()) +
+				(sizeof(CPathEstimator) + medResPE->GetNodeStateBuffer().GetMemFootPrint()) +
+				(sizeof(CPathEstimator) + lowResPE->GetNodeStateBuffer().GetMemFootPrint());
+			const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
+
+			numSearcherSlots = Clamp(int(maxMemFootPrint / memFootPrint), 1, ThreadPool::GetNumThreads());
+
+			LOG("[%s] %u queued-search helper(s) (%u MB each)", __FUNCTION__, numSearcherSlots, memFootPrint / (1024 * 1024));
+		}
+
 		#ifdef SYNCDEBUG
 		// clients may have a non-writable cache directory (which causes
 		// the estimator path-file checksum to remain zero), so we can't
@@ -93,6 +124,32 @@ unsigned int CPathManager::RequestPath(
 	return (RequestPath(moveDef, sp, gp, pfDef, caller, synced));
 }
 
+// NOTE: this distance can be far smaller than the actual path length!
+// NOTE: take height difference into consideration for "special" cases
+// (unit at top of cliff, goal at bottom or vv.)
+static float GetHeuristicGoalDist2D(const CPathFinderDef* pfDef, const float3& startPos, const float3& goalPos)
+{
+	return (pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE);
+}
+
+/*
+Add one dummy waypoint to a CantGetCloser-result so that the calling
+MoveType does not consider the request a failure, which can happen when
+startPos is very close to goalPos.
+
+Otherwise, code relying on MoveType::progressState (eg.
+BuilderCAI::MoveInBuildRange) would misbehave (eg. reject build orders).
+*/
+static void AddStartWayPoint(IPath::Path& maxResPath, const float3& startPos)
+{
+	if (!maxResPath.path.empty())
+		return;
+
+	maxResPath.path.push_back(startPos);
+	maxResPath.squares.push_back(int2(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE));
+}
+
+
 /*
 Request a new multipath, store the result and return a handle-id to it.
 */
@@ -112,25 +169,81 @@ unsigned int CPathManager::RequestPath(
 	assert(moveDef == moveDefHandler->GetMoveDefByPathType(moveDef->pathType));
 
 	// Creates a new multipath.
-	IPath::SearchResult result = IPath::Error;
 	MultiPath* newPath = new MultiPath(startPos, pfDef, moveDef);
 	newPath->finalGoal = goalPos;
 	newPath->caller = caller;
 
+	// requests of ground units are searched by UpdateQueuedRequests if
+	// queued; until then NextWayPoint hands out temporary waypoints, so
+	// their movetype keeps asking for the real ones (classic GMT does
+	// not understand those)
+	if (synced && caller != NULL && modInfo.pathFinderSearchesPerFrame > 0 && !modInfo.useClassicGroundMoveType) {
+		const unsigned int pathID = Store(newPath);
+
+		newPath->queued = true;
+		queuedPathIDs.push_back(pathID);
+		return pathID;
+	}
+
+	if (synced) {
+		AddGoalFieldRequest(*newPath);
+		UpdateGoalFields();
+	}
+
 	if (caller != NULL) {
 		caller->UnBlock();
 	}
 
+	const PathSearchers searchers = {maxResPF, medResPE, lowResPE};
+	const IPath::SearchResult result = ArrangePath(*newPath, startPos, goalPos, searchers, synced);
+
 	unsigned int pathID = 0;
 
+	if (result != IPath::Error) {
+		if (result == IPath::CantGetCloser) {
+			AddStartWayPoint(newPath->maxResPath, startPos);
+		}
+
+		newPath->searchResult = result;
+		pathID = Store(newPath);
+	} else {
+		delete newPath;
+	}
+
+	if (caller != NULL) {
+		caller->Block();
+	}
+
+	return pathID;
+}
+
+
+/*
+Search the low-, med- and max-res paths of a new multipath.
+Only touches <multiPath> and <searchers>, besides reading the map.
+*/
+IPath::SearchResult CPathManager::ArrangePath(
+	MultiPath& multiPath,
+	const float3& startPos,
+	const float3& goalPos,
+	const PathSearchers& searchers,
+	bool synced
+) const {
+	CPathFinder* maxResPF = searchers.maxResPF;
+	CPathEstimator* medResPE = searchers.medResPE;
+	CPathEstimator* lowResPE = searchers.lowResPE;
+
+	CPathFinderDef* pfDef = multiPath.peDef;
+	CSolidObject* caller = multiPath.caller;
+	const MoveDef* moveDef = multiPath.moveDef;
+
+	IPath::SearchResult result = IPath::Error;
+
 	// choose the PF or the PE depending on the projected 2D goal-distance
-	// NOTE: this distance can be far smaller than the actual path length!
-	// NOTE: take height difference into consideration for "special" cases
-	// (unit at top of cliff, goal at bottom or vv.)
-	const float heuristicGoalDist2D = pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+	const float heuristicGoalDist2D = GetHeuristicGoalDist2D(pfDef, startPos, goalPos);
 
 	if (heuristicGoalDist2D < MAXRES_SEARCH_DISTANCE) {
-		result = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
+		result = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, multiPath.maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
 
 		#if (PM_UNCONSTRAINED_MAXRES_FALLBACK_SEARCH == 1)
 		// unnecessary so long as a fallback path exists within the
@@ -142,17 +255,17 @@ unsigned int CPathManager::RequestPath(
 		// fallback (note that this uses the estimators as backup,
 		// unconstrained PF queries are too expensive on average)
 		if (result != IPath::Ok) {
-			result = medResPE->GetPath(*moveDef, *pfDef, startPos, newPath->medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+			result = medResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 		}
 		if (result != IPath::Ok) {
-			result = lowResPE->GetPath(*moveDef, *pfDef, startPos, newPath->lowResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+			result = lowResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.lowResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 		}
 	} else if (heuristicGoalDist2D < MEDRES_SEARCH_DISTANCE) {
-		result = medResPE->GetPath(*moveDef, *pfDef, startPos, newPath->medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+		result = medResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 
 		// CantGetCloser may be a false positive due to PE approximations and large goalRadius
 		if (result == IPath::CantGetCloser && (startPos - goalPos).SqLength2D() > pfDef->sqGoalRadius) {
-			result = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
+			result = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, multiPath.maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
 		}
 
 		#if (PM_UNCONSTRAINED_MEDRES_FALLBACK_SEARCH == 1)
@@ -161,18 +274,18 @@ unsigned int CPathManager::RequestPath(
 
 		// fallback
 		if (result != IPath::Ok) {
-			result = medResPE->GetPath(*moveDef, *pfDef, startPos, newPath->medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+			result = medResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 		}
 	} else {
-		result = lowResPE->GetPath(*moveDef, *pfDef, startPos, newPath->lowResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+		result = lowResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.lowResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 
 		// CantGetCloser may be a false positive due to PE approximations and large goalRadius
 		if (result == IPath::CantGetCloser && (startPos - goalPos).SqLength2D() > pfDef->sqGoalRadius) {
-			result = medResPE->GetPath(*moveDef, *pfDef, startPos, newPath->medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+			result = medResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.medResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 
 			#if 0
 			if (result == IPath::CantGetCloser) // Same thing again
-				result = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
+				result = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, multiPath.maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
 			#endif
 		}
 
@@ -182,39 +295,51 @@ unsigned int CPathManager::RequestPath(
 
 		// fallback
 		if (result != IPath::Ok) {
-			result = lowResPE->GetPath(*moveDef, *pfDef, startPos, newPath->lowResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
+			result = lowResPE->GetPath(*moveDef, *pfDef, startPos, multiPath.lowResPath, MAX_SEARCHED_NODES_PE >> 3, synced);
 		}
 	}
 
-	if (result != IPath::Error) {
-		if (result != IPath::CantGetCloser) {
-			LowRes2MedRes(*newPath, startPos, caller, synced);
-			MedRes2MaxRes(*newPath, startPos, caller, synced);
-		} else {
-			// add one dummy waypoint so that the calling MoveType
-			// does not consider this request a failure, which can
-			// happen when startPos is very close to goalPos
-			//
-			// otherwise, code relying on MoveType::progressState
-			// (eg. BuilderCAI::MoveInBuildRange) would misbehave
-			// (eg. reject build orders)
-			if (newPath->maxResPath.path.empty()) {
-				newPath->maxResPath.path.push_back(startPos);
-				newPath->maxResPath.squares.push_back(int2(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE));
-			}
-		}
+	if (result != IPath::Error && result != IPath::CantGetCloser) {
+		LowRes2MedRes(multiPath, startPos, caller, searchers, synced);
+		MedRes2MaxRes(multiPath, startPos, caller, searchers, synced);
+	}
 
-		newPath->searchResult = result;
-		pathID = Store(newPath);
+	return result;
+}
+
+
+/*
+Count a synced request toward the goal-field of the estimator which
+ArrangePath will search it with, if any.
+*/
+void CPathManager::AddGoalFieldRequest(const MultiPath& multiPath)
+{
+	if (!modInfo.pathFinderGoalFields)
+		return;
+
+	const float heuristicGoalDist2D = GetHeuristicGoalDist2D(multiPath.peDef, multiPath.start, multiPath.finalGoal);
+
+	if (heuristicGoalDist2D < MAXRES_SEARCH_DISTANCE)
+		return;
+
+	if (heuristicGoalDist2D < MEDRES_SEARCH_DISTANCE) {
+		medResPE->AddGoalFieldRequest(*multiPath.moveDef, *multiPath.peDef, multiPath.start);
 	} else {
-		delete newPath;
+		lowResPE->AddGoalFieldRequest(*multiPath.moveDef, *multiPath.peDef, multiPath.start);
 	}
+}
 
-	if (caller != NULL) {
-		caller->Block();
-	}
+/*
+(Re)calculate the goal-fields with enough requests, before the searches
+that follow them.
+*/
+void CPathManager::UpdateGoalFields()
+{
+	if (!modInfo.pathFinderGoalFields)
+		return;
 
-	return pathID;
+	medResPE->UpdateGoalFields();
+	lowResPE->UpdateGoalFields();
 }
 
 
@@ -229,7 +354,7 @@ unsigned int CPathManager::Store(MultiPath* path)
 
 
 // converts part of a med-res path into a max-res path
-void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
+void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, const PathSearchers& searchers, bool synced) const
 {
 	assert(IsFinalized());
 
@@ -264,9 +389,9 @@ void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, c
 	IPath::SearchResult result = IPath::Error;
 
 	if (medResPath.path.empty() && lowResPath.path.empty()) {
-		result = maxResPF->GetPath(*multiPath.moveDef, *multiPath.peDef, owner, startPos, maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
+		result = searchers.maxResPF->GetPath(*multiPath.moveDef, *multiPath.peDef, owner, startPos, maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
 	} else {
-		result = maxResPF->GetPath(*multiPath.moveDef, rangedGoalPFD, owner, startPos, maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
+		result = searchers.maxResPF->GetPath(*multiPath.moveDef, rangedGoalPFD, owner, startPos, maxResPath, MAX_SEARCHED_NODES_PF >> 3, true, false, true, false, synced);
 	}
 
 	// If no refined path could be found, set goal as desired goal.
@@ -276,7 +401,7 @@ void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, c
 }
 
 // converts part of a low-res path into a med-res path
-void CPathManager::LowRes2MedRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
+void CPathManager::LowRes2MedRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, const PathSearchers& searchers, bool synced) const
 {
 	assert(IsFinalized());
 
@@ -310,9 +435,9 @@ void CPathManager::LowRes2MedRes(MultiPath& multiPath, const float3& startPos, c
 	IPath::SearchResult result = IPath::Error;
 
 	if (lowResPath.path.empty()) {
-		result = medResPE->GetPath(*multiPath.moveDef, *multiPath.peDef, startPos, medResPath, MAX_SEARCHED_NODES_ON_REFINE, synced);
+		result = searchers.medResPE->GetPath(*multiPath.moveDef, *multiPath.peDef, startPos, medResPath, MAX_SEARCHED_NODES_ON_REFINE, synced);
 	} else {
-		result = medResPE->GetPath(*multiPath.moveDef, rangedGoalDef, startPos, medResPath, MAX_SEARCHED_NODES_ON_REFINE, synced);
+		result = searchers.medResPE->GetPath(*multiPath.moveDef, rangedGoalDef, startPos, medResPath, MAX_SEARCHED_NODES_ON_REFINE, synced);
 	}
 
 	// If no refined path could be found, set goal as desired goal.
@@ -350,6 +475,18 @@ float3 CPathManager::NextWayPoint(
 	if (multiPath == NULL)
 		return noPathPoint;
 
+	if (multiPath->queued) {
+		// the request has not been searched yet, head toward the goal
+		// meanwhile; y=-1 marks this as a temporary waypoint that GMT
+		// replaces by asking again, which it does once it is reached so
+		// keep it a small distance in front of the owner (<callerPos> is
+		// usually the previous waypoint, stepping from it would let the
+		// temporary ones run away from the unit)
+		const float3 basePos = (owner != NULL)? owner->pos: multiPath->start;
+		const float3 goalDir = ((multiPath->finalGoal - basePos) * XZVector).SafeNormalize() * SQUARE_SIZE;
+		return float3(basePos.x + goalDir.x, -1.0f, basePos.z + goalDir.z);
+	}
+
 	if (numRetries > MAX_PATH_REFINEMENT_DEPTH)
 		return (multiPath->finalGoal);
 
@@ -376,15 +513,17 @@ float3 CPathManager::NextWayPoint(
 	// recursive refinement of its lower-resolution segments
 	// if so, check if the med-res path also needs extending
 	if (extendMaxResPath) {
+		const PathSearchers searchers = {maxResPF, medResPE, lowResPE};
+
 		if (extendMedResPath) {
-			LowRes2MedRes(*multiPath, callerPos, owner, synced);
+			LowRes2MedRes(*multiPath, callerPos, owner, searchers, synced);
 		}
 
 		if (multiPath->caller != NULL) {
 			multiPath->caller->UnBlock();
 		}
 
-		MedRes2MaxRes(*multiPath, callerPos, owner, synced);
+		MedRes2MaxRes(*multiPath, callerPos, owner, searchers, synced);
 
 		if (multiPath->caller != NULL) {
 			multiPath->caller->Block();
@@ -419,7 +558,6 @@ float3 CPathManager::NextWayPoint(
 	} while ((callerPos.SqDistance2D(waypoint) < Square(radius)) && (waypoint != maxResPath.pathGoal));
 
 	// y=0 indicates this is not a temporary waypoint
-	// (the default PFS does not queue path-requests)
 	return (waypoint * XZVector);
 }
 
@@ -462,8 +600,256 @@ void CPathManager::Update()
 	pathFlowMap->Update();
 	pathHeatMap->Update();
 
+	PrioritizePathBlocks();
+
 	medResPE->Update();
 	lowResPE->Update();
+
+	UpdateQueuedRequests();
+}
+
+
+// lets the estimators repair the blocks that paths in use go
+// through before the others changed by terrain deformations
+void CPathManager::PrioritizePathBlocks()
+{
+	const bool medResQueued = (medResPE->GetNumQueuedBlocks() > 0);
+	const bool lowResQueued = (lowResPE->GetNumQueuedBlocks() > 0);
+
+	if (!medResQueued && !lowResQueued)
+		return;
+
+	for (std::map<unsigned int, MultiPath*>::const_iterator it = pathMap.begin(); it != pathMap.end(); ++it) {
+		const MultiPath* multiPath = it->second;
+
+		if (medResQueued)
+			medResPE->PrioritizeBlocks(multiPath->medResPath);
+		if (lowResQueued)
+			lowResPE->PrioritizeBlocks(multiPath->lowResPath);
+	}
+}
+
+
+bool CPathManager::QueuedSearchKey::operator < (const QueuedSearchKey& k) const {
+	if (pathType != k.pathType)
+		return (pathType < k.pathType);
+	if (startBlockIdx != k.startBlockIdx)
+		return (startBlockIdx < k.startBlockIdx);
+	if (goalBlockIdx != k.goalBlockIdx)
+		return (goalBlockIdx < k.goalBlockIdx);
+
+	return (sqGoalRadius < k.sqGoalRadius);
+}
+
+// searches the requests queued since the last frame (and those left over)
+//
+// requests for the same MoveDef, start- and goal-block share one search,
+// at most modInfo.pathFinderSearchesPerFrame searches are done per frame
+// in request order and the rest waits for the next; the searches run in
+// parallel but only read the map and write into their own MultiPath and
+// helper instances (which do not cache paths), so results and the frame
+// they are done in do not depend on the number of threads
+void CPathManager::UpdateQueuedRequests()
+{
+	if (queuedPathIDs.empty())
+		return;
+
+	SCOPED_TIMER("PathManager::UpdateQueuedRequests");
+
+	const unsigned int blockSize = medResPE->GetBlockSize();
+	const unsigned int numBlocksX = medResPE->GetNumBlocksX();
+
+	std::map<QueuedSearchKey, MultiPath*> searchedPaths;
+	std::vector<MultiPath*> searches;
+	// (request, search) pairs, in request order
+	std::vector< std::pair<unsigned int, MultiPath*> > searchedPathIDs;
+	std::vector<unsigned int> waitingPathIDs;
+
+	searchedPathIDs.reserve(queuedPathIDs.size());
+
+	for (const unsigned int pathID: queuedPathIDs) {
+		MultiPath* multiPath = GetMultiPath(pathID);
+
+		// deleted before it was searched
+		if (multiPath == NULL)
+			continue;
+
+		const int2 startBlock = int2(multiPath->start.x / (blockSize * SQUARE_SIZE), multiPath->start.z / (blockSize * SQUARE_SIZE));
+		const int2 goalBlock = int2(multiPath->peDef->goalSquareX / blockSize, multiPath->peDef->goalSquareZ / blockSize);
+
+		QueuedSearchKey key;
+		key.pathType = multiPath->moveDef->pathType;
+		key.startBlockIdx = startBlock.y * numBlocksX + startBlock.x;
+		key.goalBlockIdx = goalBlock.y * numBlocksX + goalBlock.x;
+		key.sqGoalRadius = multiPath->peDef->sqGoalRadius;
+
+		const std::map<QueuedSearchKey, MultiPath*>::const_iterator it = searchedPaths.find(key);
+
+		if (it != searchedPaths.end()) {
+			searchedPathIDs.push_back(std::make_pair(pathID, it->second));
+			continue;
+		}
+
+		if (searches.size() >= size_t(modInfo.pathFinderSearchesPerFrame)) {
+			waitingPathIDs.push_back(pathID);
+			continue;
+		}
+
+		searchedPaths[key] = multiPath;
+		searches.push_back(multiPath);
+		searchedPathIDs.push_back(std::make_pair(pathID, multiPath));
+	}
+
+	// at most numSearcherSlots helper sets ever exist, each one
+	// is kept until the PFS is destroyed and reused every frame
+	const unsigned int numSlots = std::min(numSearcherSlots, unsigned(searches.size()));
+
+	if (searcherSlots.size() < numSlots) {
+		searcherSlots.resize(numSlots);
+	}
+
+	// goal-fields are calculated here, the helpers can only follow them
+	for (const MultiPath* multiPath: searches) {
+		AddGoalFieldRequest(*multiPath);
+	}
+
+	UpdateGoalFields();
+
+	// each slot searches every numSlots'th request with its own helpers
+	for_mt(0, numSlots, [&](const int slot) {
+		const PathSearchers& searchers = GetSlotSearchers(slot);
+
+		for (unsigned int n = slot; n < searches.size(); n += numSlots) {
+			MultiPath* multiPath = searches[n];
+			multiPath->searchResult = ArrangePath(*multiPath, multiPath->start, multiPath->finalGoal, searchers, true);
+		}
+	});
+
+	// hand out the shared results before failed searches are deleted
+	for (const auto& p: searchedPathIDs) {
+		MultiPath* multiPath = GetMultiPath(p.first);
+		const MultiPath* searchedPath = p.second;
+
+		if (multiPath == searchedPath)
+			continue;
+
+		multiPath->lowResPath = searchedPath->lowResPath;
+		multiPath->medResPath = searchedPath->medResPath;
+		multiPath->maxResPath = searchedPath->maxResPath;
+		multiPath->searchResult = searchedPath->searchResult;
+		multiPath->peDef->DisableConstraint(searchedPath->peDef->constraintDisabled);
+	}
+
+	for (const auto& p: searchedPathIDs) {
+		MultiPath* multiPath = GetMultiPath(p.first);
+
+		multiPath->queued = false;
+
+		switch (multiPath->searchResult) {
+			case IPath::Error: {
+				// NextWayPoint now fails like for an unknown ID
+				DeletePath(p.first);
+			} break;
+			case IPath::CantGetCloser: {
+				AddStartWayPoint(multiPath->maxResPath, multiPath->start);
+			} break;
+			default: {
+			} break;
+		}
+	}
+
+	queuedPathIDs.swap(waitingPathIDs);
+}
+
+// runs the same long searches for every MoveDef once per number of coarse
+// estimator levels (0 up to those the mod stacked), on low-res helpers so
+// the estimators' caches and statistics stay untouched
+void CPathManager::BenchmarkSearches(FILE* file)
+{
+	assert(IsFinalized());
+
+	static const unsigned int NUM_REQUESTS_PER_SIDE = 8;
+
+	// starts in the left quarter of the map, goals mirrored through its center
+	std::vector< std::pair<float3, float3> > requests;
+
+	const float mapSizeX = gs->mapx * SQUARE_SIZE;
+	const float mapSizeZ = gs->mapy * SQUARE_SIZE;
+
+	for (unsigned int i = 0; i < NUM_REQUESTS_PER_SIDE; i++) {
+		for (unsigned int j = 0; j < NUM_REQUESTS_PER_SIDE; j++) {
+			const float3 startPos((i + 0.5f) / NUM_REQUESTS_PER_SIDE * mapSizeX * 0.25f, 0.0f, (j + 0.5f) / NUM_REQUESTS_PER_SIDE * mapSizeZ);
+			const float3 goalPos(mapSizeX - startPos.x, 0.0f, mapSizeZ - startPos.z);
+
+			requests.push_back(std::make_pair(startPos, goalPos));
+		}
+	}
+
+	unsigned int numLevels = 0;
+
+	for (const CPathEstimator* pe = lowResPE->GetCoarseEstimator(); pe != NULL; pe = pe->GetCoarseEstimator()) {
+		numLevels++;
+	}
+
+	fprintf(file, "movedef\tlevels\tnum_searches\tnum_failed\ttested_blocks\ttime_ms\n");
+
+	for (unsigned int pathType = 0; pathType < moveDefHandler->GetNumMoveDefs(); pathType++) {
+		const MoveDef* moveDef = moveDefHandler->GetMoveDefByPathType(pathType);
+
+		for (unsigned int levels = 0; levels <= numLevels; levels++) {
+			CPathEstimator* searcher = new CPathEstimator(lowResPE);
+			CPathEstimator* lastPE = searcher;
+
+			// detach the helper chain below the <levels>'th coarse level
+			for (unsigned int n = 0; n < levels; n++) {
+				lastPE = lastPE->coarsePE;
+			}
+
+			CPathEstimator* detachedPE = lastPE->coarsePE;
+			lastPE->coarsePE = NULL;
+
+			unsigned int numFailed = 0;
+			const spring_time t0 = spring_gettime();
+
+			for (const auto& request: requests) {
+				CCircularSearchConstraint peDef(request.first, request.second, 64.0f, 3.0f, 2000);
+				IPath::Path path;
+
+				numFailed += (searcher->GetPath(*moveDef, peDef, request.first, path, MAX_SEARCHED_NODES_PE >> 3, false) != IPath::Ok);
+			}
+
+			const spring_time dt = spring_gettime() - t0;
+
+			boost::uint64_t numTestedBlocks = 0;
+
+			// helpers add their statistics to the estimators' when deleted
+			for (CPathEstimator* pe = searcher; pe != NULL; pe = pe->coarsePE) {
+				numTestedBlocks += (pe->searchStats.numTestedBlocks + pe->searchStats.numCorridorTestedBlocks);
+				pe->searchStats = CPathEstimator::SearchStats();
+			}
+
+			lastPE->coarsePE = detachedPE;
+			delete searcher;
+
+			fprintf(file, "%s\t%u\t" _STPF_ "\t%u\t%lu\t%.3f\n",
+				moveDef->name.c_str(), levels, requests.size(), numFailed,
+				(unsigned long) numTestedBlocks, dt.toMilliSecsf());
+		}
+	}
+}
+
+CPathManager::PathSearchers& CPathManager::GetSlotSearchers(unsigned int slot)
+{
+	PathSearchers& searchers = searcherSlots[slot];
+
+	// created on first use, by the thread that uses them
+	if (searchers.maxResPF == NULL) {
+		searchers.maxResPF = new CPathFinder(maxResPF);
+		searchers.medResPE = new CPathEstimator(medResPE);
+		searchers.lowResPE = new CPathEstimator(lowResPE);
+	}
+
+	return searchers;
 }
 
 // used to deposit heat on the heat-map as a unit moves along its path
@@ -579,6 +965,15 @@ bool CPathManager::SetNodeExtraCost(unsigned int x, unsigned int z, float cost,
 	maxResBuf.SetNodeExtraCost(x, z, cost, synced);
 	medResBuf.SetNodeExtraCost(x, z, cost, synced);
 	lowResBuf.SetNodeExtraCost(x, z, cost, synced);
+
+	for (CPathEstimator* pe = lowResPE->GetCoarseEstimator(); pe != NULL; pe = pe->GetCoarseEstimator()) {
+		pe->GetNodeStateBuffer().SetNodeExtraCost(x, z, cost, synced);
+	}
+
+	if (synced) {
+		medResPE->InvalidateGoalFields();
+		lowResPE->InvalidateGoalFields();
+	}
 	return true;
 }
 
@@ -597,6 +992,15 @@ bool CPathManager::SetNodeExtraCosts(const float* costs, unsigned int sizex, uns
 	maxResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	medResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	lowResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
+
+	for (CPathEstimator* pe = lowResPE->GetCoarseEstimator(); pe != NULL; pe = pe->GetCoarseEstimator()) {
+		pe->GetNodeStateBuffer().SetNodeExtraCosts(costs, sizex, sizez, synced);
+	}
+
+	if (synced) {
+		medResPE->InvalidateGoalFields();
+		lowResPE->InvalidateGoalFields();
+	}
 	return true;
 }
 
@@ -625,8 +1029,19 @@ int2 CPathManager::GetNumQueuedUpdates() const {
 	int2 data;
 
 	if (IsFinalized()) {
-		data.x = medResPE->updatedBlocks.size();
-		data.y = lowResPE->updatedBlocks.size();
+		data.x = medResPE->GetNumQueuedBlocks();
+		data.y = lowResPE->GetNumQueuedBlocks();
+	}
+
+	return data;
+}
+
+int2 CPathManager::GetNumPriorityUpdates() const {
+	int2 data;
+
+	if (IsFinalized()) {
+		data.x = medResPE->GetNumPriorityBlocks();
+		data.y = lowResPE->GetNumPriorityBlocks();
 	}
 
 	return data;
@@ -4,6 +4,7 @@
 #define PATHMANAGER_H
 
 #include <map>
+#include <vector>
 #include <boost/cstdint.hpp> /* Replace with <stdint.h> if appropriate */
 
 #include "Sim/Path/IPathManager.h"
@@ -80,6 +81,10 @@ public:
 	const float* GetNodeExtraCosts(bool) const;
 
 	int2 GetNumQueuedUpdates() const;
+	int2 GetNumPriorityUpdates() const;
+	unsigned int GetNumQueuedRequests() const { return queuedPathIDs.size(); }
+
+	void BenchmarkSearches(FILE* file);
 
 private:
 	unsigned int RequestPath(
@@ -92,13 +97,14 @@ private:
 	);
 
 	struct MultiPath {
-		MultiPath(const float3& pos, const CPathFinderDef* def, const MoveDef* moveDef)
+		MultiPath(const float3& pos, CPathFinderDef* def, const MoveDef* moveDef)
 			: searchResult(IPath::Error)
 			, start(pos)
 			, peDef(def)
 			, moveDef(moveDef)
 			, finalGoal(ZeroVector)
 			, caller(NULL)
+			, queued(false)
 		{}
 
 		~MultiPath() { delete peDef; }
@@ -111,18 +117,45 @@ private:
 
 		// Request definition
 		const float3 start;
-		const CPathFinderDef* peDef;
+		CPathFinderDef* peDef;
 		const MoveDef* moveDef;
 
 		// Additional information.
 		float3 finalGoal;
 		CSolidObject* caller;
+
+		// true until the search of a queued request was done
+		bool queued;
+	};
+
+	/// one instance of each search, only used by one thread at a time
+	struct PathSearchers {
+		CPathFinder* maxResPF;
+		CPathEstimator* medResPE;
+		CPathEstimator* lowResPE;
+	};
+
+	/// requests searching the same blocks share one search
+	struct QueuedSearchKey {
+		bool operator < (const QueuedSearchKey& k) const;
+
+		int pathType;
+		int startBlockIdx;
+		int goalBlockIdx;
+		float sqGoalRadius;
 	};
 
 	inline MultiPath* GetMultiPath(int pathID) const;
 	unsigned int Store(MultiPath* path);
-	void LowRes2MedRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
-	void MedRes2MaxRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
+	IPath::SearchResult ArrangePath(MultiPath& path, const float3& startPos, const float3& goalPos, const PathSearchers& searchers, bool synced) const;
+	void LowRes2MedRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, const PathSearchers& searchers, bool synced) const;
+	void MedRes2MaxRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, const PathSearchers& searchers, bool synced) const;
+
+	void AddGoalFieldRequest(const MultiPath& multiPath);
+	void UpdateGoalFields();
+	void UpdateQueuedRequests();
+	void PrioritizePathBlocks();
+	PathSearchers& GetSlotSearchers(unsigned int slot);
 
 	bool IsFinalized() const { return (maxResPF != NULL); }
 
@@ -135,6 +168,13 @@ private:
 
 	std::map<unsigned int, MultiPath*> pathMap;
 	unsigned int nextPathID;
+
+	/// IDs of queued requests, in the order they were made
+	std::vector<unsigned int> queuedPathIDs;
+	/// helper instances searching queued requests, one set per slot
+	std::vector<PathSearchers> searcherSlots;
+	/// max. number of slots, bounded by MaxPathCostsMemoryFootPrint
+	unsigned int numSearcherSlots;
 };
 
 inline CPathManager::MultiPath* CPathManager::GetMultiPath(int pathID) const {
@@ -3,6 +3,7 @@
 #ifndef I_PATH_MANAGER_H
 #define I_PATH_MANAGER_H
 
+#include <cstdio>
 #include <boost/cstdint.hpp> /* Replace with <stdint.h> if appropriate */
 
 #include "PFSTypes.h"
@@ -162,6 +163,13 @@ public:
 	virtual const float* GetNodeExtraCosts(bool synced) const { return NULL; }
 
 	virtual int2 GetNumQueuedUpdates() const { return (int2(0, 0)); }
+	/// number of queued updates moved ahead for lying on paths in use
+	virtual int2 GetNumPriorityUpdates() const { return (int2(0, 0)); }
+	/// number of path-requests not yet searched (only if requests are queued)
+	virtual unsigned int GetNumQueuedRequests() const { return 0; }
+
+	/// runs a fixed set of long searches and writes their costs (tab-separated) to <file>
+	virtual void BenchmarkSearches(FILE* file) {}
 };
 
 extern IPathManager* pathManager;
@@ -52,20 +52,24 @@ public:
 	struct QuadFieldCellData {
 		CR_DECLARE_STRUCT(QuadFieldCellData)
 
-		// must match typeof(QuadField::Quad::projectiles)
-		typedef std::list<CProjectile*>::iterator iter;
+		QuadFieldCellData() {
+			for (unsigned int n = 0; n < 3; n++) {
+				indices[n] = -1;
+			}
+		}
 
 		const int2& GetCoor(unsigned int idx) const { return coors[idx]; }
-		const iter& GetIter(unsigned int idx) const { return iters[idx]; }
+		int GetIndex(unsigned int idx) const { return indices[idx]; }
 
 		void SetCoor(unsigned int idx, const int2& co) { coors[idx] = co; }
-		void SetIter(unsigned int idx, const iter& it) { iters[idx] = it; }
+		void SetIndex(unsigned int idx, int i) { indices[idx] = i; }
 
 	private:
-		// coordinates and iterators for pos, (pos+spd)*0.5, pos+spd
-		// non-hitscan projectiles *only* use coors[0] and iters[0]!
+		// coordinates of and positions in QuadField::Quad::projectiles for
+		// pos, (pos+spd)*0.5, pos+spd (-1 if not inserted into that cell)
+		// non-hitscan projectiles *only* use coors[0] and indices[0]!
 		int2 coors[3];
-		iter iters[3];
+		int indices[3];
 	};
 
 	// override WorldObject::SetVelocityAndSpeed so
@@ -23,9 +23,14 @@
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
+#include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Map.h"
 #include "System/creg/STL_List.h"
 
+#ifndef DEDICATED_NOSSE
+	#include <xmmintrin.h>
+#endif
+
 // reserve 5% of maxNanoParticles for important stuff such as capture and reclaim other teams' units
 #define NORMAL_NANO_PRIO 0.95f
 #define HIGH_NANO_PRIO 1.0f
@@ -41,8 +46,11 @@ CProjectileHandler* projectileHandler = NULL;
 
 CR_BIND_TEMPLATE(ProjectileContainer, )
 CR_REG_METADATA(ProjectileContainer, (
-	CR_MEMBER(cont),
-	CR_POSTLOAD(PostLoad)
+	CR_MEMBER(values),
+	CR_MEMBER(valueIDs),
+	CR_MEMBER(slotIndices),
+	CR_MEMBER(slotGenerations),
+	CR_MEMBER(freeSlots)
 ));
 CR_BIND_TEMPLATE(GroundFlashContainer, )
 CR_REG_METADATA(GroundFlashContainer, (
@@ -64,17 +72,9 @@ CR_REG_METADATA(CProjectileHandler, (
 	CR_MEMBER(currentNanoParticles),
 	CR_MEMBER(particleSaturation),
 
-	CR_MEMBER(maxUsedSyncedID),
-	CR_MEMBER(maxUsedUnsyncedID),
-
 	//CR_MEMBER(syncedRenderProjectileIDs),
 	//CR_MEMBER(unsyncedRenderProjectileIDs),
 
-	CR_MEMBER(freeSyncedIDs),
-	CR_MEMBER(freeUnsyncedIDs),
-	CR_MEMBER(syncedProjectileIDs),
-	CR_MEMBER(unsyncedProjectileIDs),
-
 	CR_SERIALIZER(Serialize),
 	CR_POSTLOAD(PostLoad)
 ));
@@ -94,67 +94,52 @@ CProjectileHandler::CProjectileHandler()
 	currentNanoParticles   = 0;
 	particleSaturation     = 0.0f;
 
-	// preload some IDs
-	for (int i = 0; i < 16384; i++) {
-		freeSyncedIDs.push_back(i);
-		freeUnsyncedIDs.push_back(i);
-	}
-
-	maxUsedSyncedID = freeSyncedIDs.size();
-	maxUsedUnsyncedID = freeUnsyncedIDs.size();
+	colBatch.container = NULL;
+	colBatch.stamp = 0;
 }
 
 CProjectileHandler::~CProjectileHandler()
 {
-	syncedProjectiles.detach_all();
-	syncedProjectiles.clear(); // synced first, to avoid callback crashes
-	unsyncedProjectiles.clear();
-
-	freeSyncedIDs.clear();
-	freeUnsyncedIDs.clear();
+	// synced first, to avoid callback crashes
+	for (ProjectileContainer::iterator it = syncedProjectiles.begin(); it != syncedProjectiles.end(); ++it) {
+		ProjectileDetacher::Detach(it->first);
+		delete it->first;
+	}
+	for (unsigned int n = 0; n < deletedSyncedProjectiles.size(); n++) {
+		delete deletedSyncedProjectiles[n];
+	}
+	for (ProjectileContainer::iterator it = unsyncedProjectiles.begin(); it != unsyncedProjectiles.end(); ++it) {
+		delete it->first;
+	}
 
-	syncedProjectileIDs.clear();
-	unsyncedProjectileIDs.clear();
+	syncedProjectiles.clear();
+	unsyncedProjectiles.clear();
+	deletedSyncedProjectiles.clear();
 
 	CCollisionHandler::PrintStats();
 }
 
 void CProjectileHandler::Serialize(creg::ISerializer* s)
 {
-	if (s->IsWriting()) {
-		int ssize = int(syncedProjectiles.size());
-		int usize = int(unsyncedProjectiles.size());
-
-		s->Serialize(&ssize, sizeof(int));
-		for (ProjectileContainer::iterator it = syncedProjectiles.begin(); it != syncedProjectiles.end(); ++it) {
-			void** ptr = (void**) &*it;
-			s->SerializeObjectPtr(ptr, (*it)->GetClass());
-		}
+	// the containers themselves (IDs and slots) are creg members,
+	// this only (re-)links the polymorphic projectile pointers
+	int ssize = int(syncedProjectiles.size());
+	int usize = int(unsyncedProjectiles.size());
 
-		s->Serialize(&usize, sizeof(int));
-		for (ProjectileContainer::iterator it = unsyncedProjectiles.begin(); it != unsyncedProjectiles.end(); ++it) {
-			void** ptr = (void**) &*it;
-			s->SerializeObjectPtr(ptr, (*it)->GetClass());
-		}
-	} else {
-		int ssize, usize;
-
-		s->Serialize(&ssize, sizeof(int));
-		syncedProjectiles.resize(ssize);
-
-		for (ProjectileContainer::iterator it = syncedProjectiles.begin(); it != syncedProjectiles.end(); ++it) {
-			void** ptr = (void**) &*it;
-			s->SerializeObjectPtr(ptr, 0/*FIXME*/);
-		}
+	s->Serialize(&ssize, sizeof(int));
+	assert(ssize == int(syncedProjectiles.size()));
 
+	for (ProjectileContainer::iterator it = syncedProjectiles.begin(); it != syncedProjectiles.end(); ++it) {
+		void** ptr = (void**) &(it->first);
+		s->SerializeObjectPtr(ptr, s->IsWriting()? it->first->GetClass(): 0/*FIXME*/);
+	}
 
-		s->Serialize(&usize, sizeof(int));
-		unsyncedProjectiles.resize(usize);
+	s->Serialize(&usize, sizeof(int));
+	assert(usize == int(unsyncedProjectiles.size()));
 
-		for (ProjectileContainer::iterator it = unsyncedProjectiles.begin(); it != unsyncedProjectiles.end(); ++it) {
-			void** ptr = (void**) &*it;
-			s->SerializeObjectPtr(ptr, 0/*FIXME*/);
-		}
+	for (ProjectileContainer::iterator it = unsyncedProjectiles.begin(); it != unsyncedProjectiles.end(); ++it) {
+		void** ptr = (void**) &(it->first);
+		s->SerializeObjectPtr(ptr, s->IsWriting()? it->first->GetClass(): 0/*FIXME*/);
 	}
 }
 
@@ -167,8 +152,6 @@ void CProjectileHandler::PostLoad()
 
 
 void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool synced) {
-	ProjectileContainer::iterator pci = pc.begin();
-
 	#define MAPPOS_SANITY_CHECK(v)                 \
 		assert(v.x >= -(float3::maxxpos * 16.0f)); \
 		assert(v.x <=  (float3::maxxpos * 16.0f)); \
@@ -180,51 +163,41 @@ void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool
 		p->pos.AssertNaNs();   \
 		MAPPOS_SANITY_CHECK(p->pos);
 
-	while (pci != pc.end()) {
-		CProjectile* p = *pci;
+	// stable in-place compaction: survivors keep their update order and
+	// projectiles created by p->Update() are appended and updated as well
+	pc.filter([&](const ProjectileMapValPair& pp) -> bool {
+		CProjectile* p = pp.first;
 		assert(p->synced == synced);
 		assert(p->synced == !!(p->GetClass()->binder->flags & creg::CF_Synced));
 
 		if (p->deleteMe) {
-			ProjectileMap::iterator pIt;
-
 			if (synced) {
-				//! iterator is always valid
-				pIt = syncedProjectileIDs.find(p->id);
-
-				eventHandler.ProjectileDestroyed((pIt->second).first, (pIt->second).second);
+				eventHandler.ProjectileDestroyed(pp.first, pp.second);
 				syncedRenderProjectileIDs.erase_delete(p);
-				syncedProjectileIDs.erase(pIt);
-
-				freeSyncedIDs.push_back(p->id);
 
 				//! push_back this projectile for deletion
-				pci = pc.erase_delete_synced(pci);
+				deletedSyncedProjectiles.push_back(p);
 			} else {
 #if UNSYNCED_PROJ_NOEVENT
 				eventHandler.UnsyncedProjectileDestroyed(p);
 #else
-				pIt = unsyncedProjectileIDs.find(p->id);
-
-				eventHandler.ProjectileDestroyed((pIt->second).first, (pIt->second).second);
+				eventHandler.ProjectileDestroyed(pp.first, pp.second);
 				unsyncedRenderProjectileIDs.erase_delete(p);
-				unsyncedProjectileIDs.erase(pIt);
-
-				freeUnsyncedIDs.push_back(p->id);
 #endif
-				pci = pc.erase_detach(pci);
+				delete p;
 			}
-		} else {
-			PROJECTILE_SANITY_CHECK(p);
 
-			p->Update();
-			quadField->MovedProjectile(p);
+			return false;
+		}
+
+		PROJECTILE_SANITY_CHECK(p);
 
-			PROJECTILE_SANITY_CHECK(p);
+		p->Update();
+		quadField->MovedProjectile(p);
 
-			++pci;
-		}
-	}
+		PROJECTILE_SANITY_CHECK(p);
+		return true;
+	});
 }
 
 
@@ -249,11 +222,16 @@ void CProjectileHandler::Update()
 			unsyncedRenderProjectileIDs.delay_add();
 #endif
 
-			if (syncedProjectiles.can_delete_synced()) {
+			if (!deletedSyncedProjectiles.empty()) {
 				eventHandler.DeleteSyncedProjectiles();
 				//! delete all projectiles that were
 				//! queued (push_back'ed) for deletion
-				syncedProjectiles.detach_erased_synced();
+				for (unsigned int n = 0; n < deletedSyncedProjectiles.size(); n++) {
+					ProjectileDetacher::Detach(deletedSyncedProjectiles[n]);
+					delete deletedSyncedProjectiles[n];
+				}
+
+				deletedSyncedProjectiles.clear();
 			}
 
 			eventHandler.UpdateProjectiles();
@@ -310,56 +288,32 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 	// already initialized?
 	assert(p->id < 0);
 
-	std::list<int>* freeIDs = NULL;
-	ProjectileMap* proIDs = NULL;
-	ProjectileRenderMap* newProIDs = NULL;
+	ProjectileContainer* pc = p->synced? &syncedProjectiles: &unsyncedProjectiles;
+	ProjectileRenderMap* newProIDs = p->synced? &syncedRenderProjectileIDs: &unsyncedRenderProjectileIDs;
 
-	int* maxUsedID = NULL;
-	int newUsedID = 0;
-
-	if (p->synced) {
-		syncedProjectiles.push(p);
-		freeIDs = &freeSyncedIDs;
-		proIDs = &syncedProjectileIDs;
-		newProIDs = &syncedRenderProjectileIDs;
-		maxUsedID = &maxUsedSyncedID;
-
-		ASSERT_SYNCED(*maxUsedID);
-		ASSERT_SYNCED(freeIDs->size());
-	} else {
-		unsyncedProjectiles.push(p);
-#if UNSYNCED_PROJ_NOEVENT
-		eventHandler.UnsyncedProjectileCreated(p);
-		return;
-#endif
-		freeIDs = &freeUnsyncedIDs;
-		proIDs = &unsyncedProjectileIDs;
-		newProIDs = &unsyncedRenderProjectileIDs;
-		maxUsedID = &maxUsedUnsyncedID;
+	if (pc->size() >= ProjectileContainer::MAX_SIZE) {
+		LOG_L(L_WARNING, "Lua %s projectile IDs are now out of range", (p->synced? "synced": "unsynced"));
 	}
 
-	if (!freeIDs->empty()) {
-		newUsedID = freeIDs->front();
-		freeIDs->pop_front();
-	} else {
-		(*maxUsedID)++;
-		newUsedID = *maxUsedID;
-	}
+	const ProjectileMapValPair vp(p, p->owner() ? p->owner()->allyteam : -1);
+	const int newUsedID = pc->insert(vp);
 
-	if ((*maxUsedID) > (1 << 24)) {
-		LOG_L(L_WARNING, "Lua %s projectile IDs are now out of range", (p->synced? "synced": "unsynced"));
+	// created by an impact, still gets tested for collisions this frame
+	if (colBatch.container == pc) {
+		AddToCollisionBatch(p);
 	}
 
 	if (p->synced) {
 		ASSERT_SYNCED(newUsedID);
+	} else {
+#if UNSYNCED_PROJ_NOEVENT
+		eventHandler.UnsyncedProjectileCreated(p);
+		return;
+#endif
 	}
 
 	p->id = newUsedID;
 
-	const ProjectileMapValPair vp(p, p->owner() ? p->owner()->allyteam : -1);
-	const ProjectileMapKeyPair kp(p->id, vp);
-
-	proIDs->insert(kp);
 	newProIDs->push(p, vp);
 
 	eventHandler.ProjectileCreated(vp.first, vp.second);
@@ -368,7 +322,7 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 
 
 
-void CProjectileHandler::CheckUnitCollisions(
+bool CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
 	std::vector<CUnit*>& tempUnits,
 	const float3& ppos0,
@@ -413,12 +367,14 @@ void CProjectileHandler::CheckUnitCollisions(
 				p->Collision(unit);
 			}
 
-			break;
+			return true;
 		}
 	}
+
+	return false;
 }
 
-void CProjectileHandler::CheckFeatureCollisions(
+bool CProjectileHandler::CheckFeatureCollisions(
 	CProjectile* p,
 	std::vector<CFeature*>& tempFeatures,
 	const float3& ppos0,
@@ -426,10 +382,10 @@ void CProjectileHandler::CheckFeatureCollisions(
 {
 	// already collided with unit?
 	if (!p->checkCol)
-		return;
+		return false;
 
 	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0)
-		return;
+		return false;
 
 	CollisionQuery cq;
 
@@ -451,36 +407,297 @@ void CProjectileHandler::CheckFeatureCollisions(
 				p->Collision(feature);
 			}
 
-			break;
+			return true;
 		}
 	}
+
+	return false;
 }
 
-void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc) {
-	static std::vector<CUnit*> tempUnits(unitHandler->MaxUnits(), NULL);
-	static std::vector<CFeature*> tempFeatures(unitHandler->MaxUnits(), NULL);
+// writes the indices (relative to <objBeg>) of all objects whose bounding
+// spheres overlap the sphere <px, py, pz, pr> into <hits>; uses the same
+// predicate and operation order as CQuadField::GetUnitsAndFeaturesColVol
+// so the candidate sets are bit-identical to the per-projectile queries
+__FORCE_ALIGN_STACK__
+static unsigned int OverlapBoundingSpheres(
+	const float* xs,
+	const float* ys,
+	const float* zs,
+	const float* rs,
+	unsigned int numObjs,
+	float px,
+	float py,
+	float pz,
+	float pr,
+	unsigned int* hits
+) {
+	unsigned int numHits = 0;
+	unsigned int n = 0;
+
+	#ifndef DEDICATED_NOSSE
+	const __m128 vpx = _mm_set1_ps(px);
+	const __m128 vpy = _mm_set1_ps(py);
+	const __m128 vpz = _mm_set1_ps(pz);
+	const __m128 vpr = _mm_set1_ps(pr);
+
+	for (; (n + 4) <= numObjs; n += 4) {
+		const __m128 dx = _mm_sub_ps(vpx, _mm_loadu_ps(xs + n));
+		const __m128 dy = _mm_sub_ps(vpy, _mm_loadu_ps(ys + n));
+		const __m128 dz = _mm_sub_ps(vpz, _mm_loadu_ps(zs + n));
+		const __m128 tr = _mm_add_ps(vpr, _mm_loadu_ps(rs + n));
+		const __m128 sqDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		const int mask = _mm_movemask_ps(_mm_cmplt_ps(sqDist, _mm_mul_ps(tr, tr)));
+
+		if (mask == 0)
+			continue;
+
+		for (unsigned int k = 0; k < 4; k++) {
+			if (mask & (1 << k)) {
+				hits[numHits++] = n + k;
+			}
+		}
+	}
+	#endif
+
+	for (; n < numObjs; n++) {
+		const float dx = px - xs[n];
+		const float dy = py - ys[n];
+		const float dz = pz - zs[n];
+		const float tr = pr + rs[n];
+
+		if ((dx*dx + dy*dy + dz*dz) < (tr * tr)) {
+			hits[numHits++] = n;
+		}
+	}
+
+	return numHits;
+}
+
+void CProjectileHandler::CacheQuadColVols(int quadIdx)
+{
+	CollisionBatch& cb = colBatch;
+
+	if (cb.quadStamps[quadIdx] == cb.stamp)
+		return;
+
+	const CQuadField::Quad& quad = quadField->GetQuad(quadIdx);
+
+	cb.quadStamps[quadIdx] = cb.stamp;
+	cb.quadObjBegs[quadIdx] = cb.objects.size();
+	cb.quadNumUnits[quadIdx] = quad.units.size();
+	cb.quadNumObjs[quadIdx] = quad.units.size() + quad.features.size();
+
+	for (unsigned int n = 0; n < quad.units.size(); n++) {
+		CUnit* u = quad.units[n];
+		const float3 pos = u->collisionVolume->GetWorldSpacePos(u);
+
+		cb.objects.push_back(u);
+		cb.objPosX.push_back(pos.x);
+		cb.objPosY.push_back(pos.y);
+		cb.objPosZ.push_back(pos.z);
+		cb.objRadii.push_back(u->collisionVolume->GetBoundingRadius());
+	}
+
+	for (unsigned int n = 0; n < quad.features.size(); n++) {
+		CFeature* f = quad.features[n];
+		const float3 pos = f->collisionVolume->GetWorldSpacePos(f);
+
+		cb.objects.push_back(f);
+		cb.objPosX.push_back(pos.x);
+		cb.objPosY.push_back(pos.y);
+		cb.objPosZ.push_back(pos.z);
+		cb.objRadii.push_back(f->collisionVolume->GetBoundingRadius());
+	}
+}
+
+// forgets all cached quads; they are re-read from the
+// quad-field when the next projectile overlapping them
+// is tested
+void CProjectileHandler::InvalidateCollisionBatch()
+{
+	CollisionBatch& cb = colBatch;
+
+	cb.stamp += 1;
+
+	cb.objects.clear();
+	cb.objPosX.clear();
+	cb.objPosY.clear();
+	cb.objPosZ.clear();
+	cb.objRadii.clear();
+}
+
+void CProjectileHandler::GatherCollisionBatch(ProjectileContainer& pc)
+{
+	CollisionBatch& cb = colBatch;
+
+	const unsigned int numQuads = quadField->GetNumQuadsX() * quadField->GetNumQuadsZ();
+
+	// the quad-field can be resized at runtime
+	if (cb.quadStamps.size() != numQuads) {
+		cb.quadStamps.clear();
+		cb.quadStamps.resize(numQuads, cb.stamp);
+		cb.quadObjBegs.resize(numQuads, 0);
+		cb.quadNumUnits.resize(numQuads, 0);
+		cb.quadNumObjs.resize(numQuads, 0);
+		cb.tempQuads.resize(std::max(numQuads, CQuadField::NUM_TEMP_QUADS));
+	}
+
+	InvalidateCollisionBatch();
+
+	cb.projectiles.clear();
+	cb.projPosX.clear();
+	cb.projPosY.clear();
+	cb.projPosZ.clear();
+	cb.projRadii.clear();
+	cb.projQuads.clear();
+	cb.projQuadOffsets.clear();
+	cb.projQuadOffsets.push_back(0);
 
 	for (ProjectileContainer::iterator pci = pc.begin(); pci != pc.end(); ++pci) {
-		CProjectile* p = *pci;
+		AddToCollisionBatch(pci->first);
+	}
 
+	if (cb.tempUnits.size() != (unitHandler->MaxUnits() + 1)) {
+		cb.tempUnits.resize(unitHandler->MaxUnits() + 1, NULL);
+		cb.tempFeatures.resize(unitHandler->MaxUnits() + 1, NULL);
+	}
+}
+
+void CProjectileHandler::AddToCollisionBatch(CProjectile* p)
+{
+	CollisionBatch& cb = colBatch;
+
+	if (!p->checkCol) return;
+	if ( p->deleteMe) return;
+
+	const float radius = p->radius + p->speed.w;
+
+	int* begQuad = &cb.tempQuads[0];
+	int* endQuad = &cb.tempQuads[0];
+
+	quadField->GetQuads(p->pos, radius, begQuad, endQuad);
+
+	cb.projectiles.push_back(p);
+	cb.projPosX.push_back(p->pos.x);
+	cb.projPosY.push_back(p->pos.y);
+	cb.projPosZ.push_back(p->pos.z);
+	cb.projRadii.push_back(radius);
+	cb.projQuads.insert(cb.projQuads.end(), begQuad, endQuad);
+	cb.projQuadOffsets.push_back(cb.projQuads.size());
+}
+
+void CProjectileHandler::GetBatchColVols(unsigned int batchIdx)
+{
+	CollisionBatch& cb = colBatch;
+
+	const CProjectile* p = cb.projectiles[batchIdx];
+	const bool skipFeatures = ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0);
+
+	const int tempNum = gs->tempNum++;
+
+	// leave room for the end-of-list sentinels
+	const unsigned int maxUnits = cb.tempUnits.size() - 1;
+	const unsigned int maxFeatures = cb.tempFeatures.size() - 1;
+
+	unsigned int numUnits = 0;
+	unsigned int numFeatures = 0;
+
+	for (unsigned int i = cb.projQuadOffsets[batchIdx]; i < cb.projQuadOffsets[batchIdx + 1]; i++) {
+		const int quadIdx = cb.projQuads[i];
+
+		CacheQuadColVols(quadIdx);
+
+		const unsigned int objBeg = cb.quadObjBegs[quadIdx];
+		const unsigned int numObjs = skipFeatures? cb.quadNumUnits[quadIdx]: cb.quadNumObjs[quadIdx];
+
+		if (numObjs == 0)
+			continue;
+		if (cb.tempHits.size() < numObjs)
+			cb.tempHits.resize(numObjs);
+
+		const unsigned int numHits = OverlapBoundingSpheres(
+			&cb.objPosX[objBeg],
+			&cb.objPosY[objBeg],
+			&cb.objPosZ[objBeg],
+			&cb.objRadii[objBeg],
+			numObjs,
+			cb.projPosX[batchIdx],
+			cb.projPosY[batchIdx],
+			cb.projPosZ[batchIdx],
+			cb.projRadii[batchIdx],
+			&cb.tempHits[0]
+		);
+
+		for (unsigned int h = 0; h < numHits; h++) {
+			const unsigned int objIdx = cb.tempHits[h];
+			CSolidObject* o = cb.objects[objBeg + objIdx];
+
+			// prevent double adding (objects can span multiple quads)
+			if (o->tempNum == tempNum)
+				continue;
+
+			if (objIdx < cb.quadNumUnits[quadIdx]) {
+				if (numUnits < maxUnits) {
+					o->tempNum = tempNum;
+					cb.tempUnits[numUnits++] = static_cast<CUnit*>(o);
+				}
+			} else {
+				if (numFeatures < maxFeatures) {
+					o->tempNum = tempNum;
+					cb.tempFeatures[numFeatures++] = static_cast<CFeature*>(o);
+				}
+			}
+		}
+	}
+
+	// set end-of-list sentinels
+	cb.tempUnits[numUnits] = NULL;
+	cb.tempFeatures[numFeatures] = NULL;
+}
+
+void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc) {
+	// broadphase: collect all projectile spheres and the quads they
+	// overlap up front; the collision volumes in each quad are cached
+	// on first use
+	GatherCollisionBatch(pc);
+
+	// narrowphase: strictly sequential and in container order, since
+	// collisions change state that later projectiles can observe; new
+	// projectiles are appended by AddProjectile while this runs
+	colBatch.container = &pc;
+
+	for (unsigned int n = 0; n < colBatch.projectiles.size(); n++) {
+		CProjectile* p = colBatch.projectiles[n];
+
+		// an earlier collision might have killed this projectile
 		if (!p->checkCol) continue;
 		if ( p->deleteMe) continue;
 
 		const float3 ppos0 = p->pos;
 		const float3 ppos1 = p->pos + p->speed;
 
-		quadField->GetUnitsAndFeaturesColVol(p->pos, p->radius + p->speed.w, tempUnits, tempFeatures);
+		GetBatchColVols(n);
 
-		CheckUnitCollisions(p, tempUnits, ppos0, ppos1);
-		CheckFeatureCollisions(p, tempFeatures, ppos0, ppos1);
+		bool collided = false;
+
+		collided |= CheckUnitCollisions(p, colBatch.tempUnits, ppos0, ppos1);
+		collided |= CheckFeatureCollisions(p, colBatch.tempFeatures, ppos0, ppos1);
+
+		// an impact can kill, spawn or push (impulse) objects, so
+		// the cached volumes are no longer valid after it
+		if (collided) {
+			InvalidateCollisionBatch();
+		}
 	}
+
+	colBatch.container = NULL;
 }
 
 void CProjectileHandler::CheckGroundCollisions(ProjectileContainer& pc) {
 	ProjectileContainer::iterator pci;
 
 	for (pci = pc.begin(); pci != pc.end(); ++pci) {
-		CProjectile* p = *pci;
+		CProjectile* p = pci->first;
 
 		if (!p->checkCol)
 			continue;
@@ -12,6 +12,7 @@
 
 #include "Sim/Projectiles/ProjectileFunctors.h"
 #include "System/float3.h"
+#include "System/SlotMap.h"
 #include "System/Platform/Threading.h"
 
 // bypass id and event handling for unsynced projectiles (faster)
@@ -20,6 +21,7 @@
 class CProjectile;
 class CUnit;
 class CFeature;
+class CSolidObject;
 class CGroundFlash;
 struct UnitDef;
 struct FlyingPiece;
@@ -29,11 +31,14 @@ struct SS3OVertex;
 
 
 
+// <projectile, allyteam of its owner at creation>
 typedef std::pair<CProjectile*, int> ProjectileMapValPair;
-typedef std::pair<int, ProjectileMapValPair> ProjectileMapKeyPair;
+
+// projectile ID ==> <projectile, allyteam> for the render thread
 typedef std::map<int, ProjectileMapValPair> ProjectileMap;
 
-typedef ThreadListSim<std::list<CProjectile*>, std::set<CProjectile*>, CProjectile*, ProjectileDetacher> ProjectileContainer;
+// projectile ID ==> <projectile, allyteam>; also the update-order container
+typedef SlotMap<ProjectileMapValPair> ProjectileContainer;
 typedef ThreadListSimRender<std::list<CGroundFlash*>, std::set<CGroundFlash*>, CGroundFlash*> GroundFlashContainer;
 
 typedef ThreadListSimRender<std::set<FlyingPiece*, FlyingPieceComparator>, void, FlyingPiece*> FlyingPieceContainer;
@@ -51,34 +56,23 @@ public:
 	void Serialize(creg::ISerializer* s);
 	void PostLoad();
 
+	// NOTE: the returned pointer is invalidated by adding or removing projectiles
 	inline const ProjectileMapValPair* GetMapPairBySyncedID(int id) const {
-		const ProjectileMap& projectileIDs = syncedProjectileIDs;
-		const ProjectileMap::const_iterator it = projectileIDs.find(id);
-
-		if (it == projectileIDs.end())
-			return NULL;
-
-		return &(it->second);
+		return (syncedProjectiles.find(id));
 	}
 
 	inline const ProjectileMapValPair* GetMapPairByUnsyncedID(int id) const {
 		if (UNSYNCED_PROJ_NOEVENT)
 			return NULL; // unsynced projectiles have no IDs if UNSYNCED_PROJ_NOEVENT
 
-		const ProjectileMap& projectileIDs = unsyncedProjectileIDs;
-		const ProjectileMap::const_iterator it = projectileIDs.find(id);
-
-		if (it == projectileIDs.end())
-			return NULL;
-
-		return &(it->second);
+		return (unsyncedProjectiles.find(id));
 	}
 
 	ProjectileRenderMap& GetSyncedRenderProjectileIDs() { return syncedRenderProjectileIDs; }
 	ProjectileRenderMap& GetUnsyncedRenderProjectileIDs() { return unsyncedRenderProjectileIDs; }
 
-	void CheckUnitCollisions(CProjectile*, std::vector<CUnit*>&, const float3&, const float3&);
-	void CheckFeatureCollisions(CProjectile*, std::vector<CFeature*>&, const float3&, const float3&);
+	bool CheckUnitCollisions(CProjectile*, std::vector<CUnit*>&, const float3&, const float3&);
+	bool CheckFeatureCollisions(CProjectile*, std::vector<CFeature*>&, const float3&, const float3&);
 	void CheckUnitFeatureCollisions(ProjectileContainer&);
 	void CheckGroundCollisions(ProjectileContainer&);
 	void CheckCollisions();
@@ -115,15 +109,60 @@ public:
 private:
 	void UpdateProjectileContainer(ProjectileContainer&, bool);
 
-	ProjectileRenderMap syncedRenderProjectileIDs;        // same as syncedProjectileIDs, used by render thread
-	ProjectileRenderMap unsyncedRenderProjectileIDs;      // same as unsyncedProjectileIDs, used by render thread
-
-	int maxUsedSyncedID;
-	int maxUsedUnsyncedID;
-	std::list<int> freeSyncedIDs;             // available synced (weapon, piece) projectile ID's
-	std::list<int> freeUnsyncedIDs;           // available unsynced projectile ID's
-	ProjectileMap syncedProjectileIDs;        // ID ==> <projectile, allyteam> map for living synced projectiles
-	ProjectileMap unsyncedProjectileIDs;      // ID ==> <projectile, allyteam> map for living unsynced projectiles
+	void GatherCollisionBatch(ProjectileContainer&);
+	void AddToCollisionBatch(CProjectile*);
+	void InvalidateCollisionBatch();
+	void CacheQuadColVols(int quadIdx);
+	void GetBatchColVols(unsigned int batchIdx);
+
+	/**
+	 * Broadphase state for CheckUnitFeatureCollisions, rebuilt per container
+	 * per frame. The collision-volume bounding spheres of all units/features
+	 * in a quad are copied into SoA arrays the first time a projectile that
+	 * overlaps it is tested, and tested four at a time against the swept
+	 * sphere of each projectile; only the survivors are passed on to
+	 * CCollisionHandler. Every impact drops the cached quads, so the spheres
+	 * seen by a projectile are never older than the last collision.
+	 * Projectiles added to the container during the pass are appended to
+	 * the batch and tested in the same pass, after all others.
+	 */
+	struct CollisionBatch {
+		// container of the pass in progress, NULL outside of it
+		const ProjectileContainer* container;
+
+		// projectiles with checkCol set, in container order
+		// followed by those created during the pass
+		std::vector<CProjectile*> projectiles;
+		std::vector<float> projPosX, projPosY, projPosZ, projRadii;
+		// quads overlapped by projectiles[i] are in
+		// projQuads[projQuadOffsets[i], projQuadOffsets[i + 1])
+		std::vector<int> projQuads;
+		std::vector<unsigned int> projQuadOffsets;
+
+		// per quad: batch-stamp at which it was cached, first object index,
+		// number of units (features follow them), total number of objects
+		std::vector<int> quadStamps;
+		std::vector<unsigned int> quadObjBegs;
+		std::vector<unsigned int> quadNumUnits;
+		std::vector<unsigned int> quadNumObjs;
+
+		std::vector<CSolidObject*> objects;
+		std::vector<float> objPosX, objPosY, objPosZ, objRadii;
+
+		std::vector<int> tempQuads;
+		std::vector<unsigned int> tempHits;
+		std::vector<CUnit*> tempUnits;
+		std::vector<CFeature*> tempFeatures;
+
+		int stamp;
+	};
+
+	CollisionBatch colBatch;
+
+	ProjectileRenderMap syncedRenderProjectileIDs;        // same as syncedProjectiles, used by render thread
+	ProjectileRenderMap unsyncedRenderProjectileIDs;      // same as unsyncedProjectiles, used by render thread
+
+	std::vector<CProjectile*> deletedSyncedProjectiles;   // removed this frame, deleted after eventHandler.DeleteSyncedProjectiles
 };
 
 
@@ -78,7 +78,7 @@ void CGeoThermSmokeProjectile::UpdateDir()
 void CGeoThermSmokeProjectile::GeoThermDestroyed(const CFeature* geo)
 {
 	for (ProjectileContainer::iterator it = projectileHandler->unsyncedProjectiles.begin(); it != projectileHandler->unsyncedProjectiles.end(); ++it) {
-		CGeoThermSmokeProjectile* geoPuff = dynamic_cast<CGeoThermSmokeProjectile*>(*it);
+		CGeoThermSmokeProjectile* geoPuff = dynamic_cast<CGeoThermSmokeProjectile*>(it->first);
 
 		if (geoPuff == NULL)
 			continue;
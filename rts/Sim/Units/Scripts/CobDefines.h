@@ -92,7 +92,7 @@
 #define SONAR_STEALTH            108 // set or get
 #define REVERSING                109 // get
 
-// NOTE: [LUA0 - LUA9] are defined in CobThread.cpp as [110 - 119]
+// NOTE: [LUA0 - LUA9] are defined in CobProgram.h as [110 - 119]
 
 #define FLANK_B_MODE             120 // set or get
 #define FLANK_B_DIR              121 // set or get, set is through get for multiple args
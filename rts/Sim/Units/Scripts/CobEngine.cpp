@@ -48,10 +48,12 @@ CCobEngine::~CCobEngine()
 			wantToRun.pop_front();
 			delete tmp;
 		}
-		while (!sleeping.empty()) {
-			CCobThread* tmp = sleeping.top();
-			sleeping.pop();
-			delete tmp;
+		if (!sleeping.empty()) {
+			std::vector<CCobThread*> tmp;
+			sleeping.clear(tmp);
+			for (std::vector<CCobThread*>::iterator i = tmp.begin(); i != tmp.end(); ++i) {
+				delete *i;
+			}
 		}
 		// callbacks may add new threads
 	} while (!running.empty() || !wantToRun.empty() || !sleeping.empty());
@@ -75,7 +77,7 @@ void CCobEngine::AddThread(CCobThread *thread)
 			wantToRun.push_front(thread);
 			break;
 		case CCobThread::Sleep:
-			sleeping.push(thread);
+			sleeping.insert(thread, thread->GetWakeTime());
 			break;
 		default:
 			LOG_L(L_ERROR, "thread added to scheduler with unknown state (%d)", thread->state);
@@ -103,6 +105,8 @@ void CCobEngine::Tick(int deltaTime)
 
 	LOG_L(L_DEBUG, "----");
 
+	stats.numRunning = running.size();
+
 	// Advance all running threads
 	for (std::list<CCobThread*>::iterator i = running.begin(); i != running.end(); ++i) {
 		//LOG_L(L_DEBUG, "Now 1running %d: %s", GCurrentTime, (*i)->GetName().c_str());
@@ -126,34 +130,31 @@ void CCobEngine::Tick(int deltaTime)
 	wantToRun.clear();
 
 	//Check on the sleeping threads
-	if (!sleeping.empty()) {
-		CCobThread* cur = sleeping.top();
+	wokenThreads.clear();
+	sleeping.advance(GCurrentTime, wokenThreads);
 
-		while ((cur != NULL) && (cur->GetWakeTime() < GCurrentTime)) {
-			// Start with removing the executing thread from the queue
-			sleeping.pop();
+	for (std::vector<CCobThread*>::iterator i = wokenThreads.begin(); i != wokenThreads.end(); ++i) {
+		CCobThread* cur = *i;
 
-			//Run forward again. This can quite possibly readd the thread to the sleeping array again
-			//But it will not interfere since it is guaranteed to sleep > 0 ms
-			//LOG_L(L_DEBUG, "Now 2running %d: %s", GCurrentTime, cur->GetName().c_str());
+		//Run forward again. This can quite possibly readd the thread to the sleeping threads again
+		//But it will not wake up before the next tick since it is guaranteed to sleep >= 0 ms
+		//(threads sleeping for a negative time wake up in the next tick as well)
+		//LOG_L(L_DEBUG, "Now 2running %d: %s", GCurrentTime, cur->GetName().c_str());
 #ifdef _CONSOLE
-			printf("+++\n");
+		printf("+++\n");
 #endif
-			if (cur->state == CCobThread::Sleep) {
-				cur->state = CCobThread::Run;
-				TickThread(cur);
-			} else if (cur->state == CCobThread::Dead) {
-				delete cur;
-			} else {
-				LOG_L(L_ERROR, "Sleeping thread strange state %d", cur->state);
-			}
-
-			if (!sleeping.empty())
-				cur = sleeping.top();
-			else
-				cur = NULL;
+		if (cur->state == CCobThread::Sleep) {
+			cur->state = CCobThread::Run;
+			TickThread(cur);
+		} else if (cur->state == CCobThread::Dead) {
+			delete cur;
+		} else {
+			LOG_L(L_ERROR, "Sleeping thread strange state %d", cur->state);
 		}
 	}
+
+	stats.numWoken = wokenThreads.size();
+	stats.numSleeping = sleeping.size();
 }
 
 
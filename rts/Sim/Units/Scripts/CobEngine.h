@@ -10,26 +10,32 @@
  */
 
 #include "CobThread.h"
+#include "System/TimerWheel.h"
 
 #include <list>
-#include <queue>
 #include <map>
+#include <vector>
 
 class CCobThread;
 class CCobInstance;
 class CCobFile;
 
 
-class CCobThreadPtr_less : public std::binary_function<CCobThread*, CCobThread*, bool> {
+class CCobEngine
+{
 public:
-	bool operator() (const CCobThread* const& a, const CCobThread* const& b) const {
-		return a->GetWakeTime() > b->GetWakeTime();
-	}
-};
+	/// thread counts of the last Tick
+	struct Stats {
+		Stats(): numRunning(0), numSleeping(0), numWoken(0) {}
 
+		/// threads that ran because they were started or resumed after an animation
+		unsigned int numRunning;
+		/// threads sleeping after the tick
+		unsigned int numSleeping;
+		/// sleeping threads woken up and run
+		unsigned int numWoken;
+	};
 
-class CCobEngine
-{
 protected:
 	std::list<CCobThread*> running;
 	/**
@@ -37,8 +43,11 @@ protected:
 	 * And moved to real running after running is empty.
 	 */
 	std::list<CCobThread*> wantToRun;
-	std::priority_queue<CCobThread*, std::vector<CCobThread*>, CCobThreadPtr_less> sleeping;
+	/// keyed by wake time; threads with equal times wake up in the order they fell asleep
+	TimerWheel<CCobThread*> sleeping;
+	std::vector<CCobThread*> wokenThreads;
 	CCobThread* curThread;
+	Stats stats;
 	void TickThread(CCobThread* thread);
 public:
 	CCobEngine();
@@ -46,6 +55,7 @@ public:
 	void AddThread(CCobThread* thread);
 	void Tick(int deltaTime);
 	void ShowScriptError(const std::string& msg);
+	const Stats& GetStats() const { return stats; }
 };
 
 
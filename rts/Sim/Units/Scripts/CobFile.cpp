@@ -147,14 +147,15 @@ CCobFile::CCobFile(CFileHandler &in, string name)
 		pieceNames.push_back(s);
 	}
 
-	int code_octets = size - ch.OffsetToScriptCode;
-	int code_ints = (code_octets) / 4 + 4;
-	code = new int[code_ints];
-	memcpy(code, &cobdata[ch.OffsetToScriptCode], code_octets);
-	for (int i = 0; i < code_ints; i++) {
+	const int codeSize = std::max(0, (size - ch.OffsetToScriptCode) / 4);
+	std::vector<int> code(codeSize);
+	for (int i = 0; i < codeSize; i++) {
+		memcpy(&code[i], &cobdata[ch.OffsetToScriptCode + i * 4], 4);
 		swabDWordInPlace(code[i]);
 	}
 
+	program.Translate(code, scriptOffsets, scriptLengths, scriptNames);
+
 	numStaticVars = ch.NumberOfStaticVars;
 
 	// If this is a TA:K script, read the sound names
@@ -194,12 +195,19 @@ CCobFile::CCobFile(CFileHandler &in, string name)
 			scriptIndex[it->second] = fn;
 		}
 	}
+
+	showsFlare.resize(scriptNames.size(), false);
+	for (int i = 0; i < MAX_WEAPONS_PER_UNIT; ++i) {
+		const int fn = scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i];
+		if (fn >= 0) {
+			showsFlare[fn] = true;
+		}
+	}
 }
 
 
 CCobFile::~CCobFile()
 {
-	delete[] code;
 }
 
 
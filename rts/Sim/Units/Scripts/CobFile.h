@@ -9,6 +9,7 @@
 
 #include "Lua/LuaHashString.h"
 #include "CobScriptNames.h"
+#include "CobProgram.h"
 
 class CFileHandler;
 
@@ -30,7 +31,9 @@ public:
 	std::vector<int> sounds;
 	std::map<std::string, int> scriptMap;
 	std::vector<LuaHashString> luaScripts;
-	int* code;
+	/// whether SHOW in each script shows a muzzle flare, ie. it is a Fire-script
+	std::vector<bool> showsFlare;
+	CCobProgram program;
 	int numStaticVars;
 	std::string name;
 };
@@ -0,0 +1,492 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "CobProgram.h"
+
+#include <algorithm>
+
+
+// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
+// And some information from basm0.8 source (basm ops.txt)
+
+// Model interaction
+static const int MOVE       = 0x10001000;
+static const int TURN       = 0x10002000;
+static const int SPIN       = 0x10003000;
+static const int STOP_SPIN  = 0x10004000;
+static const int SHOW       = 0x10005000;
+static const int HIDE       = 0x10006000;
+static const int CACHE      = 0x10007000;
+static const int DONT_CACHE = 0x10008000;
+static const int MOVE_NOW   = 0x1000B000;
+static const int TURN_NOW   = 0x1000C000;
+static const int SHADE      = 0x1000D000;
+static const int DONT_SHADE = 0x1000E000;
+static const int EMIT_SFX   = 0x1000F000;
+
+// Blocking operations
+static const int WAIT_TURN  = 0x10011000;
+static const int WAIT_MOVE  = 0x10012000;
+static const int SLEEP      = 0x10013000;
+
+// Stack manipulation
+static const int PUSH_CONSTANT    = 0x10021001;
+static const int PUSH_LOCAL_VAR   = 0x10021002;
+static const int PUSH_STATIC      = 0x10021004;
+static const int CREATE_LOCAL_VAR = 0x10022000;
+static const int POP_LOCAL_VAR    = 0x10023002;
+static const int POP_STATIC       = 0x10023004;
+static const int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
+
+// Arithmetic operations
+static const int ADD         = 0x10031000;
+static const int SUB         = 0x10032000;
+static const int MUL         = 0x10033000;
+static const int DIV         = 0x10034000;
+static const int MOD         = 0x10034001; ///< spring specific
+static const int BITWISE_AND = 0x10035000;
+static const int BITWISE_OR  = 0x10036000;
+static const int BITWISE_XOR = 0x10037000;
+static const int BITWISE_NOT = 0x10038000;
+
+// Native function calls
+static const int RAND           = 0x10041000;
+static const int GET_UNIT_VALUE = 0x10042000;
+static const int GET            = 0x10043000;
+
+// Comparison
+static const int SET_LESS             = 0x10051000;
+static const int SET_LESS_OR_EQUAL    = 0x10052000;
+static const int SET_GREATER          = 0x10053000;
+static const int SET_GREATER_OR_EQUAL = 0x10054000;
+static const int SET_EQUAL            = 0x10055000;
+static const int SET_NOT_EQUAL        = 0x10056000;
+static const int LOGICAL_AND          = 0x10057000;
+static const int LOGICAL_OR           = 0x10058000;
+static const int LOGICAL_XOR          = 0x10059000;
+static const int LOGICAL_NOT          = 0x1005A000;
+
+// Flow control
+static const int START           = 0x10061000;
+static const int CALL            = 0x10062000;
+static const int REAL_CALL       = 0x10062001; ///< spring custom
+static const int LUA_CALL        = 0x10062002; ///< spring custom
+static const int JUMP            = 0x10064000;
+static const int RETURN          = 0x10065000;
+static const int JUMP_NOT_EQUAL  = 0x10066000;
+static const int SIGNAL          = 0x10067000;
+static const int SET_SIGNAL_MASK = 0x10068000;
+
+// Piece destruction
+static const int EXPLODE    = 0x10071000;
+static const int PLAY_SOUND = 0x10072000;
+
+// Special functions
+static const int SET    = 0x10082000;
+static const int ATTACH = 0x10083000;
+static const int DROP   = 0x10084000;
+
+
+static const char* opcodeNames[COBOP_COUNT] = {
+#define COB_OPCODE_NAME(name) #name,
+	COB_OPCODES(COB_OPCODE_NAME)
+#undef COB_OPCODE_NAME
+};
+
+
+void CCobProgram::Translate(
+	const std::vector<int>& code,
+	const std::vector<int>& scriptOffsets,
+	const std::vector<int>& scriptLengths,
+	const std::vector<std::string>& scriptNames
+) {
+	const int codeSize = code.size();
+
+	instructions.clear();
+	codeOffsets.clear();
+	scriptEntries.clear();
+	offsetIndex.clear();
+	offsetIndex.resize(codeSize + 1, -1);
+	invalidTargets.clear();
+
+	// decode every script up to the start of the next one; the code after
+	// the last one is padding which the raw interpreter would have run into
+	std::vector<int> scriptStarts(scriptOffsets);
+	std::sort(scriptStarts.begin(), scriptStarts.end());
+	scriptStarts.erase(std::unique(scriptStarts.begin(), scriptStarts.end()), scriptStarts.end());
+	scriptStarts.push_back(codeSize);
+
+	std::vector<RawInstruction> rawCode;
+	std::vector<bool> isTarget(codeSize + 1, false);
+
+	for (size_t n = 0; n + 1 < scriptStarts.size(); n++) {
+		const int start = std::max(scriptStarts[n], 0);
+		const int end = std::min(scriptStarts[n + 1], codeSize);
+
+		if (start >= end)
+			continue;
+
+		int offset = start;
+
+		while (offset < end) {
+			const int numOperands = GetNumOperands(code[offset]);
+
+			// an unknown word fails once executed; keep decoding after it,
+			// the code that follows can still be reached by jumps
+			if (numOperands < 0) {
+				const RawInstruction raw = {offset, code[offset], 0, 0};
+				rawCode.push_back(raw);
+				offset += 1;
+				continue;
+			}
+
+			if ((offset + numOperands) >= codeSize)
+				break;
+
+			const RawInstruction raw = {
+				offset,
+				code[offset],
+				(numOperands > 0)? code[offset + 1]: 0,
+				(numOperands > 1)? code[offset + 2]: 0,
+			};
+
+			if (raw.opcode == JUMP || raw.opcode == JUMP_NOT_EQUAL) {
+				if (raw.arg1 >= 0 && raw.arg1 < codeSize) {
+					isTarget[raw.arg1] = true;
+				}
+			}
+
+			rawCode.push_back(raw);
+			offset += (1 + numOperands);
+		}
+
+		// execution can not continue into the next script if decoding stopped
+		// early or overran its start, nor past the end of the code
+		if (offset != end || end == codeSize) {
+			const RawInstruction raw = {offset, 0, 0, 0};
+			rawCode.push_back(raw);
+		}
+	}
+
+	for (size_t n = 0; n < scriptOffsets.size(); n++) {
+		if (scriptOffsets[n] >= 0 && scriptOffsets[n] < codeSize) {
+			isTarget[scriptOffsets[n]] = true;
+		}
+	}
+
+	instructions.reserve(rawCode.size());
+	codeOffsets.reserve(rawCode.size());
+
+	for (size_t n = 0; n < rawCode.size(); n++) {
+		const RawInstruction& raw = rawCode[n];
+
+		if (raw.offset <= codeSize) {
+			offsetIndex[raw.offset] = instructions.size();
+		}
+
+		if (GetNumOperands(raw.opcode) < 0) {
+			EmitInvalid(code, raw.offset);
+			continue;
+		}
+
+		// get-unit-value with a constant index, unless something jumps to the
+		// get-unit-value itself
+		if (raw.opcode == PUSH_CONSTANT && (n + 1) < rawCode.size()) {
+			const RawInstruction& next = rawCode[n + 1];
+
+			if (next.opcode == GET_UNIT_VALUE && next.offset == (raw.offset + 2) && !isTarget[next.offset]) {
+				CobInstruction ins = {COBOP_GET_UNIT_VALUE_CONST, raw.arg1, 0};
+
+				if (raw.arg1 >= LUA0 && raw.arg1 <= LUA9) {
+					ins.opcode = COBOP_GET_LUA_ARG;
+					ins.arg1 = raw.arg1 - LUA0;
+				}
+
+				instructions.push_back(ins);
+				codeOffsets.push_back(raw.offset);
+				n++;
+				continue;
+			}
+		}
+
+		Emit(raw, scriptLengths, scriptNames);
+	}
+
+	// jumps can still land inside a decoded instruction (or an unknown
+	// word's supposed operands); the raw interpreter would simply have
+	// decoded from there, so do the same
+	std::vector<int> pendingTargets;
+
+	for (size_t n = 0; n < rawCode.size(); n++) {
+		const RawInstruction& raw = rawCode[n];
+
+		if (raw.opcode == JUMP || raw.opcode == JUMP_NOT_EQUAL) {
+			pendingTargets.push_back(raw.arg1);
+		}
+	}
+
+	while (!pendingTargets.empty()) {
+		const int target = pendingTargets.back();
+		pendingTargets.pop_back();
+
+		if (target < 0 || target >= codeSize || offsetIndex[target] >= 0)
+			continue;
+
+		DecodeFrom(code, target, scriptLengths, scriptNames, pendingTargets);
+	}
+
+	// resolve jumps and script entry points, now that all offsets are known
+	const int numDecoded = instructions.size();
+
+	for (int pc = 0; pc < numDecoded; pc++) {
+		const int opcode = instructions[pc].opcode;
+
+		// (resolving may append to instructions)
+		if (opcode == COBOP_JUMP || opcode == COBOP_JUMP_NOT_EQUAL) {
+			const int target = ResolveOffset(code, instructions[pc].arg1);
+			instructions[pc].arg1 = target;
+		}
+	}
+
+	scriptEntries.reserve(scriptOffsets.size());
+
+	for (size_t n = 0; n < scriptOffsets.size(); n++) {
+		scriptEntries.push_back(ResolveOffset(code, scriptOffsets[n]));
+	}
+
+	// only needed while translating
+	std::vector<int>().swap(offsetIndex);
+	invalidTargets.clear();
+}
+
+
+void CCobProgram::Emit(const RawInstruction& raw, const std::vector<int>& scriptLengths, const std::vector<std::string>& scriptNames)
+{
+	CobInstruction ins = {COBOP_INVALID, raw.arg1, raw.arg2};
+
+	switch (raw.opcode) {
+		case MOVE:                 { ins.opcode = COBOP_MOVE;                 } break;
+		case TURN:                 { ins.opcode = COBOP_TURN;                 } break;
+		case SPIN:                 { ins.opcode = COBOP_SPIN;                 } break;
+		case STOP_SPIN:            { ins.opcode = COBOP_STOP_SPIN;            } break;
+		case SHOW:                 { ins.opcode = COBOP_SHOW;                 } break;
+		case HIDE:                 { ins.opcode = COBOP_HIDE;                 } break;
+		case CACHE:                { ins.opcode = COBOP_NOP;                  } break;
+		case DONT_CACHE:           { ins.opcode = COBOP_NOP;                  } break;
+		case MOVE_NOW:             { ins.opcode = COBOP_MOVE_NOW;             } break;
+		case TURN_NOW:             { ins.opcode = COBOP_TURN_NOW;             } break;
+		case SHADE:                { ins.opcode = COBOP_NOP;                  } break;
+		case DONT_SHADE:           { ins.opcode = COBOP_NOP;                  } break;
+		case EMIT_SFX:             { ins.opcode = COBOP_EMIT_SFX;             } break;
+
+		case WAIT_TURN:            { ins.opcode = COBOP_WAIT_TURN;            } break;
+		case WAIT_MOVE:            { ins.opcode = COBOP_WAIT_MOVE;            } break;
+		case SLEEP:                { ins.opcode = COBOP_SLEEP;                } break;
+
+		case PUSH_CONSTANT:        { ins.opcode = COBOP_PUSH_CONSTANT;        } break;
+		case PUSH_LOCAL_VAR:       { ins.opcode = COBOP_PUSH_LOCAL_VAR;       } break;
+		case PUSH_STATIC:          { ins.opcode = COBOP_PUSH_STATIC;          } break;
+		case CREATE_LOCAL_VAR:     { ins.opcode = COBOP_CREATE_LOCAL_VAR;     } break;
+		case POP_LOCAL_VAR:        { ins.opcode = COBOP_POP_LOCAL_VAR;        } break;
+		case POP_STATIC:           { ins.opcode = COBOP_POP_STATIC;           } break;
+		case POP_STACK:            { ins.opcode = COBOP_POP_STACK;            } break;
+
+		case ADD:                  { ins.opcode = COBOP_ADD;                  } break;
+		case SUB:                  { ins.opcode = COBOP_SUB;                  } break;
+		case MUL:                  { ins.opcode = COBOP_MUL;                  } break;
+		case DIV:                  { ins.opcode = COBOP_DIV;                  } break;
+		case MOD:                  { ins.opcode = COBOP_MOD;                  } break;
+		case BITWISE_AND:          { ins.opcode = COBOP_BITWISE_AND;          } break;
+		case BITWISE_OR:           { ins.opcode = COBOP_BITWISE_OR;           } break;
+		case BITWISE_XOR:          { ins.opcode = COBOP_BITWISE_XOR;          } break;
+		case BITWISE_NOT:          { ins.opcode = COBOP_BITWISE_NOT;          } break;
+
+		case RAND:                 { ins.opcode = COBOP_RAND;                 } break;
+		case GET_UNIT_VALUE:       { ins.opcode = COBOP_GET_UNIT_VALUE;       } break;
+		case GET:                  { ins.opcode = COBOP_GET;                  } break;
+
+		case SET_LESS:             { ins.opcode = COBOP_SET_LESS;             } break;
+		case SET_LESS_OR_EQUAL:    { ins.opcode = COBOP_SET_LESS_OR_EQUAL;    } break;
+		case SET_GREATER:          { ins.opcode = COBOP_SET_GREATER;          } break;
+		case SET_GREATER_OR_EQUAL: { ins.opcode = COBOP_SET_GREATER_OR_EQUAL; } break;
+		case SET_EQUAL:            { ins.opcode = COBOP_SET_EQUAL;            } break;
+		case SET_NOT_EQUAL:        { ins.opcode = COBOP_SET_NOT_EQUAL;        } break;
+		case LOGICAL_AND:          { ins.opcode = COBOP_LOGICAL_AND;          } break;
+		case LOGICAL_OR:           { ins.opcode = COBOP_LOGICAL_OR;           } break;
+		case LOGICAL_XOR:          { ins.opcode = COBOP_LOGICAL_XOR;          } break;
+		case LOGICAL_NOT:          { ins.opcode = COBOP_LOGICAL_NOT;          } break;
+
+		case JUMP:                 { ins.opcode = COBOP_JUMP;                 } break;
+		case RETURN:               { ins.opcode = COBOP_RETURN;               } break;
+		case JUMP_NOT_EQUAL:       { ins.opcode = COBOP_JUMP_NOT_EQUAL;       } break;
+		case SIGNAL:               { ins.opcode = COBOP_SIGNAL;               } break;
+		case SET_SIGNAL_MASK:      { ins.opcode = COBOP_SET_SIGNAL_MASK;      } break;
+
+		case EXPLODE:              { ins.opcode = COBOP_EXPLODE;              } break;
+		case PLAY_SOUND:           { ins.opcode = COBOP_PLAY_SOUND;           } break;
+
+		case SET:                  { ins.opcode = COBOP_SET;                  } break;
+		case ATTACH:               { ins.opcode = COBOP_ATTACH;               } break;
+		case DROP:                 { ins.opcode = COBOP_DROP;                 } break;
+
+		case START:
+		case CALL:
+		case REAL_CALL:
+		case LUA_CALL: {
+			const int functionId = raw.arg1;
+
+			if (functionId < 0 || size_t(functionId) >= scriptNames.size()) {
+				ins.arg1 = raw.opcode;
+				break;
+			}
+
+			if (raw.opcode == LUA_CALL || (raw.opcode == CALL && scriptNames[functionId].find("lua_") == 0)) {
+				ins.opcode = COBOP_LUA_CALL;
+				break;
+			}
+
+			// starting or calling an empty script does nothing, not even
+			// popping its arguments
+			if (scriptLengths[functionId] == 0) {
+				ins.opcode = COBOP_NOP;
+				break;
+			}
+
+			ins.opcode = (raw.opcode == START)? COBOP_START: COBOP_CALL;
+		} break;
+	}
+
+	instructions.push_back(ins);
+	codeOffsets.push_back(raw.offset);
+}
+
+
+void CCobProgram::DecodeFrom(
+	const std::vector<int>& code,
+	int offset,
+	const std::vector<int>& scriptLengths,
+	const std::vector<std::string>& scriptNames,
+	std::vector<int>& pendingTargets
+) {
+	const int codeSize = code.size();
+
+	while (offset < codeSize) {
+		// rejoin the instructions decoded before
+		if (offsetIndex[offset] >= 0) {
+			const CobInstruction ins = {COBOP_JUMP, offset, 0};
+
+			instructions.push_back(ins);
+			codeOffsets.push_back(offset);
+			return;
+		}
+
+		const int numOperands = GetNumOperands(code[offset]);
+
+		offsetIndex[offset] = instructions.size();
+
+		if (numOperands < 0 || (offset + numOperands) >= codeSize) {
+			EmitInvalid(code, offset);
+			return;
+		}
+
+		const RawInstruction raw = {
+			offset,
+			code[offset],
+			(numOperands > 0)? code[offset + 1]: 0,
+			(numOperands > 1)? code[offset + 2]: 0,
+		};
+
+		if (raw.opcode == JUMP || raw.opcode == JUMP_NOT_EQUAL) {
+			pendingTargets.push_back(raw.arg1);
+		}
+
+		Emit(raw, scriptLengths, scriptNames);
+		offset += (1 + numOperands);
+	}
+
+	// ran off the end of the code
+	offsetIndex[offset] = instructions.size();
+	EmitInvalid(code, offset);
+}
+
+
+void CCobProgram::EmitInvalid(const std::vector<int>& code, int offset)
+{
+	const CobInstruction ins = {COBOP_INVALID, (offset >= 0 && size_t(offset) < code.size())? code[offset]: 0, 0};
+
+	instructions.push_back(ins);
+	codeOffsets.push_back(offset);
+}
+
+
+int CCobProgram::ResolveOffset(const std::vector<int>& code, int offset)
+{
+	if (offset >= 0 && size_t(offset) < offsetIndex.size() && offsetIndex[offset] >= 0)
+		return offsetIndex[offset];
+
+	// a jump (or script offset) outside the code; it fails once
+	// executed, not at load
+	const std::map<int, int>::const_iterator it = invalidTargets.find(offset);
+
+	if (it != invalidTargets.end())
+		return it->second;
+
+	invalidTargets[offset] = instructions.size();
+	EmitInvalid(code, offset);
+
+	return invalidTargets[offset];
+}
+
+
+int CCobProgram::GetCodeOffset(int pc) const
+{
+	if (pc < 0 || size_t(pc) >= codeOffsets.size())
+		return -1;
+
+	return codeOffsets[pc];
+}
+
+
+const char* CCobProgram::GetOpcodeName(int opcode)
+{
+	if (opcode < 0 || opcode >= COBOP_COUNT)
+		return "UNKNOWN";
+
+	return opcodeNames[opcode];
+}
+
+
+int CCobProgram::GetNumOperands(int opcode)
+{
+	switch (opcode) {
+		case SLEEP:
+		case CREATE_LOCAL_VAR:
+		case POP_STACK:
+		case ADD: case SUB: case MUL: case DIV: case MOD:
+		case BITWISE_AND: case BITWISE_OR: case BITWISE_XOR: case BITWISE_NOT:
+		case RAND: case GET_UNIT_VALUE: case GET:
+		case SET_LESS: case SET_LESS_OR_EQUAL: case SET_GREATER: case SET_GREATER_OR_EQUAL:
+		case SET_EQUAL: case SET_NOT_EQUAL:
+		case LOGICAL_AND: case LOGICAL_OR: case LOGICAL_XOR: case LOGICAL_NOT:
+		case RETURN:
+		case SIGNAL: case SET_SIGNAL_MASK:
+		case SET: case ATTACH: case DROP:
+			return 0;
+
+		case SHOW: case HIDE:
+		case CACHE: case DONT_CACHE: case SHADE: case DONT_SHADE:
+		case EMIT_SFX:
+		case PUSH_CONSTANT: case PUSH_LOCAL_VAR: case PUSH_STATIC:
+		case POP_LOCAL_VAR: case POP_STATIC:
+		case JUMP: case JUMP_NOT_EQUAL:
+		case EXPLODE: case PLAY_SOUND:
+			return 1;
+
+		case MOVE: case TURN: case SPIN: case STOP_SPIN:
+		case MOVE_NOW: case TURN_NOW:
+		case WAIT_TURN: case WAIT_MOVE:
+		case START: case CALL: case REAL_CALL: case LUA_CALL:
+			return 2;
+	}
+
+	return -1;
+}
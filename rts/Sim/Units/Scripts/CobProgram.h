@@ -0,0 +1,131 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COB_PROGRAM_H
+#define COB_PROGRAM_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Indices for SET, GET, and GET_UNIT_VALUE for LUA return values
+#define LUA0 110 // (LUA0 returns the lua call status, 0 or 1)
+#define LUA1 111
+#define LUA2 112
+#define LUA3 113
+#define LUA4 114
+#define LUA5 115
+#define LUA6 116
+#define LUA7 117
+#define LUA8 118
+#define LUA9 119
+
+
+/**
+ * Opcodes of translated COB code, in the order of the interpreters dispatch
+ * table. Most map 1:1 onto a COB opcode, the others are:
+ *   NOP                  cache, shade and calls of zero-length scripts
+ *   GET_UNIT_VALUE_CONST push-constant followed by get-unit-value
+ *   GET_LUA_ARG          as above, for the LUA0 - LUA9 indices
+ *   INVALID              unknown opcodes and jumps past the code
+ */
+#define COB_OPCODES(OP) \
+	OP(MOVE) OP(TURN) OP(SPIN) OP(STOP_SPIN) OP(SHOW) OP(HIDE) OP(NOP) \
+	OP(MOVE_NOW) OP(TURN_NOW) OP(EMIT_SFX) \
+	OP(WAIT_TURN) OP(WAIT_MOVE) OP(SLEEP) \
+	OP(PUSH_CONSTANT) OP(PUSH_LOCAL_VAR) OP(PUSH_STATIC) OP(CREATE_LOCAL_VAR) \
+	OP(POP_LOCAL_VAR) OP(POP_STATIC) OP(POP_STACK) \
+	OP(ADD) OP(SUB) OP(MUL) OP(DIV) OP(MOD) \
+	OP(BITWISE_AND) OP(BITWISE_OR) OP(BITWISE_XOR) OP(BITWISE_NOT) \
+	OP(RAND) OP(GET_UNIT_VALUE) OP(GET_UNIT_VALUE_CONST) OP(GET_LUA_ARG) OP(GET) \
+	OP(SET_LESS) OP(SET_LESS_OR_EQUAL) OP(SET_GREATER) OP(SET_GREATER_OR_EQUAL) \
+	OP(SET_EQUAL) OP(SET_NOT_EQUAL) \
+	OP(LOGICAL_AND) OP(LOGICAL_OR) OP(LOGICAL_XOR) OP(LOGICAL_NOT) \
+	OP(START) OP(CALL) OP(LUA_CALL) OP(JUMP) OP(RETURN) OP(JUMP_NOT_EQUAL) \
+	OP(SIGNAL) OP(SET_SIGNAL_MASK) \
+	OP(EXPLODE) OP(PLAY_SOUND) \
+	OP(SET) OP(ATTACH) OP(DROP) \
+	OP(INVALID)
+
+enum CobOpcode {
+#define COB_OPCODE_ENUM(name) COBOP_##name,
+	COB_OPCODES(COB_OPCODE_ENUM)
+#undef COB_OPCODE_ENUM
+	COBOP_COUNT
+};
+
+
+struct CobInstruction
+{
+	int opcode;
+	/**
+	 * Operands in the order they follow the opcode in the COB code, except
+	 * that jump targets are instruction indices and for INVALID arg1 holds
+	 * the original opcode.
+	 */
+	int arg1;
+	int arg2;
+};
+
+
+/**
+ * @brief COB code translated for the interpreter in CCobThread
+ *
+ * The COB code is decoded once at load instead of on every execution:
+ * operands are stored with their instruction, jump and call targets are
+ * resolved to instruction indices, calls are bound to either a script or
+ * Lua, and constant unit-value lookups are fused into a single instruction.
+ * Instructions keep their original code offset for error messages.
+ */
+class CCobProgram
+{
+public:
+	/**
+	 * @param code COB code, in host byte order
+	 * @param scriptOffsets code offset of each script
+	 * @param scriptLengths code length of each script
+	 * @param scriptNames name of each script, "lua_" ones are calls to Lua
+	 */
+	void Translate(
+		const std::vector<int>& code,
+		const std::vector<int>& scriptOffsets,
+		const std::vector<int>& scriptLengths,
+		const std::vector<std::string>& scriptNames);
+
+	const CobInstruction* GetCode() const { return (instructions.empty())? NULL: &instructions[0]; }
+	int GetNumInstructions() const { return instructions.size(); }
+
+	/// index of the first instruction of script <functionId>
+	int GetEntry(int functionId) const { return scriptEntries[functionId]; }
+	/// original code offset of instruction <pc>, -1 if out of range
+	int GetCodeOffset(int pc) const;
+
+	static const char* GetOpcodeName(int opcode);
+
+private:
+	struct RawInstruction
+	{
+		int offset;
+		int opcode;
+		int arg1;
+		int arg2;
+	};
+
+	static int GetNumOperands(int opcode);
+
+	void Emit(const RawInstruction& raw, const std::vector<int>& scriptLengths, const std::vector<std::string>& scriptNames);
+	void DecodeFrom(const std::vector<int>& code, int offset, const std::vector<int>& scriptLengths, const std::vector<std::string>& scriptNames, std::vector<int>& pendingTargets);
+	void EmitInvalid(const std::vector<int>& code, int offset);
+	int ResolveOffset(const std::vector<int>& code, int offset);
+
+private:
+	std::vector<CobInstruction> instructions;
+	std::vector<int> codeOffsets;
+	std::vector<int> scriptEntries;
+
+	/// instruction index of each translated code offset, -1 if none
+	std::vector<int> offsetIndex;
+	/// INVALID instructions emitted for jumps to offsets outside the code
+	std::map<int, int> invalidTargets;
+};
+
+#endif // COB_PROGRAM_H
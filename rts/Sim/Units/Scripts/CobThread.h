@@ -58,8 +58,7 @@ public:
 	void ShowError(const std::string& msg);
 
 protected:
-	std::string GetOpcodeName(int opcode);
-	void LuaCall();
+	void LuaCall(int functionId, int numArgs);
 	// implementation of IAnimListener
 	void AnimFinished(CUnitScript::AnimType type, int piece, int axis);
 
@@ -70,9 +69,9 @@ protected:
 	CCobInstance* owner;
 
 	int wakeTime;
+	/// index of the next instruction in script.program
 	int PC;
 	vector<int> stack;
-	vector<int> execTrace;
 
 	int paramCount;
 	int retCode;
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 
 #include "UnitHandler.h"
@@ -12,6 +13,8 @@
 #include "Sim/MoveTypes/MoveType.h"
 #include "System/EventHandler.h"
 #include "System/EventBatchHandler.h"
+#include "System/ThreadPool.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/myMath.h"
@@ -27,6 +30,8 @@
 
 CUnitHandler* unitHandler = NULL;
 
+CONFIG(bool, MultiThreadedUnitUpdate).defaultValue(false).description("Run the read-only compute phase of the unit update (move-type terrain queries and piece matrices) on all cores, ahead of the serial commit in unit-ID order. Results are bit-identical to the single-threaded path; tools/benchmark/benchmark_mt_sync.sh compares the sync checksums of both on a demo.");
+
 CR_BIND(CUnitHandler, );
 CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(units),
@@ -52,7 +57,8 @@ void CUnitHandler::PostLoad()
 CUnitHandler::CUnitHandler()
 :
 	maxUnits(0),
-	maxUnitRadius(0.0f)
+	maxUnitRadius(0.0f),
+	mtUnitUpdate(configHandler->GetBool("MultiThreadedUnitUpdate"))
 {
 	// set the global (runtime-constant) unit-limit as the sum
 	// of  all team unit-limits, which is *always* <= MAX_UNITS
@@ -179,6 +185,8 @@ void CUnitHandler::DeleteUnitNow(CUnit* delUnit)
 
 void CUnitHandler::Update()
 {
+	SCOPED_TIMER("UnitHandler::Update");
+
 	{
 		if (!unitsToBeRemoved.empty()) {
 			while (!unitsToBeRemoved.empty()) {
@@ -217,8 +225,23 @@ void CUnitHandler::Update()
 	{
 		SCOPED_TIMER("Unit::MoveType::Update");
 
-		for (auto usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-			CUnit* unit = *usi;
+		// move-types commit in unit-ID order on either path (units created
+		// by one of these updates are not moved until the next frame)
+		updateUnits.assign(activeUnits.begin(), activeUnits.end());
+		std::sort(updateUnits.begin(), updateUnits.end(), [](const CUnit* a, const CUnit* b) { return (a->id < b->id); });
+
+		if (mtUnitUpdate) {
+			SCOPED_TIMER("Unit::MoveType::UpdateCompute");
+
+			// read-only phase, every move-type only writes its own cache
+			// which Update() uses iff the cached inputs are still current
+			for_mt(0, updateUnits.size(), [&](const int n) {
+				updateUnits[n]->moveType->UpdateCompute();
+			});
+		}
+
+		for (unsigned int n = 0; n < updateUnits.size(); n++) {
+			CUnit* unit = updateUnits[n];
 			AMoveType* moveType = unit->moveType;
 
 			UNIT_SANITY_CHECK(unit);
@@ -252,17 +275,7 @@ void CUnitHandler::Update()
 		}
 	}
 
-	{
-		SCOPED_TIMER("Unit::UpdatePieceMatrices");
-
-		for (auto usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-			// UnitScript only applies piece-space transforms so
-			// we apply the forward kinematics update separately
-			// (only if we have any dirty pieces)
-			CUnit* unit = *usi;
-			unit->localModel->UpdatePieceMatrices();
-		}
-	}
+	UpdatePieceMatrices();
 
 	{
 		SCOPED_TIMER("Unit::Update");
@@ -300,6 +313,31 @@ void CUnitHandler::Update()
 
 
 
+void CUnitHandler::UpdatePieceMatrices()
+{
+	SCOPED_TIMER("Unit::UpdatePieceMatrices");
+
+	// UnitScript only applies piece-space transforms so
+	// we apply the forward kinematics update separately
+	// (only if we have any dirty pieces)
+	if (!mtUnitUpdate) {
+		for (auto usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
+			CUnit* unit = *usi;
+			unit->localModel->UpdatePieceMatrices();
+		}
+	} else {
+		// every unit only reads and writes its own LocalModel here, so
+		// the units can be processed in any order and on any thread
+		updateUnits.assign(activeUnits.begin(), activeUnits.end());
+
+		for_mt(0, updateUnits.size(), [&](const int n) {
+			updateUnits[n]->localModel->UpdatePieceMatrices();
+		});
+	}
+}
+
+
+
 void CUnitHandler::AddBuilderCAI(CBuilderCAI* b)
 {
 	// called from CBuilderCAI --> owner is already valid
@@ -60,6 +60,7 @@ public:
 
 private:
 	void InsertActiveUnit(CUnit* unit);
+	void UpdatePieceMatrices();
 
 private:
 	SimObjectIDPool idPool;
@@ -74,6 +75,15 @@ private:
 	///< largest radius of any unit added so far (some
 	///< spatial query filters in GameHelper use this)
 	float maxUnitRadius;
+
+	///< run the read-only compute phase of the unit update on the thread
+	///< pool (unsynced setting, the commit order stays the same and the
+	///< results are bit-identical)
+	bool mtUnitUpdate;
+
+	///< copy of activeUnits for the current update phase (sorted by ID
+	///< for the move-types)
+	std::vector<CUnit*> updateUnits;
 };
 
 extern CUnitHandler* unitHandler;
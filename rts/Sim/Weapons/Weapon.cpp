@@ -728,15 +728,16 @@ bool CWeapon::AllowWeaponTargetCheck()
 void CWeapon::AutoTarget() {
 	lastTargetRetry = gs->frameNum;
 
-	std::multimap<float, CUnit*> targets;
-	std::multimap<float, CUnit*>::const_iterator targetsIt;
+	// shared by all weapons, AutoTarget is never re-entered
+	static CGameHelper::WeaponTargetQueue targets;
 
 	// NOTE:
-	//   sorts by INCREASING order of priority, so lower equals better
+	//   pops in INCREASING order of priority, so lower equals better
 	//   <targets> can contain duplicates if a unit covers multiple quads
 	//   <targets> is normally sorted such that all bad TC units are at the
 	//   end, but Lua can mess with the ordering arbitrarily
-	CGameHelper::GenerateWeaponTargets(this, targetUnit, targets);
+	targets.clear();
+	helper->GenerateWeaponTargets(this, targetUnit, targets);
 
 	CUnit* prevTargetUnit = NULL;
 	CUnit* goodTargetUnit = NULL;
@@ -744,8 +745,8 @@ void CWeapon::AutoTarget() {
 
 	float3 nextTargetPos = ZeroVector;
 
-	for (targetsIt = targets.begin(); targetsIt != targets.end(); ++targetsIt) {
-		CUnit* nextTargetUnit = targetsIt->second;
+	while (!targets.empty()) {
+		CUnit* nextTargetUnit = targets.pop();
 
 		if (nextTargetUnit == prevTargetUnit)
 			continue; // filter consecutive duplicates
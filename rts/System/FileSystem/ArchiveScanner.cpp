@@ -12,6 +12,7 @@
 #include "ArchiveLoader.h"
 #include "DataDirLocater.h"
 #include "Archives/IArchive.h"
+#include "Archives/FileCRCCache.h"
 #include "FileFilter.h"
 #include "DataDirsAccess.h"
 #include "FileSystem.h"
@@ -342,7 +343,9 @@ CArchiveScanner::CArchiveScanner()
 {
 	// the "cache" dir is created in DataDirLocater
 	cachefile = dataDirLocater.GetWriteDirPath() + FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheBaseDir()) + "ArchiveCache.lua";
+	crcCachefile = dataDirLocater.GetWriteDirPath() + FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheBaseDir()) + "FileCRCCache.dat";
 	ReadCacheData(GetFilepath());
+	CFileCRCCache::GetInstance().Load(crcCachefile);
 
 	const std::vector<std::string>& datadirs = dataDirLocater.GetDataDirPaths();
 	std::vector<std::string> scanDirs;
@@ -355,6 +358,7 @@ CArchiveScanner::CArchiveScanner()
 	// ArchiveCache has been parsed at this point --> archiveInfos is populated
 	ScanDirs(scanDirs, true);
 	WriteCacheData(GetFilepath());
+	CFileCRCCache::GetInstance().Save(crcCachefile);
 }
 
 
@@ -363,6 +367,7 @@ CArchiveScanner::~CArchiveScanner()
 	if (isDirty) {
 		WriteCacheData(GetFilepath());
 	}
+	CFileCRCCache::GetInstance().Save(crcCachefile);
 }
 
 
@@ -401,12 +406,32 @@ void CArchiveScanner::ScanDirs(const std::vector<std::string>& scanDirs, bool do
 		}
 	}*/
 
-	// Create archiveInfos etc. when not being in cache already
+	// Create archiveInfos etc. when not being in cache already:
+	// the cache is consulted serially, the archives which need to be looked
+	// into are then opened, parsed and checksummed in parallel, and finally
+	// merged in the order they were found (which decides between duplicates)
+	std::vector<ScanTask> tasks;
+	tasks.reserve(foundArchives.size());
+
 	for (const std::string& archive: foundArchives) {
-		ScanArchive(archive, doChecksum);
+		tasks.push_back(ScanTask());
+
+		if (!PrepareScan(archive, doChecksum, tasks.back()))
+			tasks.pop_back();
+	}
+
+	// make sure the (global) CRC table exists before threads race to create it
+	CRC().GetDigest();
+
+	for_mt(0, tasks.size(), [&](const int i) {
+		RunScan(tasks[i], doChecksum);
 	#if !defined(DEDICATED) && !defined(UNITSYNC)
 		Watchdog::ClearTimer(WDT_MAIN);
 	#endif
+	});
+
+	for (ScanTask& task: tasks) {
+		CommitScan(task, doChecksum);
 	}
 
 	// Now we'll have to parse the replaces-stuff found in the mods
@@ -473,14 +498,32 @@ static void AddDependency(std::vector<std::string>& deps, const std::string& dep
 
 void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 {
-	const std::string fn    = FileSystem::GetFilename(fullName);
-	const std::string fpath = FileSystem::GetDirectory(fullName);
-	const std::string lcfn  = StringToLower(fn);
+	ScanTask task;
+
+	if (!PrepareScan(fullName, doChecksum, task))
+		return;
+
+	RunScan(task, doChecksum);
+	CommitScan(task, doChecksum);
+}
+
+
+bool CArchiveScanner::PrepareScan(const std::string& fullName, bool doChecksum, ScanTask& task)
+{
+	task.fullName = fullName;
+	task.fileName = FileSystem::GetFilename(fullName);
+	task.filePath = FileSystem::GetDirectory(fullName);
+	task.lcName   = StringToLower(task.fileName);
+
+	const std::string& fpath = task.filePath;
+	const std::string& lcfn  = task.lcName;
 
 	// Stat file
 	struct stat info = {0};
 	int statfailed = stat(fullName.c_str(), &info);
 
+	task.modified = info.st_mtime;
+
 	// If stat fails, assume the archive is not broken nor cached
 	if (!statfailed) {
 		// Determine whether this archive has earlier be found to be broken
@@ -488,7 +531,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		if (bai != brokenArchives.end()) {
 			if ((unsigned)info.st_mtime == bai->second.modified && fpath == bai->second.path) {
 				bai->second.updated = true;
-				return;
+				return false;
 			}
 		}
 
@@ -497,45 +540,54 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		if (aii != archiveInfos.end()) {
 			// This archive may have been obsoleted, do not process it if so
 			if (!aii->second.replaced.empty()) {
-				return;
+				return false;
 			}
 
 			if ((unsigned)info.st_mtime == aii->second.modified && fpath == aii->second.path) {
-				// cache found update checksum if wanted
+				// cache found
 				aii->second.updated = true;
-				if (doChecksum && (aii->second.checksum == 0)) {
-					aii->second.checksum = GetCRC(fullName);
-				}
-				return;
+
+				// st_mtime of a directory archive (.sdd) only reflects changes
+				// to the directory itself, not to the files in it; recompute
+				// its checksum (only changed files are read again, see
+				// CFileCRCCache), CommitScan rescans the archive if it differs
+				task.isDirArchive = ((info.st_mode & S_IFDIR) != 0);
+				task.checksumOnly = (doChecksum && (aii->second.checksum == 0 || task.isDirArchive));
+
+				return task.checksumOnly;
 			} else {
 				if (aii->second.updated) {
 					LOG_L(L_WARNING, "Found a \"%s\" already in \"%s\", ignoring one in \"%s\"", aii->first.c_str(), aii->second.path.c_str(), fpath.c_str());
-					return;
+					return false;
 				}
 
 				// If we are here, we could have invalid info in the cache
-				// Force a reread if it is a directory archive (.sdd), as
-				// st_mtime only reflects changes to the directory itself,
-				// not the contents.
 				archiveInfos.erase(aii);
 			}
 		}
 	}
 
+	return true;
+}
+
+
+void CArchiveScanner::RunScan(ScanTask& task, bool doChecksum)
+{
+	const std::string& fullName = task.fullName;
+
+	if (task.checksumOnly) {
+		task.archiveInfo.checksum = GetCRC(fullName);
+		return;
+	}
+
 	boost::scoped_ptr<IArchive> ar(archiveLoader.OpenArchive(fullName));
 	if (!ar || !ar->IsOpen()) {
-		LOG_L(L_WARNING, "Unable to open archive: %s", fullName.c_str());
-
-		// record it as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = brokenArchives[lcfn];
-		ba.path = fpath;
-		ba.modified = info.st_mtime;
-		ba.updated = true;
-		ba.problem = "Unable to open archive";
+		task.error = "Unable to open archive";
+		task.isBroken = true;
 		return;
 	}
 
-	std::string error;
+	std::string& error = task.error;
 	std::string mapfile;
 
 	const bool hasModinfo = ar->FileExists("modinfo.lua");
@@ -570,7 +622,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		}
 	}
 
-	ArchiveInfo ai;
+	ArchiveInfo& ai = task.archiveInfo;
 	auto& ad = ai.archiveData;
 	if (hasMapinfo) {
 		ScanArchiveLua(ar.get(), "mapinfo.lua", ai, error);
@@ -579,14 +631,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	}
 	if (!error.empty()) {
 		// for some reason, the archive is marked as broken
-		LOG_L(L_WARNING, "Failed to scan %s (%s)", fullName.c_str(), error.c_str());
-
-		// record it as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = brokenArchives[lcfn];
-		ba.path = fpath;
-		ba.modified = info.st_mtime;
-		ba.updated = true;
-		ba.problem = error;
+		task.isBroken = true;
 		return;
 	}
 
@@ -603,26 +648,77 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 
 		AddDependency(ad.GetDependencies(), "Map Helper v1");
 		ad.SetInfoItemValueInteger("modType", modtype::map);
-
-		LOG_S(LOG_SECTION_ARCHIVESCANNER, "Found new map: %s", ad.GetNameVersioned().c_str());
 	} else if (hasModinfo) {
 		// it is a game
 		if (ad.GetModType() == modtype::primary) {
 			AddDependency(ad.GetDependencies(), "Spring content v1");
 		}
-
-		LOG_S(LOG_SECTION_ARCHIVESCANNER, "Found new game: %s", ad.GetNameVersioned().c_str());
 	} else {
 		// neither a map nor a mod: error
 		error = "missing modinfo.lua/mapinfo.lua";
 	}
 
-	ai.path = fpath;
-	ai.modified = info.st_mtime;
-	ai.origName = fn;
+	ai.path = task.filePath;
+	ai.modified = task.modified;
+	ai.origName = task.fileName;
 	ai.updated = true;
 	ai.checksum = (doChecksum) ? GetCRC(fullName) : 0;
-	archiveInfos[lcfn] = ai;
+}
+
+
+void CArchiveScanner::CommitScan(ScanTask& task, bool doChecksum)
+{
+	const std::string& lcfn = task.lcName;
+
+	if (task.checksumOnly) {
+		ArchiveInfo& cached = archiveInfos[lcfn];
+
+		if (!task.isDirArchive || cached.checksum == 0 || cached.checksum == task.archiveInfo.checksum) {
+			cached.checksum = task.archiveInfo.checksum;
+			return;
+		}
+
+		// rare enough to not bother scanning it in parallel
+		LOG_S(LOG_SECTION_ARCHIVESCANNER, "Contents of %s changed, rescanning", task.fullName.c_str());
+		archiveInfos.erase(lcfn);
+
+		task.checksumOnly = false;
+		task.archiveInfo = ArchiveInfo();
+
+		RunScan(task, doChecksum);
+		CommitScan(task, doChecksum);
+		return;
+	}
+
+	// scanned in parallel with another archive of the same name, which
+	// (being found earlier) takes precedence
+	std::map<std::string, ArchiveInfo>::const_iterator aii = archiveInfos.find(lcfn);
+	if (aii != archiveInfos.end() && aii->second.updated) {
+		LOG_L(L_WARNING, "Found a \"%s\" already in \"%s\", ignoring one in \"%s\"", aii->first.c_str(), aii->second.path.c_str(), task.filePath.c_str());
+		return;
+	}
+
+	if (task.isBroken) {
+		LOG_L(L_WARNING, "Failed to scan %s (%s)", task.fullName.c_str(), task.error.c_str());
+
+		// record it as broken, so we don't need to look inside everytime
+		BrokenArchive& ba = brokenArchives[lcfn];
+		ba.path = task.filePath;
+		ba.modified = task.modified;
+		ba.updated = true;
+		ba.problem = task.error;
+		return;
+	}
+
+	const ArchiveData& ad = task.archiveInfo.archiveData;
+
+	if (ad.GetModType() == modtype::map) {
+		LOG_S(LOG_SECTION_ARCHIVESCANNER, "Found new map: %s", ad.GetNameVersioned().c_str());
+	} else if (task.error.empty()) {
+		LOG_S(LOG_SECTION_ARCHIVESCANNER, "Found new game: %s", ad.GetNameVersioned().c_str());
+	}
+
+	archiveInfos[lcfn] = task.archiveInfo;
 }
 
 bool CArchiveScanner::ScanArchiveLua(IArchive* ar, const std::string& fileName, ArchiveInfo& ai, std::string& err)
@@ -177,10 +177,41 @@ private:
 		std::string problem;
 	};
 
+	/// an archive not (validly) cached, which has to be looked into
+	struct ScanTask
+	{
+		ScanTask()
+			: modified(0)
+			, isDirArchive(false)
+			, checksumOnly(false)
+			, isBroken(false)
+			{}
+		std::string fullName;
+		std::string fileName;
+		std::string filePath;
+		std::string lcName;
+		unsigned int modified;
+		bool isDirArchive;
+		bool checksumOnly;        ///< cached, but the checksum is (re)computed
+		bool isBroken;
+		std::string error;
+		ArchiveInfo archiveInfo;  ///< result of RunScan
+	};
+
 private:
 	void ScanDirs(const std::vector<std::string>& dirs, bool checksum = false);
 	void ScanDir(const std::string& curPath, std::list<std::string>* foundArchives);
 
+	/**
+	 * @brief look <fullName> up in the cache
+	 * @return false if the cached info can be used as is
+	 */
+	bool PrepareScan(const std::string& fullName, bool checksum, ScanTask& task);
+	/// open and parse the archive; touches no member, so tasks may run in parallel
+	void RunScan(ScanTask& task, bool checksum);
+	/// merge the result of RunScan into archiveInfos / brokenArchives
+	void CommitScan(ScanTask& task, bool checksum);
+
 	/// scan mapinfo / modinfo lua files
 	bool ScanArchiveLua(IArchive* ar, const std::string& fileName, ArchiveInfo& ai, std::string& err);
 
@@ -201,6 +232,8 @@ private:
 
 	bool isDirty;
 	std::string cachefile;
+	/// per-file CRCs of directory archives, see CFileCRCCache
+	std::string crcCachefile;
 };
 
 extern CArchiveScanner* archiveScanner;
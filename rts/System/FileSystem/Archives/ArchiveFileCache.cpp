@@ -0,0 +1,148 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ArchiveFileCache.h"
+#include "System/Log/ILog.h"
+
+
+CArchiveFileCache::CArchiveFileCache(size_t maxBytes)
+{
+	stats.maxBytes = maxBytes;
+}
+
+
+bool CArchiveFileCache::Get(const void* owner, unsigned int fid, std::vector<boost::uint8_t>& buffer, bool& exists)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	const FileEntry* entry = Find(FileKey(owner, fid));
+
+	if (entry == NULL)
+		return false;
+
+	buffer = *entry->data;
+	exists = entry->exists;
+	return true;
+}
+
+bool CArchiveFileCache::Get(const void* owner, unsigned int fid, BufferPtr& buffer, bool& exists)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	const FileEntry* entry = Find(FileKey(owner, fid));
+
+	if (entry == NULL)
+		return false;
+
+	buffer = entry->data;
+	exists = entry->exists;
+	return true;
+}
+
+
+void CArchiveFileCache::Insert(const void* owner, unsigned int fid, const std::vector<boost::uint8_t>& buffer, bool exists)
+{
+	Insert(owner, fid, BufferPtr(new std::vector<boost::uint8_t>(buffer)), exists);
+}
+
+void CArchiveFileCache::Insert(const void* owner, unsigned int fid, const BufferPtr& buffer, bool exists)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	const FileKey key(owner, fid);
+	const std::map<FileKey, FileList::iterator>::iterator it = fileIndex.find(key);
+
+	if (it != fileIndex.end())
+		EraseEntry(it->second);
+
+	if (buffer->size() > stats.maxBytes)
+		return;
+
+	Evict(stats.maxBytes - buffer->size());
+
+	files.push_front(FileEntry());
+	files.front().key = key;
+	files.front().exists = exists;
+	files.front().data = buffer;
+
+	fileIndex[key] = files.begin();
+
+	stats.numFiles++;
+	stats.usedBytes += buffer->size();
+}
+
+
+void CArchiveFileCache::Remove(const void* owner)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	std::map<FileKey, FileList::iterator>::iterator it = fileIndex.lower_bound(FileKey(owner, 0));
+
+	while (it != fileIndex.end() && it->first.first == owner) {
+		stats.numFiles--;
+		stats.usedBytes -= it->second->data->size();
+
+		files.erase(it->second);
+		fileIndex.erase(it++);
+	}
+}
+
+
+void CArchiveFileCache::SetMaxSize(size_t maxBytes)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	stats.maxBytes = maxBytes;
+	Evict(maxBytes);
+}
+
+
+CArchiveFileCache::Stats CArchiveFileCache::GetStats() const
+{
+	boost::mutex::scoped_lock lck(mutex);
+	return stats;
+}
+
+void CArchiveFileCache::PrintStats() const
+{
+	const Stats s = GetStats();
+	const unsigned long long lookups = s.hits + s.misses;
+
+	LOG("[ArchiveFileCache] %u files, %.1f of %.1f MB used",
+			(unsigned) s.numFiles, s.usedBytes / (1024.0f * 1024.0f), s.maxBytes / (1024.0f * 1024.0f));
+	LOG("[ArchiveFileCache] %llu hits, %llu misses (%.1f%% hit rate), %llu evictions",
+			s.hits, s.misses, (lookups > 0)? (100.0f * s.hits / lookups): 0.0f, s.evictions);
+}
+
+
+const CArchiveFileCache::FileEntry* CArchiveFileCache::Find(const FileKey& key)
+{
+	std::map<FileKey, FileList::iterator>::const_iterator it = fileIndex.find(key);
+
+	if (it == fileIndex.end()) {
+		stats.misses++;
+		return NULL;
+	}
+
+	// move to the front, iterators stay valid
+	files.splice(files.begin(), files, it->second);
+
+	stats.hits++;
+	return &(*it->second);
+}
+
+void CArchiveFileCache::EraseEntry(FileList::iterator it)
+{
+	stats.numFiles--;
+	stats.usedBytes -= it->data->size();
+
+	fileIndex.erase(it->key);
+	files.erase(it);
+}
+
+void CArchiveFileCache::Evict(size_t maxBytes)
+{
+	while (stats.usedBytes > maxBytes) {
+		EraseEntry(--files.end());
+		stats.evictions++;
+	}
+}
@@ -0,0 +1,92 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _ARCHIVE_FILE_CACHE_H
+#define _ARCHIVE_FILE_CACHE_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+/**
+ * @brief Byte-budgeted LRU cache of uncompressed archive files
+ *
+ * Shared by all buffered archives, so the memory held by files that were
+ * read once (eg. during loading) is bounded by the budget instead of growing
+ * with the number and size of archives in use. Files are keyed by the archive
+ * that owns them and their file id inside it.
+ */
+class CArchiveFileCache
+{
+public:
+	struct Stats
+	{
+		Stats(): hits(0), misses(0), evictions(0), numFiles(0), usedBytes(0), maxBytes(0) {}
+
+		unsigned long long hits;
+		unsigned long long misses;
+		unsigned long long evictions;
+		size_t numFiles;
+		size_t usedBytes;
+		size_t maxBytes;
+	};
+
+	typedef boost::shared_ptr<const std::vector<boost::uint8_t> > BufferPtr;
+
+public:
+	CArchiveFileCache(size_t maxBytes);
+
+	/**
+	 * @brief look up a file and mark it as most recently used
+	 * @param exists set to whether the archive could extract the file
+	 * @return false if the file is not cached
+	 */
+	bool Get(const void* owner, unsigned int fid, std::vector<boost::uint8_t>& buffer, bool& exists);
+	/// as above, but shares the cached buffer instead of copying it
+	bool Get(const void* owner, unsigned int fid, BufferPtr& buffer, bool& exists);
+
+	/**
+	 * @brief add a file, evicting the least recently used ones to make room
+	 * Files larger than the whole budget are not cached.
+	 */
+	void Insert(const void* owner, unsigned int fid, const std::vector<boost::uint8_t>& buffer, bool exists);
+	void Insert(const void* owner, unsigned int fid, const BufferPtr& buffer, bool exists);
+
+	/// drop all files of <owner>, called when an archive is closed
+	void Remove(const void* owner);
+
+	void SetMaxSize(size_t maxBytes);
+
+	Stats GetStats() const;
+	void PrintStats() const;
+
+private:
+	typedef std::pair<const void*, unsigned int> FileKey;
+
+	struct FileEntry
+	{
+		FileKey key;
+		bool exists;
+		/// shared with file views handed out, which keep it alive past eviction
+		BufferPtr data;
+	};
+
+	typedef std::list<FileEntry> FileList;
+
+	const FileEntry* Find(const FileKey& key);
+	void EraseEntry(FileList::iterator it);
+	void Evict(size_t maxBytes);
+
+private:
+	mutable boost::mutex mutex;
+
+	/// most recently used files first
+	FileList files;
+	std::map<FileKey, FileList::iterator> fileIndex;
+
+	Stats stats;
+};
+
+#endif // _ARCHIVE_FILE_CACHE_H
@@ -2,6 +2,11 @@
 
 
 #include "BufferedArchive.h"
+#include "ArchiveFileCache.h"
+#include "System/Config/ConfigHandler.h"
+
+CONFIG(int, ArchiveCacheSize).defaultValue(256).minimumValue(0)
+	.description("Maximum memory in MB used to keep files uncompressed from archives (sdz, sdp) around for re-reading. 0 disables the cache.");
 
 
 CBufferedArchive::CBufferedArchive(const std::string& name, bool cache)
@@ -12,6 +17,16 @@ CBufferedArchive::CBufferedArchive(const std::string& name, bool cache)
 
 CBufferedArchive::~CBufferedArchive()
 {
+	if (caching) {
+		GetFileCache().Remove(this);
+	}
+}
+
+CArchiveFileCache& CBufferedArchive::GetFileCache()
+{
+	// configHandler does not exist in all users of the archives (eg. tools)
+	static CArchiveFileCache fileCache(size_t((configHandler != NULL)? configHandler->GetInt("ArchiveCacheSize"): 256) * 1024 * 1024);
+	return fileCache;
 }
 
 bool CBufferedArchive::GetFile(unsigned int fid, std::vector<boost::uint8_t>& buffer)
@@ -23,15 +38,45 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<boost::uint8_t>& bu
 		return GetFileImpl(fid,buffer);
 	}
 
-	if (fid >= cache.size()) {
-		cache.resize(fid + 1);
+	CArchiveFileCache& fileCache = GetFileCache();
+	bool exists = false;
+
+	if (fileCache.Get(this, fid, buffer, exists)) {
+		return exists;
+	}
+
+	buffer.clear();
+	exists = GetFileImpl(fid, buffer);
+	fileCache.Insert(this, fid, buffer, exists);
+	return exists;
+}
+
+FileViewPtr CBufferedArchive::GetFileView(unsigned int fid)
+{
+	if (!caching) {
+		return IArchive::GetFileView(fid);
+	}
+
+	boost::mutex::scoped_lock lck(archiveLock);
+	assert(IsFileId(fid));
+
+	// views share the cached buffer, so the file is extracted only once
+	// while it stays cached, and never copied
+	CArchiveFileCache& fileCache = GetFileCache();
+	CArchiveFileCache::BufferPtr buffer;
+	bool exists = false;
+
+	if (!fileCache.Get(this, fid, buffer, exists)) {
+		std::vector<boost::uint8_t>* newBuffer = new std::vector<boost::uint8_t>();
+		buffer.reset(newBuffer);
+
+		exists = GetFileImpl(fid, *newBuffer);
+		fileCache.Insert(this, fid, buffer, exists);
 	}
-	
-	if (!cache[fid].populated) {
-		cache[fid].exists = GetFileImpl(fid, cache[fid].data);
-		cache[fid].populated = true;
+
+	if (!exists) {
+		return FileViewPtr();
 	}
 
-	buffer = cache[fid].data;
-	return cache[fid].exists;
+	return FileViewPtr(new CBufferFileView(buffer));
 }
@@ -3,14 +3,17 @@
 #ifndef _BUFFERED_ARCHIVE_H
 #define _BUFFERED_ARCHIVE_H
 
-#include <map>
 #include <boost/thread/mutex.hpp>
 
 #include "IArchive.h"
 
+class CArchiveFileCache;
+
 /**
  * Provides a helper implementation for archive types that can only uncompress
  * one file to memory at a time.
+ * Uncompressed files are kept in a cache shared by all buffered archives
+ * (see GetFileCache), its size is limited by ArchiveCacheSize.
  */
 class CBufferedArchive : public IArchive
 {
@@ -19,19 +22,14 @@ public:
 	virtual ~CBufferedArchive();
 
 	virtual bool GetFile(unsigned int fid, std::vector<boost::uint8_t>& buffer);
+	virtual FileViewPtr GetFileView(unsigned int fid);
+
+	static CArchiveFileCache& GetFileCache();
 
 protected:
 	virtual bool GetFileImpl(unsigned int fid, std::vector<boost::uint8_t>& buffer) = 0;
 
 	boost::mutex archiveLock; // neither 7zip nor zlib are threadsafe
-	struct FileBuffer
-	{
-		FileBuffer() : populated(false), exists(false) {};
-		bool populated; // cause a file may be 0 bytes big
-		bool exists;
-		std::vector<boost::uint8_t> data;
-	};
-	std::vector<FileBuffer> cache; // cache[fileId]
 private:
 	bool caching;
 };
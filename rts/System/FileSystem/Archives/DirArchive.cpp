@@ -2,6 +2,7 @@
 
 
 #include "DirArchive.h"
+#include "FileCRCCache.h"
 
 #include <assert.h>
 #include <fstream>
@@ -77,6 +78,20 @@ bool CDirArchive::GetFile(unsigned int fid, std::vector<boost::uint8_t>& buffer)
 	}
 }
 
+FileViewPtr CDirArchive::GetFileView(unsigned int fid)
+{
+	assert(IsFileId(fid));
+
+	const std::string rawPath = dataDirsAccess.LocateFile(dirName + searchFiles[fid]);
+	const FileViewPtr view(CMappedFileView::Open(rawPath));
+
+	// empty files can not be mapped
+	if (view == NULL)
+		return IArchive::GetFileView(fid);
+
+	return view;
+}
+
 void CDirArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
@@ -91,3 +106,11 @@ void CDirArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 		size = 0;
 	}
 }
+
+unsigned int CDirArchive::GetCrc32(unsigned int fid)
+{
+	assert(IsFileId(fid));
+
+	const std::string rawPath = dataDirsAccess.LocateFile(dirName + searchFiles[fid]);
+	return CFileCRCCache::GetInstance().GetCRC(rawPath);
+}
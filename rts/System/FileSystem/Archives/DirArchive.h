@@ -36,7 +36,10 @@ public:
 	
 	virtual unsigned int NumFiles() const;
 	virtual bool GetFile(unsigned int fid, std::vector<boost::uint8_t>& buffer);
+	virtual FileViewPtr GetFileView(unsigned int fid);
 	virtual void FileInfo(unsigned int fid, std::string& name, int& size) const;
+	/// looked up in CFileCRCCache, files are only read if they changed
+	virtual unsigned int GetCrc32(unsigned int fid);
 	
 private:
 	/// "ExampleArchive.sdd/"
@@ -0,0 +1,214 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FileCRCCache.h"
+#include "FileView.h"
+#include "System/CRC.h"
+#include "System/Log/ILog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <boost/scoped_ptr.hpp>
+
+// bump when the layout of the cache file changes
+static const char CACHE_MAGIC[8] = {'S', 'P', 'R', 'F', 'C', 'R', 'C', '\0'};
+static const boost::uint32_t CACHE_VERSION = 1;
+
+
+CFileCRCCache& CFileCRCCache::GetInstance()
+{
+	static CFileCRCCache instance;
+	return instance;
+}
+
+
+unsigned int CFileCRCCache::GetCRC(const std::string& filePath)
+{
+	FileStat fileStat;
+
+	if (!GetFileStat(filePath, fileStat))
+		return CRC().GetDigest();
+
+	{
+		boost::mutex::scoped_lock lck(mutex);
+
+		std::map<std::string, FileEntry>::iterator it = entries.find(filePath);
+
+		if (it != entries.end() && it->second.stat == fileStat) {
+			it->second.used = true;
+			return it->second.crc;
+		}
+	}
+
+	// hash outside the lock, other threads may look up other files meanwhile
+	const unsigned int crc = HashFile(filePath);
+
+	boost::mutex::scoped_lock lck(mutex);
+
+	FileEntry& entry = entries[filePath];
+	entry.stat = fileStat;
+	entry.crc = crc;
+	entry.used = true;
+
+	isDirty = true;
+	return crc;
+}
+
+
+bool CFileCRCCache::Load(const std::string& cacheFile)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	entries.clear();
+	isDirty = false;
+
+	std::ifstream ifs(cacheFile.c_str(), std::ios::in | std::ios::binary);
+
+	if (!ifs.is_open())
+		return false;
+
+	char magic[sizeof(CACHE_MAGIC)];
+	boost::uint32_t version = 0;
+	boost::uint32_t numEntries = 0;
+
+	ifs.read(magic, sizeof(magic));
+	ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+	ifs.read(reinterpret_cast<char*>(&numEntries), sizeof(numEntries));
+
+	if (!ifs || !std::equal(magic, magic + sizeof(magic), CACHE_MAGIC) || version != CACHE_VERSION) {
+		LOG_L(L_INFO, "[FileCRCCache::%s] ignoring outdated cache %s", __FUNCTION__, cacheFile.c_str());
+		return false;
+	}
+
+	for (boost::uint32_t n = 0; n < numEntries; n++) {
+		boost::uint32_t pathLength = 0;
+		ifs.read(reinterpret_cast<char*>(&pathLength), sizeof(pathLength));
+
+		if (!ifs || pathLength == 0 || pathLength > 4096)
+			break;
+
+		std::string filePath(pathLength, '\0');
+		FileEntry entry;
+
+		ifs.read(&filePath[0], pathLength);
+		ifs.read(reinterpret_cast<char*>(&entry.stat.size), sizeof(entry.stat.size));
+		ifs.read(reinterpret_cast<char*>(&entry.stat.modified), sizeof(entry.stat.modified));
+		ifs.read(reinterpret_cast<char*>(&entry.stat.inode), sizeof(entry.stat.inode));
+		ifs.read(reinterpret_cast<char*>(&entry.crc), sizeof(entry.crc));
+
+		if (!ifs)
+			break;
+
+		entries[filePath] = entry;
+	}
+
+	if (entries.size() != numEntries) {
+		LOG_L(L_WARNING, "[FileCRCCache::%s] cache %s is truncated", __FUNCTION__, cacheFile.c_str());
+		isDirty = true;
+	}
+
+	return true;
+}
+
+
+bool CFileCRCCache::Save(const std::string& cacheFile)
+{
+	boost::mutex::scoped_lock lck(mutex);
+
+	// drop entries of files which were deleted or changed, without hashing
+	// the latter; entries looked up were validated already
+	for (std::map<std::string, FileEntry>::iterator it = entries.begin(); it != entries.end(); ) {
+		FileStat fileStat;
+
+		if (it->second.used || (GetFileStat(it->first, fileStat) && fileStat == it->second.stat)) {
+			++it;
+		} else {
+			entries.erase(it++);
+			isDirty = true;
+		}
+	}
+
+	if (!isDirty)
+		return true;
+
+	// write next to the cache and rename it into place, so an interrupted
+	// save (or a concurrent Load by another process) never sees half a file
+	const std::string tempFile = cacheFile + ".tmp";
+
+	std::ofstream ofs(tempFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!ofs.is_open()) {
+		LOG_L(L_ERROR, "[FileCRCCache::%s] failed to write to \"%s\"", __FUNCTION__, tempFile.c_str());
+		return false;
+	}
+
+	const boost::uint32_t numEntries = entries.size();
+
+	ofs.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	ofs.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+	ofs.write(reinterpret_cast<const char*>(&numEntries), sizeof(numEntries));
+
+	for (std::map<std::string, FileEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+		const boost::uint32_t pathLength = it->first.size();
+		const FileEntry& entry = it->second;
+
+		ofs.write(reinterpret_cast<const char*>(&pathLength), sizeof(pathLength));
+		ofs.write(it->first.data(), pathLength);
+		ofs.write(reinterpret_cast<const char*>(&entry.stat.size), sizeof(entry.stat.size));
+		ofs.write(reinterpret_cast<const char*>(&entry.stat.modified), sizeof(entry.stat.modified));
+		ofs.write(reinterpret_cast<const char*>(&entry.stat.inode), sizeof(entry.stat.inode));
+		ofs.write(reinterpret_cast<const char*>(&entry.crc), sizeof(entry.crc));
+	}
+
+	ofs.close();
+
+	if (!ofs) {
+		LOG_L(L_ERROR, "[FileCRCCache::%s] failed to write to \"%s\"", __FUNCTION__, tempFile.c_str());
+		std::remove(tempFile.c_str());
+		return false;
+	}
+
+#ifdef _WIN32
+	// rename() does not replace existing files here
+	std::remove(cacheFile.c_str());
+#endif
+
+	if (std::rename(tempFile.c_str(), cacheFile.c_str()) != 0) {
+		LOG_L(L_ERROR, "[FileCRCCache::%s] failed to rename \"%s\" to \"%s\"", __FUNCTION__, tempFile.c_str(), cacheFile.c_str());
+		std::remove(tempFile.c_str());
+		return false;
+	}
+
+	isDirty = false;
+	return true;
+}
+
+
+bool CFileCRCCache::GetFileStat(const std::string& filePath, FileStat& fileStat)
+{
+	struct stat info;
+
+	if (stat(filePath.c_str(), &info) != 0 || (info.st_mode & S_IFDIR) != 0)
+		return false;
+
+	// st_ino is always 0 on windows, size and mtime have to do there
+	fileStat.size = info.st_size;
+	fileStat.modified = info.st_mtime;
+	fileStat.inode = info.st_ino;
+	return true;
+}
+
+unsigned int CFileCRCCache::HashFile(const std::string& filePath)
+{
+	CRC crc;
+
+	// empty files can not be mapped, their CRC is that of no data
+	boost::scoped_ptr<CMappedFileView> view(CMappedFileView::Open(filePath));
+
+	if (view != NULL)
+		crc.Update(view->GetData(), view->GetSize());
+
+	return crc.GetDigest();
+}
@@ -0,0 +1,76 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _FILE_CRC_CACHE_H
+#define _FILE_CRC_CACHE_H
+
+#include <map>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+/**
+ * @brief Persistent cache of the CRC32 of files on disk
+ *
+ * Archives which are plain directories (.sdd) carry no checksums of their
+ * own, so each of their files would have to be read completely whenever the
+ * archive checksum is needed. This remembers the CRC of every file hashed,
+ * keyed by its path and validated by its size, modification time and inode,
+ * so only files that actually changed are read again.
+ */
+class CFileCRCCache
+{
+public:
+	static CFileCRCCache& GetInstance();
+
+	/**
+	 * @brief CRC32 of the contents of the file at <filePath>
+	 * Thread-safe; files are only read if not cached or modified since.
+	 * @return CRC32 of the contents, or of nothing if the file can not be read
+	 */
+	unsigned int GetCRC(const std::string& filePath);
+
+	/// replaces the cached entries with the ones stored in <cacheFile>
+	bool Load(const std::string& cacheFile);
+	/**
+	 * @brief write the cache to <cacheFile>, if it changed since Load
+	 * Entries not looked up since are only kept if their file did not change.
+	 */
+	bool Save(const std::string& cacheFile);
+
+private:
+	struct FileStat
+	{
+		FileStat(): size(0), modified(0), inode(0) {}
+
+		bool operator == (const FileStat& s) const {
+			return (size == s.size && modified == s.modified && inode == s.inode);
+		}
+
+		boost::uint64_t size;
+		boost::uint64_t modified;
+		boost::uint64_t inode;
+	};
+
+	struct FileEntry
+	{
+		FileEntry(): crc(0), used(false) {}
+
+		FileStat stat;
+		unsigned int crc;
+		/// looked up (and thus validated) since the last Load
+		bool used;
+	};
+
+	CFileCRCCache(): isDirty(false) {}
+
+	static bool GetFileStat(const std::string& filePath, FileStat& fileStat);
+	static unsigned int HashFile(const std::string& filePath);
+
+private:
+	boost::mutex mutex;
+
+	std::map<std::string, FileEntry> entries;
+	bool isDirty;
+};
+
+#endif // _FILE_CRC_CACHE_H
@@ -0,0 +1,53 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FileView.h"
+#include "System/FileSystem/FileSystemAbstraction.h"
+#include "System/Log/ILog.h"
+
+#include <boost/interprocess/exceptions.hpp>
+
+
+CBufferFileView::CBufferFileView(std::vector<boost::uint8_t>& _buffer)
+{
+	std::vector<boost::uint8_t>* ownBuffer = new std::vector<boost::uint8_t>();
+	ownBuffer->swap(_buffer);
+	buffer.reset(ownBuffer);
+
+	data = ownBuffer->empty()? NULL: &(*ownBuffer)[0];
+	size = ownBuffer->size();
+}
+
+CBufferFileView::CBufferFileView(const BufferPtr& _buffer)
+	: buffer(_buffer)
+{
+	data = buffer->empty()? NULL: &(*buffer)[0];
+	size = buffer->size();
+}
+
+
+CMappedFileView* CMappedFileView::Open(const std::string& filePath, size_t offset, size_t size)
+{
+	namespace bip = boost::interprocess;
+
+	// mapping beyond the end of a file would succeed, but fault on access;
+	// empty files can not be mapped at all, callers read those the usual way
+	const size_t fileSize = FileSystemAbstraction::GetFileSize(filePath);
+
+	if (fileSize == size_t(-1) || offset >= fileSize || size > (fileSize - offset))
+		return NULL;
+
+	CMappedFileView* view = new CMappedFileView();
+
+	try {
+		bip::file_mapping(filePath.c_str(), bip::read_only).swap(view->mapping);
+		bip::mapped_region(view->mapping, bip::read_only, offset, size).swap(view->region);
+	} catch (const bip::interprocess_exception& ex) {
+		LOG_L(L_DEBUG, "[MappedFileView::%s] can not map %s: %s", __FUNCTION__, filePath.c_str(), ex.what());
+		delete view;
+		return NULL;
+	}
+
+	view->data = static_cast<const boost::uint8_t*>(view->region.get_address());
+	view->size = view->region.get_size();
+	return view;
+}
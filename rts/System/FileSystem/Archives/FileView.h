@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _FILE_VIEW_H
+#define _FILE_VIEW_H
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/**
+ * @brief Read-only contents of a file
+ *
+ * Lets the contents of a file be used in place instead of being copied into
+ * a buffer of the caller: a view either maps the file into memory, or shares
+ * the buffer the file was extracted to. The bytes stay valid for as long as
+ * the view exists, and must not be written to.
+ */
+class IFileView
+{
+public:
+	virtual ~IFileView() {}
+
+	const boost::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+protected:
+	IFileView(): data(NULL), size(0) {}
+
+	const boost::uint8_t* data;
+	size_t size;
+};
+
+typedef boost::shared_ptr<const IFileView> FileViewPtr;
+
+
+/**
+ * @brief View of a buffer holding the whole file
+ */
+class CBufferFileView : public IFileView
+{
+public:
+	typedef boost::shared_ptr<const std::vector<boost::uint8_t> > BufferPtr;
+
+	/// takes over the contents of <buffer>, leaving it empty
+	CBufferFileView(std::vector<boost::uint8_t>& buffer);
+	/// shares <buffer> (eg. with a cache)
+	CBufferFileView(const BufferPtr& buffer);
+
+private:
+	BufferPtr buffer;
+};
+
+
+/**
+ * @brief View of a file (or a region of it) mapped into memory
+ */
+class CMappedFileView : public IFileView
+{
+public:
+	/**
+	 * @param size bytes to map, 0 maps everything from <offset> on
+	 * @return NULL if the file can not be mapped, eg. because it does not
+	 *   exist, is empty, or is smaller than <offset> + <size>
+	 */
+	static CMappedFileView* Open(const std::string& filePath, size_t offset = 0, size_t size = 0);
+
+private:
+	CMappedFileView() {}
+
+	boost::interprocess::file_mapping mapping;
+	boost::interprocess::mapped_region region;
+};
+
+#endif // _FILE_VIEW_H
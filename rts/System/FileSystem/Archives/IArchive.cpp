@@ -63,3 +63,13 @@ bool IArchive::GetFile(const std::string& name, std::vector<boost::uint8_t>& buf
 
 	return found;
 }
+
+FileViewPtr IArchive::GetFileView(unsigned int fid)
+{
+	std::vector<boost::uint8_t> buffer;
+
+	if (!GetFile(fid, buffer))
+		return FileViewPtr();
+
+	return FileViewPtr(new CBufferFileView(buffer));
+}
@@ -8,6 +8,8 @@
 #include <map>
 #include <boost/cstdint.hpp>
 
+#include "FileView.h"
+
 /**
  * @brief Abstraction of different archive types
  *
@@ -72,6 +74,15 @@ public:
 	 * @see GetFile(unsigned int fid, std::vector<boost::uint8_t>& buffer)
 	 */
 	bool GetFile(const std::string& name, std::vector<boost::uint8_t>& buffer);
+	/**
+	 * Fetches a read-only view of the content of a file by its ID.
+	 * Other than GetFile, this avoids copying the file where possible:
+	 * uncompressed files are mapped into memory, others are extracted
+	 * (at most) once.
+	 * @param fid file ID in [0, NumFiles())
+	 * @return the view, or an empty pointer if the file could not be read
+	 */
+	virtual FileViewPtr GetFileView(unsigned int fid);
 	/**
 	 * Fetches the name and size in bytes of a file by its ID.
 	 */
@@ -90,6 +90,43 @@ unsigned int CZipArchive::GetCrc32(unsigned int fid)
 	return fileData[fid].crc;
 }
 
+FileViewPtr CZipArchive::GetFileView(unsigned int fid)
+{
+	if (!zip) {
+		return FileViewPtr();
+	}
+	assert(IsFileId(fid));
+
+	size_t dataPos = 0;
+
+	{
+		boost::mutex::scoped_lock lck(archiveLock);
+
+		unzGoToFilePos(zip, &fileData[fid].fp);
+
+		unz_file_info fi;
+		unzGetCurrentFileInfo(zip, &fi, NULL, 0, NULL, 0, NULL, 0);
+
+		// stored (uncompressed, unencrypted) entries can be mapped directly
+		// from the archive, the position of their data is only known once
+		// the local header was read
+		if (fi.compression_method == 0 && (fi.flag & 1) == 0 && fi.uncompressed_size > 0 && unzOpenCurrentFile(zip) == UNZ_OK) {
+			dataPos = unzGetCurrentFileZStreamPos64(zip);
+			unzCloseCurrentFile(zip);
+		}
+	}
+
+	if (dataPos > 0) {
+		const FileViewPtr view(CMappedFileView::Open(GetArchiveName(), dataPos, fileData[fid].size));
+
+		if (view != NULL) {
+			return view;
+		}
+	}
+
+	return CBufferedArchive::GetFileView(fid);
+}
+
 // To simplify things, files are always read completely into memory from
 // the zip-file, since zlib does not provide any way of reading more
 // than one file at a time
@@ -37,6 +37,7 @@ public:
 	virtual unsigned int NumFiles() const;
 	virtual void FileInfo(unsigned int fid, std::string& name, int& size) const;
 	virtual unsigned int GetCrc32(unsigned int fid);
+	virtual FileViewPtr GetFileView(unsigned int fid);
 
 protected:
 	unzFile zip;
@@ -65,6 +65,7 @@ bool CFileHandler::TryReadFromPWD(const string& fileName)
 		ifs.seekg(0, std::ios_base::end);
 		fileSize = ifs.tellg();
 		ifs.seekg(0, std::ios_base::beg);
+		rawFilePath = fullpath;
 		return true;
 	}
 	ifs.close();
@@ -81,6 +82,7 @@ bool CFileHandler::TryReadFromRawFS(const string& fileName)
 		ifs.seekg(0, std::ios_base::end);
 		fileSize = ifs.tellg();
 		ifs.seekg(0, std::ios_base::beg);
+		rawFilePath = rawpath;
 		return true;
 	}
 #endif
@@ -97,12 +99,9 @@ bool CFileHandler::TryReadFromModFS(const string& fileName)
 	}
 
 	const string file = StringToLower(fileName);
-	if (vfsHandler->LoadFile(file, fileBuffer)) {
-		// did we allocated more mem than needed
-		// (e.g. because of incorrect usage of std::vector)?
-		assert(fileBuffer.size() == fileBuffer.capacity());
-
-		fileSize = fileBuffer.size();
+	fileView = vfsHandler->LoadFileView(file);
+	if (fileView != NULL) {
+		fileSize = fileView->GetSize();
 		return true;
 	}
 #endif
@@ -184,13 +183,13 @@ int CFileHandler::Read(void* buf, int length)
 		ifs.read(static_cast<char*>(buf), length);
 		return ifs.gcount();
 	}
-	else if (!fileBuffer.empty()) {
+	else if (fileView != NULL) {
 		if ((length + filePos) > fileSize) {
 			length = fileSize - filePos;
 		}
 		if (length > 0) {
-			assert(fileBuffer.size() >= (filePos + length));
-			memcpy(buf, &fileBuffer[filePos], length);
+			assert(fileView->GetSize() >= size_t(filePos + length));
+			memcpy(buf, fileView->GetData() + filePos, length);
 			filePos += length;
 		}
 		return length;
@@ -226,7 +225,7 @@ void CFileHandler::Seek(int length, std::ios_base::seekdir where)
 		ifs.clear();
 		ifs.seekg(length, where);
 	}
-	else if (!fileBuffer.empty())
+	else if (fileView != NULL)
 	{
 		if (where == std::ios_base::beg)
 		{
@@ -248,7 +247,7 @@ bool CFileHandler::Eof() const
 	if (ifs.is_open()) {
 		return ifs.eof();
 	}
-	if (!fileBuffer.empty()) {
+	if (fileView != NULL) {
 		return (filePos >= fileSize);
 	}
 	return true;
@@ -271,6 +270,39 @@ int CFileHandler::GetPos()
 }
 
 
+const boost::uint8_t* CFileHandler::GetData()
+{
+	if (ifs.is_open()) {
+		ifs.clear();
+
+		const int pos = ifs.tellg();
+		FileViewPtr view(CMappedFileView::Open(rawFilePath));
+
+		if (view == NULL) {
+			// eg. an empty file
+			std::vector<boost::uint8_t> buffer(std::max(fileSize, 0));
+
+			ifs.seekg(0, std::ios_base::beg);
+			if (!buffer.empty())
+				ifs.read(reinterpret_cast<char*>(&buffer[0]), buffer.size());
+
+			view.reset(new CBufferFileView(buffer));
+		}
+
+		ifs.close();
+
+		fileView = view;
+		fileSize = fileView->GetSize();
+		filePos = pos;
+	}
+
+	if (fileView == NULL)
+		return NULL;
+
+	return fileView->GetData();
+}
+
+
 bool CFileHandler::LoadStringData(string& data)
 {
 	if (!FileExists()) {
@@ -10,6 +10,7 @@
 #include <boost/cstdint.hpp>
 
 #include "VFSModes.h"
+#include "Archives/FileView.h"
 
 /**
  * This is for direct VFS file content access.
@@ -40,6 +41,15 @@ public:
 	int GetPos();
 	int FileSize() const;
 
+	/**
+	 * @brief read-only access to the whole file, without copying it
+	 * Files from the raw filesystem are mapped into memory on first use,
+	 * the position used by Read() and Seek() is kept.
+	 * Valid for the lifetime of this object, FileSize() bytes long.
+	 * @return NULL if the file does not exist or is empty
+	 */
+	const boost::uint8_t* GetData();
+
 	bool LoadStringData(std::string& data);
 	std::string GetFileExt() const;
 
@@ -71,8 +81,10 @@ private:
 	static bool InsertBaseDirs(std::set<std::string>& dirSet, const std::string& path, const std::string& pattern);
 
 	std::string fileName;
+	/// path of the file opened into <ifs>
+	std::string rawFilePath;
 	std::ifstream ifs;
-	std::vector<boost::uint8_t> fileBuffer;
+	FileViewPtr fileView;
 	int filePos;
 	int fileSize;
 };
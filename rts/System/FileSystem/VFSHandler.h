@@ -8,6 +8,8 @@
 #include <vector>
 #include <boost/cstdint.hpp>
 
+#include "Archives/FileView.h"
+
 class IArchive;
 
 /**
@@ -37,6 +39,16 @@ public:
 	 * @return true if the file exists in the VFS and was successfully read
 	 */
 	bool LoadFile(const std::string& filePath, std::vector<boost::uint8_t>& buffer);
+	/**
+	 * Returns a read-only view of the contents of a file within the VFS,
+	 * which (unlike LoadFile) avoids copying the file where possible.
+	 * @param filePath raw file path, for example "maps/myMap.smf",
+	 *   case-insensitive
+	 * @return the view, or an empty pointer if the file does not exist in the
+	 *   VFS or could not be read
+	 * @see IArchive::GetFileView
+	 */
+	FileViewPtr LoadFileView(const std::string& filePath);
 
 	/**
 	 * Returns all the files in the given (virtual) directory without the
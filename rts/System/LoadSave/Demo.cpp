@@ -2,10 +2,24 @@
 
 #include "Demo.h"
 
+#include "System/FileSystem/FileSystem.h"
+
 #include <cstring>
+#include <iomanip>
+#include <sstream>
 
 CDemo::CDemo():
 	demoName("demos/unnamed.sdf")
 {
 	memset(&fileHeader, 0, sizeof(DemoFileHeader));
 }
+
+std::string CDemo::GetKeyframeFileName(const std::string& demoName, int frameNum)
+{
+	std::ostringstream buf;
+
+	// zero-padded so that lexical order equals frame order
+	buf << "demos/keyframes/" << FileSystem::GetBasename(demoName) << "/";
+	buf << std::setfill('0') << std::setw(8) << frameNum << ".ssf";
+	return buf.str();
+}
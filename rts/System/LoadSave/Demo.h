@@ -19,6 +19,12 @@ public:
 
 	const DemoFileHeader& GetFileHeader() const { return fileHeader; }
 
+	/**
+	@brief savegame written at sim-frame frameNum while watching demoName
+	Loading this savegame resumes playback of the demo from that frame.
+	*/
+	static std::string GetKeyframeFileName(const std::string& demoName, int frameNum);
+
 protected:
 	DemoFileHeader fileHeader;
 	std::string demoName;
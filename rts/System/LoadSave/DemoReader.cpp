@@ -6,12 +6,15 @@
 #include "System/Config/ConfigHandler.h"
 CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to play every replay file (may crash / cause undefined behaviour in replays)");
 #endif
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/Exceptions.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 #include "Game/GameVersion.h"
 
+#include <algorithm>
 #include <limits.h>
 #include <stdexcept>
 #include <cassert>
@@ -122,6 +125,17 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 	}
 }
 
+long CDemoReader::GetDemoStreamEnd() const
+{
+	const long demoStreamStart = fileHeader.headerSize + fileHeader.scriptSize;
+
+	// crashed recordings do not know their stream size, see demofile.h
+	if (fileHeader.demoStreamSize == 0)
+		return playbackDemoSize;
+
+	return (demoStreamStart + fileHeader.demoStreamSize);
+}
+
 bool CDemoReader::ReachedEnd()
 {
 	if (bytesRemaining <= 0 || playbackDemo->Eof() ||
@@ -177,3 +191,90 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+void CDemoReader::BuildIndex()
+{
+	if (!demoIndex.empty())
+		return;
+
+	const long curPos = playbackDemo->GetPos();
+	const long streamEnd = GetDemoStreamEnd();
+
+	long chunkPos = fileHeader.headerSize + fileHeader.scriptSize;
+	int frameNum = 0;
+
+	DemoStreamChunkHeader header;
+	unsigned char msg[1 + sizeof(int)];
+
+	demoIndex.reserve(fileHeader.gameTime * GAME_SPEED + 1);
+	demoIndex.push_back(IndexEntry(frameNum, chunkPos));
+
+	// only the chunk headers and the first bytes of each packet are read
+	while ((chunkPos + (long) sizeof(header)) < streamEnd) {
+		playbackDemo->Seek(chunkPos);
+
+		if (playbackDemo->Read((char*) &header, sizeof(header)) < sizeof(header))
+			break;
+
+		header.swab();
+
+		if (header.length == 0) {
+			chunkPos += sizeof(header);
+			continue;
+		}
+
+		const int msgLength = std::min(header.length, boost::uint32_t(sizeof(msg)));
+
+		if (playbackDemo->Read((char*) msg, msgLength) < msgLength)
+			break;
+
+		chunkPos += (sizeof(header) + header.length);
+
+		if (msg[0] == NETMSG_KEYFRAME && msgLength == sizeof(msg)) {
+			// keyframes carry the frame number, resync on them
+			memcpy(&frameNum, &msg[1], sizeof(int));
+		} else if (msg[0] == NETMSG_KEYFRAME || msg[0] == NETMSG_NEWFRAME) {
+			++frameNum;
+		} else {
+			continue;
+		}
+
+		demoIndex.push_back(IndexEntry(frameNum, chunkPos));
+	}
+
+	playbackDemo->Seek(curPos);
+	LOG_L(L_DEBUG, "[DemoReader::%s] indexed %u frames", __FUNCTION__, unsigned(demoIndex.size()));
+}
+
+bool CDemoReader::SeekToFrame(int frameNum, float curTime)
+{
+	BuildIndex();
+
+	std::vector<IndexEntry>::const_iterator it;
+	for (it = demoIndex.begin(); it != demoIndex.end(); ++it) {
+		if (it->frameNum == frameNum)
+			break;
+	}
+
+	if (it == demoIndex.end())
+		return false;
+
+	const long streamEnd = GetDemoStreamEnd();
+
+	if ((it->filePos + (long) sizeof(chunkHeader)) > streamEnd) {
+		// seeking to the very last frame leaves nothing to read
+		playbackDemo->Seek(streamEnd);
+		bytesRemaining = 0;
+		return true;
+	}
+
+	playbackDemo->Seek(it->filePos);
+	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
+	chunkHeader.swab();
+
+	demoTimeOffset = curTime - chunkHeader.modGameTime - 0.1f;
+	nextDemoReadTime = curTime - 0.01f;
+	bytesRemaining = streamEnd - it->filePos;
+	return true;
+}
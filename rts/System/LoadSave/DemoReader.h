@@ -55,6 +55,27 @@ public:
 	/// Not needed for normal demo watching
 	void LoadStats();
 
+	/**
+	@brief scan the chunk headers of the demo stream and record where each sim-frame begins
+	Not needed for normal demo watching; done lazily by SeekToFrame.
+	*/
+	void BuildIndex();
+	/**
+	@brief position the reader at the first chunk following sim-frame frameNum
+	@return false if the demo does not contain that frame
+	*/
+	bool SeekToFrame(int frameNum, float curTime);
+
+private:
+	struct IndexEntry {
+		IndexEntry(int f, long p): frameNum(f), filePos(p) {}
+
+		int frameNum;   ///< number of sim-frames preceding this chunk
+		long filePos;   ///< position of the chunk header in the file
+	};
+
+	long GetDemoStreamEnd() const;
+
 private:
 	CFileHandler* playbackDemo;
 
@@ -70,6 +91,9 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+
+	/// one entry per sim-frame (empty until BuildIndex)
+	std::vector<IndexEntry> demoIndex;
 };
 
 #endif
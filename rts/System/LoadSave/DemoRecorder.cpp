@@ -7,23 +7,38 @@
 #include "System/FileSystem/FileHandler.h"
 #include "Game/GameVersion.h"
 #include "Sim/Misc/TeamStatistics.h"
+#include "System/Platform/Threading.h"
 #include "System/Util.h"
 #include "System/TimeUtil.h"
 
 #include "System/Log/ILog.h"
 
+#include <boost/bind.hpp>
 #include <cassert>
 #include <cerrno>
 #include <cstring>
+#include <sstream>
 
 
-CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo):
-demoStream(std::ios::binary | std::ios::out)
+/// packets are handed to the writer-thread in chunks of (at least) this size
+static const unsigned int CHUNK_SIZE = 64 * 1024;
+/// SaveToDemo blocks when the writer-thread lags behind by more than this
+static const unsigned int MAX_QUEUED_BYTES = 64 * CHUNK_SIZE;
+
+
+CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo)
+	: writeQueueBytes(0)
+	, streamPos(0)
+	, writerThread(NULL)
+	, writerQuit(false)
 {
 	SetName(mapName, modName, serverDemo);
-	SetFileHeader();
 
 	file.open(demoName.c_str(), std::ios::binary | std::ios::out);
+	chunkBuffer.reserve(CHUNK_SIZE * 2);
+	writerThread = new boost::thread(boost::bind(&CDemoRecorder::WriterThreadFunc, this));
+
+	SetFileHeader();
 }
 
 CDemoRecorder::~CDemoRecorder()
@@ -49,18 +64,18 @@ void CDemoRecorder::SetFileHeader()
 	fileHeader.teamStatPeriod = TeamStatistics::statsPeriod;
 	fileHeader.winningAllyTeamsSize = 0;
 
-	demoStream.seekp(WriteFileHeader(false) + sizeof(DemoFileHeader));
+	// placeholder; patched by WriteFileHeader whenever a field changes
+	DemoFileHeader tmpHeader;
+	memcpy(&tmpHeader, &fileHeader, sizeof(fileHeader));
+	tmpHeader.swab(); // to little endian
+	WriteToStream((char*) &tmpHeader, sizeof(tmpHeader));
 }
 
 void CDemoRecorder::WriteDemoFile()
 {
-	// using operator<<(basic_stringbuf*) requires the stream to be opened with std::ios::in
-	// stringbuf::{eback(), egptr(), gptr()} are protected so we cannot access them directly
-	// (plus data is not guaranteed to be stored contiguously) ==> the only clean OO solution
-	// that avoids str()'s copy would be to supply our own stringbuffer backend to demoStream
-	// which is slightly overdoing it
-	const std::string data = demoStream.str();
-	file.write(data.c_str(), data.size());
+	FlushChunkBuffer();
+	StopWriterThread();
+
 	file.flush();
 	file.close();
 }
@@ -73,7 +88,9 @@ void CDemoRecorder::WriteSetupText(const std::string& text)
 	}
 
 	fileHeader.scriptSize = length;
-	demoStream.write(text.c_str(), length);
+	WriteToStream(text.c_str(), length);
+	// keep the on-disk header usable if we crash before the game ends
+	WriteFileHeader(false);
 }
 
 void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime)
@@ -83,8 +100,8 @@ void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length,
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
-	demoStream.write((char*) &chunkHeader, sizeof(chunkHeader));
-	demoStream.write((char*) buf, length);
+	WriteToStream((char*) &chunkHeader, sizeof(chunkHeader));
+	WriteToStream((char*) buf, length);
 	fileHeader.demoStreamSize += length + sizeof(chunkHeader);
 }
 
@@ -169,16 +186,12 @@ void CDemoRecorder::SetWinningAllyTeams(const std::vector<unsigned char>& winnin
 }
 
 /** @brief Write DemoFileHeader
-Write the DemoFileHeader at the start of the file and restores the original
-position in the file afterwards. */
-unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
+Queues a rewrite of the DemoFileHeader at the start of the file; the
+writer-thread restores the append position afterwards. */
+void CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 {
-#ifdef _MSC_VER // MSVC8 behaves strange if tell/seek is called before anything has been written
-	const bool empty = (demoStream.str() == "");
-	const unsigned int pos = empty? 0 : demoStream.tellp();
-#else
-	const unsigned int pos = demoStream.tellp();
-#endif
+	// the placeholder header must reach the file before it can be patched
+	FlushChunkBuffer();
 
 	DemoFileHeader tmpHeader;
 	memcpy(&tmpHeader, &fileHeader, sizeof(fileHeader));
@@ -186,18 +199,10 @@ unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 		tmpHeader.demoStreamSize = 0;
 	tmpHeader.swab(); // to little endian
 
-#ifdef _MSC_VER
-	if (!empty)
-#endif
-	{
-		demoStream.seekp(0);
-	}
-
-
-	demoStream.write((char*) &tmpHeader, sizeof(tmpHeader));
-	demoStream.seekp(pos);
-
-	return pos;
+	WriteRequest req;
+	req.data.assign((char*) &tmpHeader, ((char*) &tmpHeader) + sizeof(tmpHeader));
+	req.headerPatch = true;
+	QueueWriteRequest(req);
 }
 
 /** @brief Write the CPlayer::Statistics at the current position in the file. */
@@ -206,16 +211,16 @@ void CDemoRecorder::WritePlayerStats()
 	if (fileHeader.numPlayers == 0)
 		return;
 
-	int pos = demoStream.tellp();
+	const unsigned int pos = streamPos;
 
 	for (std::vector< PlayerStatistics >::iterator it = playerStats.begin(); it != playerStats.end(); ++it) {
 		PlayerStatistics& stats = *it;
 		stats.swab();
-		demoStream.write(reinterpret_cast<char*>(&stats), sizeof(PlayerStatistics));
+		WriteToStream(reinterpret_cast<char*>(&stats), sizeof(PlayerStatistics));
 	}
 	playerStats.clear();
 
-	fileHeader.playerStatSize = (int)demoStream.tellp() - pos;
+	fileHeader.playerStatSize = streamPos - pos;
 }
 
 
@@ -226,16 +231,16 @@ void CDemoRecorder::WriteWinnerList()
 	if (fileHeader.numTeams == 0)
 		return;
 
-	const int pos = demoStream.tellp();
+	const unsigned int pos = streamPos;
 
 	// Write the array of winningAllyTeams.
 	for (std::vector<unsigned char>::const_iterator it = winningAllyTeams.begin(); it != winningAllyTeams.end(); ++it) {
-		demoStream.write((char*) &(*it), sizeof(unsigned char));
+		WriteToStream((const char*) &(*it), sizeof(unsigned char));
 	}
 
 	winningAllyTeams.clear();
 
-	fileHeader.winningAllyTeamsSize = int(demoStream.tellp()) - pos;
+	fileHeader.winningAllyTeamsSize = streamPos - pos;
 }
 
 /** @brief Write the TeamStatistics at the current position in the file. */
@@ -244,12 +249,12 @@ void CDemoRecorder::WriteTeamStats()
 	if (fileHeader.numTeams == 0)
 		return;
 
-	int pos = demoStream.tellp();
+	const unsigned int pos = streamPos;
 
 	// Write array of dwords indicating number of TeamStatistics per team.
 	for (std::vector< std::vector< TeamStatistics > >::iterator it = teamStats.begin(); it != teamStats.end(); ++it) {
 		unsigned int c = swabDWord(it->size());
-		demoStream.write((char*)&c, sizeof(unsigned int));
+		WriteToStream((char*)&c, sizeof(unsigned int));
 	}
 
 	// Write big array of TeamStatistics.
@@ -257,10 +262,113 @@ void CDemoRecorder::WriteTeamStats()
 		for (std::vector< TeamStatistics >::iterator it2 = it->begin(); it2 != it->end(); ++it2) {
 			TeamStatistics& stats = *it2;
 			stats.swab();
-			demoStream.write(reinterpret_cast<char*>(&stats), sizeof(TeamStatistics));
+			WriteToStream(reinterpret_cast<char*>(&stats), sizeof(TeamStatistics));
 		}
 	}
 	teamStats.clear();
 
-	fileHeader.teamStatSize = (int)demoStream.tellp() - pos;
+	fileHeader.teamStatSize = streamPos - pos;
+}
+
+
+void CDemoRecorder::WriteToStream(const char* data, unsigned int size)
+{
+	chunkBuffer.insert(chunkBuffer.end(), data, data + size);
+	streamPos += size;
+
+	if (chunkBuffer.size() >= CHUNK_SIZE)
+		FlushChunkBuffer();
+}
+
+/** @brief Hand the buffered data over to the writer-thread */
+void CDemoRecorder::FlushChunkBuffer()
+{
+	if (chunkBuffer.empty())
+		return;
+
+	WriteRequest req;
+	req.data.reserve(CHUNK_SIZE * 2);
+	req.data.swap(chunkBuffer);
+	QueueWriteRequest(req);
+}
+
+void CDemoRecorder::QueueWriteRequest(WriteRequest& req)
+{
+	boost::mutex::scoped_lock lock(writerMutex);
+
+	// bound memory usage if the disk cannot keep up
+	while (writeQueueBytes >= MAX_QUEUED_BYTES && writerThread != NULL)
+		writerDoneCond.wait(lock);
+
+	writeQueueBytes += req.data.size();
+	writeQueue.push_back(WriteRequest());
+	writeQueue.back().data.swap(req.data);
+	writeQueue.back().headerPatch = req.headerPatch;
+	writerCond.notify_one();
+}
+
+void CDemoRecorder::StopWriterThread()
+{
+	if (writerThread == NULL)
+		return;
+
+	{
+		boost::mutex::scoped_lock lock(writerMutex);
+		writerQuit = true;
+		writerCond.notify_one();
+	}
+
+	writerThread->join();
+	delete writerThread;
+	writerThread = NULL;
+}
+
+__FORCE_ALIGN_STACK__
+void CDemoRecorder::WriterThreadFunc()
+{
+	Threading::SetThreadName("demo-writer");
+
+	WriteRequest req;
+	bool writeError = false;
+
+	while (true) {
+		{
+			boost::mutex::scoped_lock lock(writerMutex);
+
+			while (writeQueue.empty() && !writerQuit)
+				writerCond.wait(lock);
+
+			// only quit once everything has been written
+			if (writeQueue.empty())
+				break;
+
+			req.data.swap(writeQueue.front().data);
+			req.headerPatch = writeQueue.front().headerPatch;
+			writeQueue.pop_front();
+		}
+
+		if (req.headerPatch) {
+			file.seekp(0, std::ios::beg);
+			file.write(&req.data[0], req.data.size());
+			file.seekp(0, std::ios::end);
+		} else {
+			file.write(&req.data[0], req.data.size());
+		}
+
+		// push everything out so a crash loses at most the unflushed chunk
+		file.flush();
+
+		if (!file.good() && !writeError) {
+			writeError = true;
+			LOG_L(L_ERROR, "[DemoRecorder] error writing demo %s: %s", demoName.c_str(), strerror(errno));
+		}
+
+		{
+			boost::mutex::scoped_lock lock(writerMutex);
+			writeQueueBytes -= req.data.size();
+			writerDoneCond.notify_all();
+		}
+
+		req.data.clear();
+	}
 }
@@ -4,16 +4,26 @@
 #define DEMO_RECORDER
 
 #include <vector>
+#include <deque>
 #include <fstream>
-#include <sstream>
 #include <list>
 
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
 #include "Demo.h"
 #include "Game/Players/PlayerStatistics.h"
 #include "Sim/Misc/TeamStatistics.h"
 
 /**
  * @brief Used to record demos
+ *
+ * Recorded packets are collected into fixed-size chunks which are handed
+ * to a background thread that appends them to the demo file, so memory use
+ * stays bounded regardless of game length. The DemoFileHeader is written
+ * as a placeholder (demoStreamSize = 0, as for a crashed recording) and
+ * patched with the final sizes when the recorder is destroyed.
  */
 class CDemoRecorder : public CDemo
 {
@@ -39,19 +49,47 @@ public:
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
 private:
-	unsigned int WriteFileHeader(bool updateStreamLength);
+	struct WriteRequest {
+		WriteRequest(): headerPatch(false) {}
+
+		std::vector<char> data;
+		/// if true, data is written at the start of the file instead of appended
+		bool headerPatch;
+	};
+
+	void WriteFileHeader(bool updateStreamLength);
 	void SetFileHeader();
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
 	void WriteDemoFile();
 
+	void WriteToStream(const char* data, unsigned int size);
+	void FlushChunkBuffer();
+	void QueueWriteRequest(WriteRequest& req);
+	void StopWriterThread();
+	void WriterThreadFunc();
+
 private:
+	/// written by the writer-thread only while it is running
 	std::ofstream file;
-	std::stringstream demoStream;
+
+	/// packets are accumulated here until chunkBuffer holds CHUNK_SIZE bytes
+	std::vector<char> chunkBuffer;
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
+
+	std::deque<WriteRequest> writeQueue;
+	unsigned int writeQueueBytes;
+	/// total number of bytes (header included) sent to the file so far
+	unsigned int streamPos;
+
+	boost::thread* writerThread;
+	boost::mutex writerMutex;
+	boost::condition_variable writerCond;
+	boost::condition_variable writerDoneCond;
+	bool writerQuit;
 };
 
 
@@ -13,6 +13,8 @@ const std::string ConnectAutohost = "Connecting to autohost on port %d";
 const std::string ConnectAutohostFailed = "Failed connecting to autohost on IP %s, port %d";
 const std::string DemoStart = "Beginning demo playback";
 const std::string DemoEnd = "End of demo reached";
+const std::string RelayStart = "Relaying game from upstream server";
+const std::string RelayEnd = "Upstream server closed the relayed game (%s)";
 const std::string GameEnd = "Game has ended";
 const std::string NoClientsExit = "No clients connected, shutting down server";
 
@@ -6,6 +6,7 @@
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "Exception.h"
 #include "ProtocolDef.h"
+#include "PacketBlock.h"
 #include "System/Log/ILog.h"
 
 namespace netcode {
@@ -48,6 +49,14 @@ void CLocalConnection::SendData(boost::shared_ptr<const RawPacket> packet)
 
 	// when sending from A to B we must lock B's queue
 	boost::mutex::scoped_lock scoped_lock(mutexes[OtherInstance()]);
+
+	if (PacketBlock::IsBlock(packet.get())) {
+		// expand right away, as UDPConnection does on arrival
+		if (!PacketBlock::Unpack(packet.get(), pqueues[OtherInstance()]))
+			LOG_L(L_ERROR, "[%s] discarding invalid packet block: LEN %d", __FUNCTION__, packet->length);
+		return;
+	}
+
 	pqueues[OtherInstance()].push_back(packet);
 }
 
@@ -0,0 +1,96 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PacketBlock.h"
+#include "PackPacket.h"
+#include "ProtocolDef.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/Log/ILog.h"
+
+#include <cstring>
+#include <boost/cstdint.hpp>
+#include <zlib.h>
+
+namespace netcode
+{
+
+static const unsigned HEADER_SIZE = 1 + sizeof(boost::uint16_t) + sizeof(boost::uint32_t);
+
+
+RawPacket* PacketBlock::Pack(const std::vector< boost::shared_ptr<const RawPacket> >& packets)
+{
+	std::vector<boost::uint8_t> content;
+
+	for (size_t n = 0; n < packets.size(); n++) {
+		const RawPacket* p = packets[n].get();
+		content.insert(content.end(), p->data, p->data + p->length);
+	}
+
+	if (content.empty() || content.size() > MAX_CONTENT_SIZE)
+		return NULL;
+
+	// compressBound(MAX_CONTENT_SIZE) + HEADER_SIZE always fits a ushort
+	uLongf compressedSize = compressBound(content.size());
+	std::vector<boost::uint8_t> compressed(compressedSize);
+
+	if (compress2(&compressed[0], &compressedSize, &content[0], content.size(), Z_BEST_SPEED) != Z_OK)
+		return NULL;
+
+	compressed.resize(compressedSize);
+
+	PackPacket* block = new PackPacket(HEADER_SIZE + compressed.size(), NETMSG_PACKET_BLOCK);
+	*block << boost::uint16_t(block->length);
+	*block << boost::uint32_t(content.size());
+	*block << compressed;
+	return block;
+}
+
+
+bool PacketBlock::Unpack(const RawPacket* block, std::deque< boost::shared_ptr<const RawPacket> >& packets)
+{
+	if (!IsBlock(block) || block->length <= HEADER_SIZE)
+		return false;
+
+	// the size field follows the ID and length bytes, so it is unaligned
+	boost::uint32_t contentSize = 0;
+	memcpy(&contentSize, block->data + 1 + sizeof(boost::uint16_t), sizeof(contentSize));
+
+	// a block never holds more than this, do not let a bogus size
+	// make us allocate arbitrary amounts of memory
+	if (contentSize == 0 || contentSize > MAX_CONTENT_SIZE)
+		return false;
+
+	std::vector<boost::uint8_t> content(contentSize);
+	uLongf size = contentSize;
+
+	if (uncompress(&content[0], &size, block->data + HEADER_SIZE, block->length - HEADER_SIZE) != Z_OK || size != contentSize)
+		return false;
+
+	const ProtocolDef* proto = ProtocolDef::GetInstance();
+	const size_t numPackets = packets.size();
+
+	for (unsigned pos = 0; pos < contentSize; ) {
+		const unsigned char* bufp = &content[pos];
+		const unsigned bufLength = contentSize - pos;
+		const int pktLength = proto->PacketLength(bufp, bufLength);
+
+		// blocks must not be nested, nor hold partial packets
+		if (!proto->IsValidLength(pktLength, bufLength) || *bufp == NETMSG_PACKET_BLOCK) {
+			LOG_L(L_ERROR, "[PacketBlock::%s] invalid packet in block: ID %d, LEN %d", __FUNCTION__, (int)*bufp, pktLength);
+			packets.resize(numPackets);
+			return false;
+		}
+
+		packets.push_back(boost::shared_ptr<const RawPacket>(new RawPacket(bufp, pktLength)));
+		pos += pktLength;
+	}
+
+	return true;
+}
+
+
+bool PacketBlock::IsBlock(const RawPacket* packet)
+{
+	return (packet->length > 0 && packet->data[0] == NETMSG_PACKET_BLOCK);
+}
+
+} // namespace netcode
@@ -0,0 +1,46 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _PACKET_BLOCK_H
+#define _PACKET_BLOCK_H
+
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <vector>
+
+namespace netcode
+{
+
+class RawPacket;
+
+/**
+ * @brief Runs of packets compressed (zlib) into a single packet
+ *
+ * Used to send large backlogs, such as the server's packet cache, to
+ * late-joining clients. Connections expand a block back into the packets
+ * it contains as soon as it arrives, so nothing above them ever sees one.
+ *
+ * Layout: uchar NETMSG_PACKET_BLOCK, ushort size, uint contentSize,
+ * followed by the compressed packets (concatenated as on the wire).
+ */
+namespace PacketBlock
+{
+	/// upper bound for the combined uncompressed size of the packets in a block
+	static const unsigned MAX_CONTENT_SIZE = 48 * 1024;
+
+	/**
+	 * @return the block, or NULL if <packets> exceed MAX_CONTENT_SIZE
+	 */
+	RawPacket* Pack(const std::vector< boost::shared_ptr<const RawPacket> >& packets);
+
+	/**
+	 * @brief append the packets contained in <block> to <packets>
+	 * @return false (and append nothing) if the block is malformed
+	 */
+	bool Unpack(const RawPacket* block, std::deque< boost::shared_ptr<const RawPacket> >& packets);
+
+	bool IsBlock(const RawPacket* packet);
+}
+
+} // namespace netcode
+
+#endif // _PACKET_BLOCK_H
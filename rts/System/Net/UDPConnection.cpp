@@ -9,6 +9,8 @@
 
 #include "Socket.h"
 #include "ProtocolDef.h"
+#include "PacketBlock.h"
+#include "UDPSendBatch.h"
 #include "Exception.h"
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "System/Config/ConfigHandler.h"
@@ -239,10 +241,11 @@ void Packet::Serialize(std::vector<boost::uint8_t>& data)
 
 
 
-UDPConnection::UDPConnection(boost::shared_ptr<ip::udp::socket> netSocket, const ip::udp::endpoint& myAddr)
+UDPConnection::UDPConnection(boost::shared_ptr<ip::udp::socket> netSocket, const ip::udp::endpoint& myAddr, boost::shared_ptr<UDPSendBatch> netSendBatch)
 	: addr(myAddr)
 	, sharedSocket(true)
 	, mySocket(netSocket)
+	, sendBatch(netSendBatch)
 {
 	Init();
 }
@@ -329,12 +332,13 @@ void UDPConnection::ReconnectTo(CConnection& conn) {
 }
 
 void UDPConnection::CopyConnection(UDPConnection &conn) {
-	conn.InitConnection(addr, mySocket);
+	conn.InitConnection(addr, mySocket, sendBatch);
 }
 
-void UDPConnection::InitConnection(ip::udp::endpoint address, boost::shared_ptr<ip::udp::socket> socket) {
+void UDPConnection::InitConnection(ip::udp::endpoint address, boost::shared_ptr<ip::udp::socket> socket, boost::shared_ptr<UDPSendBatch> batch) {
 	addr = address;
 	mySocket = socket;
+	sendBatch = batch;
 }
 
 UDPConnection::~UDPConnection()
@@ -574,6 +578,17 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 			// this returns false for zero/invalid pktlength
 			if (ProtocolDef::GetInstance()->IsValidLength(pktlength, msglength)) {
+				if (*bufp == NETMSG_PACKET_BLOCK) {
+					// queue the packets it contains instead
+					const RawPacket block(bufp, pktlength);
+
+					if (!PacketBlock::Unpack(&block, msgQueue))
+						LOG_L(L_ERROR, "Discarding incoming invalid packet block: LEN %d", pktlength);
+
+					pos += pktlength;
+					continue;
+				}
+
 				msgQueue.push_back(boost::shared_ptr<const RawPacket>(new RawPacket(bufp, pktlength)));
 
 				#ifdef ENABLE_DEBUG_STATS
@@ -938,7 +953,8 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 void UDPConnection::SendPacket(Packet& pkt)
 {
-	std::vector<boost::uint8_t> data;
+	std::vector<boost::uint8_t>& data = sendBuffer;
+	data.clear();
 	pkt.Serialize(data);
 
 	outgoing.DataSent(data.size());
@@ -947,7 +963,13 @@ void UDPConnection::SendPacket(Packet& pkt)
 	boost::system::error_code err;
 
 	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(data), addr, flags, err);
+		if (sendBatch != NULL) {
+			// errors are reported by the batch itself; the packet is counted
+			// below either way, like queued ones whose SendAll fails later
+			sendBatch->Add(addr, &data[0], data.size());
+		} else {
+			mySocket->send_to(buffer(data), addr, flags, err);
+		}
 	}
 
 	if (CheckErrorCode(err))
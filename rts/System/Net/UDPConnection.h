@@ -17,6 +17,8 @@ class CRC;
 
 namespace netcode {
 
+class UDPSendBatch;
+
 // for reliability testing, introduce fake packet loss with a percentage probability
 #define NETWORK_TEST 0                        // in [0, 1] // enable network reliability testing mode
 #define PACKET_LOSS_FACTOR 50                 // in [0, 100)
@@ -76,7 +78,8 @@ class UDPConnection : public CConnection
 {
 public:
 	UDPConnection(boost::shared_ptr<boost::asio::ip::udp::socket> netSocket,
-			const boost::asio::ip::udp::endpoint& myAddr);
+			const boost::asio::ip::udp::endpoint& myAddr,
+			boost::shared_ptr<UDPSendBatch> netSendBatch);
 	UDPConnection(int sourceport, const std::string& address,
 			const unsigned port);
 	UDPConnection(CConnection& conn);
@@ -126,7 +129,8 @@ public:
 
 private:
 	void InitConnection(boost::asio::ip::udp::endpoint address,
-			boost::shared_ptr<boost::asio::ip::udp::socket> socket);
+			boost::shared_ptr<boost::asio::ip::udp::socket> socket,
+			boost::shared_ptr<UDPSendBatch> batch);
 
 	void CopyConnection(UDPConnection& conn);
 
@@ -200,6 +204,11 @@ private:
 
 	/// Our socket
 	boost::shared_ptr<boost::asio::ip::udp::socket> mySocket;
+	/// set if mySocket is shared through an UDPListener, queues our datagrams
+	boost::shared_ptr<UDPSendBatch> sendBatch;
+
+	/// reused by SendPacket
+	std::vector<boost::uint8_t> sendBuffer;
 
 	RawPacket* fragmentBuffer;
 
@@ -16,6 +16,7 @@
 
 #include "ProtocolDef.h"
 #include "UDPConnection.h"
+#include "UDPSendBatch.h"
 #include "Socket.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
@@ -38,6 +39,7 @@ UDPListener::UDPListener(int port, const std::string& ip)
 		socket->io_control(socketCommand);
 
 		mySocket = socket;
+		sendBatch.reset(new UDPSendBatch(mySocket));
 		SetAcceptingConnections(true);
 	}
 
@@ -138,7 +140,7 @@ void UDPListener::Update() {
 			if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
 				if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
 					// new client wants to connect
-					boost::shared_ptr<UDPConnection> incoming(new UDPConnection(mySocket, sender_endpoint));
+					boost::shared_ptr<UDPConnection> incoming(new UDPConnection(mySocket, sender_endpoint, sendBatch));
 					waiting.push(incoming);
 					conn[sender_endpoint] = incoming;
 					incoming->ProcessRawPacket(data);
@@ -159,6 +161,8 @@ void UDPListener::Update() {
 		}
 	}
 
+	sendBatch->Begin();
+
 	for (ConnMap::iterator i = conn.begin(); i != conn.end(); ) {
 		if (i->second.expired()) {
 			LOG_L(L_DEBUG, "Connection closed: [%s]:%i", i->first.address().to_string().c_str(), i->first.port());
@@ -168,11 +172,13 @@ void UDPListener::Update() {
 		i->second.lock()->Update();
 		++i;
 	}
+
+	sendBatch->End();
 }
 
 boost::shared_ptr<UDPConnection> UDPListener::SpawnConnection(const std::string& ip, const unsigned port)
 {
-	boost::shared_ptr<UDPConnection> newConn(new UDPConnection(mySocket, ip::udp::endpoint(WrapIP(ip), port)));
+	boost::shared_ptr<UDPConnection> newConn(new UDPConnection(mySocket, ip::udp::endpoint(WrapIP(ip), port), sendBatch));
 	conn[newConn->GetEndpoint()] = newConn;
 	return newConn;
 }
@@ -15,6 +15,7 @@
 namespace netcode
 {
 class UDPConnection;
+class UDPSendBatch;
 typedef boost::shared_ptr<boost::asio::ip::udp::socket> SocketPtr;
 
 /**
@@ -91,6 +92,9 @@ private:
 	/// typedef boost::shared_ptr<boost::asio::ip::udp::socket> SocketPtr;
 	SocketPtr mySocket;
 
+	/// datagrams sent by our connections during Update go out together
+	boost::shared_ptr<UDPSendBatch> sendBatch;
+
 	/// all connections
 	typedef std::map< boost::asio::ip::udp::endpoint, boost::weak_ptr<UDPConnection> > ConnMap;
 	ConnMap conn;
@@ -0,0 +1,132 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "UDPSendBatch.h"
+#include "Socket.h"
+
+#if defined(__linux__)
+	#include <sys/socket.h>
+	#include <errno.h>
+#endif
+
+#include <algorithm>
+
+
+namespace netcode
+{
+using namespace boost::asio;
+
+UDPSendBatch::UDPSendBatch(boost::shared_ptr<ip::udp::socket> _socket)
+	: socket(_socket)
+	, open(false)
+{
+}
+
+void UDPSendBatch::Begin()
+{
+	open = true;
+}
+
+void UDPSendBatch::End()
+{
+	open = false;
+
+	if (datagrams.empty())
+		return;
+
+	SendAll();
+
+	payload.clear();
+	datagrams.clear();
+}
+
+bool UDPSendBatch::Add(const ip::udp::endpoint& to, const boost::uint8_t* data, size_t size)
+{
+	if (!open) {
+		ip::udp::socket::message_flags flags = 0;
+		boost::system::error_code err;
+
+		socket->send_to(buffer(data, size), to, flags, err);
+		return !CheckErrorCode(err);
+	}
+
+	Datagram d;
+	d.to = to;
+	d.offset = payload.size();
+	d.size = size;
+
+	payload.insert(payload.end(), data, data + size);
+	datagrams.push_back(d);
+	return true;
+}
+
+bool UDPSendBatch::SendAll()
+{
+#if defined(__linux__)
+	struct mmsghdr msgs[MAX_BATCH_SIZE];
+	struct iovec iovecs[MAX_BATCH_SIZE];
+
+	const int fd = socket->native_handle();
+
+	for (size_t beg = 0; beg < datagrams.size(); ) {
+		const size_t num = std::min(datagrams.size() - beg, size_t(MAX_BATCH_SIZE));
+
+		for (size_t n = 0; n < num; n++) {
+			Datagram& d = datagrams[beg + n];
+
+			iovecs[n].iov_base = &payload[d.offset];
+			iovecs[n].iov_len  = d.size;
+
+			msgs[n].msg_hdr.msg_name       = d.to.data();
+			msgs[n].msg_hdr.msg_namelen    = d.to.size();
+			msgs[n].msg_hdr.msg_iov        = &iovecs[n];
+			msgs[n].msg_hdr.msg_iovlen     = 1;
+			msgs[n].msg_hdr.msg_control    = NULL;
+			msgs[n].msg_hdr.msg_controllen = 0;
+			msgs[n].msg_hdr.msg_flags      = 0;
+			msgs[n].msg_len                = 0;
+		}
+
+		const int numSent = sendmmsg(fd, msgs, num, 0);
+
+		if (numSent < 0) {
+			if (errno == EINTR)
+				continue;
+
+			boost::system::error_code err(errno, boost::system::system_category());
+
+			// socket buffer is full; what is not sent
+			// counts as lost and gets resent as usual
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+				return !CheckErrorCode(err);
+
+			// only the first datagram failed (eg. unreachable
+			// receiver), do not let it block all others
+			CheckErrorCode(err);
+			beg += 1;
+			continue;
+		}
+
+		// on a short count the next call reports the error (if any)
+		if (numSent == 0)
+			break;
+
+		beg += numSent;
+	}
+
+	return true;
+#else
+	bool ret = true;
+
+	for (const Datagram& d: datagrams) {
+		ip::udp::socket::message_flags flags = 0;
+		boost::system::error_code err;
+
+		socket->send_to(buffer(&payload[d.offset], d.size), d.to, flags, err);
+		ret &= !CheckErrorCode(err);
+	}
+
+	return ret;
+#endif
+}
+
+}
@@ -0,0 +1,58 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _UDP_SEND_BATCH_H
+#define _UDP_SEND_BATCH_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/cstdint.hpp>
+#include <vector>
+
+namespace netcode
+{
+
+/**
+ * @brief Collects outgoing datagrams of all connections sharing one socket
+ *
+ * While a batch is open (between Begin and End), Add only queues the
+ * datagram; End then hands all of them to the kernel at once (a single
+ * sendmmsg call per MAX_BATCH_SIZE datagrams on Linux, one send_to each
+ * elsewhere). Outside of that, Add sends immediately, so connections that
+ * flush on their own (shutdown, new clients) are not delayed.
+ */
+class UDPSendBatch : boost::noncopyable
+{
+public:
+	UDPSendBatch(boost::shared_ptr<boost::asio::ip::udp::socket> socket);
+
+	void Begin();
+	void End();
+
+	/// @return false if the datagram could not be sent right away
+	bool Add(const boost::asio::ip::udp::endpoint& to, const boost::uint8_t* data, size_t size);
+
+	static const unsigned int MAX_BATCH_SIZE = 256;
+
+private:
+	bool SendAll();
+
+private:
+	struct Datagram {
+		boost::asio::ip::udp::endpoint to;
+		size_t offset;
+		size_t size;
+	};
+
+	boost::shared_ptr<boost::asio::ip::udp::socket> socket;
+
+	/// payloads of all queued datagrams, back to back
+	std::vector<boost::uint8_t> payload;
+	std::vector<Datagram> datagrams;
+
+	bool open;
+};
+
+}
+
+#endif // _UDP_SEND_BATCH_H
@@ -0,0 +1,171 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "System/creg/creg_cond.h"
+
+/**
+ * @brief Dense array of values addressed through stable integer IDs
+ *
+ * Values are stored contiguously (iteration is a linear walk over memory),
+ * an ID-to-index table gives O(1) lookup and removal. An ID encodes a slot
+ * in the table plus a small generation counter that is bumped whenever the
+ * slot is released, so stale IDs do not alias a newer value in the same
+ * slot. Released slots are reused in FIFO order to delay recycling.
+ *
+ * IDs stay below 2^24 so they survive a round-trip through (float) Lua.
+ */
+template<typename T>
+class SlotMap {
+	CR_DECLARE_STRUCT(SlotMap);
+
+public:
+	static const int INDEX_BITS = 20;
+	static const int INDEX_MASK = (1 << INDEX_BITS) - 1;
+	static const int GENERATION_MASK = 0xF;
+
+	static const unsigned int MAX_SIZE = INDEX_MASK + 1;
+
+	typedef typename std::vector<T>::iterator iterator;
+	typedef typename std::vector<T>::const_iterator const_iterator;
+
+	/// @return the ID under which <v> can be found
+	int insert(const T& v) {
+		int slot = 0;
+
+		if (!freeSlots.empty()) {
+			slot = freeSlots.front();
+			freeSlots.pop_front();
+		} else {
+			assert(slotIndices.size() < MAX_SIZE);
+
+			slot = slotIndices.size();
+			slotIndices.push_back(-1);
+			slotGenerations.push_back(0);
+		}
+
+		const int id = (slotGenerations[slot] << INDEX_BITS) | slot;
+
+		slotIndices[slot] = values.size();
+		values.push_back(v);
+		valueIDs.push_back(id);
+		return id;
+	}
+
+	T* find(int id) {
+		const int idx = GetIndex(id);
+		return ((idx >= 0)? &values[idx]: NULL);
+	}
+	const T* find(int id) const {
+		const int idx = GetIndex(id);
+		return ((idx >= 0)? &values[idx]: NULL);
+	}
+
+	/// O(1), moves the last value into the hole (does not preserve order)
+	bool erase(int id) {
+		const int idx = GetIndex(id);
+
+		if (idx < 0)
+			return false;
+
+		if (idx != int(values.size() - 1)) {
+			values[idx] = values.back();
+			valueIDs[idx] = valueIDs.back();
+			slotIndices[valueIDs[idx] & INDEX_MASK] = idx;
+		}
+
+		values.pop_back();
+		valueIDs.pop_back();
+		ReleaseSlot(id);
+		return true;
+	}
+
+	/**
+	 * Calls <f> on every value in order and drops those for which it
+	 * returns false, keeping the relative order of the others (linear).
+	 * <f> may insert new values, which are visited by the same pass, and
+	 * may look values up by ID; it must not erase any.
+	 */
+	template<typename F>
+	void filter(F f) {
+		unsigned int w = 0;
+
+		for (unsigned int r = 0; r < values.size(); r++) {
+			// copy; insertions from <f> can reallocate <values>
+			const T v = values[r];
+			const int id = valueIDs[r];
+
+			if (!f(v)) {
+				ReleaseSlot(id);
+				continue;
+			}
+
+			if (w != r) {
+				values[w] = values[r];
+				valueIDs[w] = id;
+				slotIndices[id & INDEX_MASK] = w;
+			}
+
+			w++;
+		}
+
+		values.resize(w);
+		valueIDs.resize(w);
+	}
+
+	void clear() {
+		for (unsigned int n = 0; n < valueIDs.size(); n++) {
+			ReleaseSlot(valueIDs[n]);
+		}
+
+		values.clear();
+		valueIDs.clear();
+	}
+
+	size_t size() const { return values.size(); }
+	bool empty() const { return values.empty(); }
+
+	iterator begin() { return values.begin(); }
+	iterator end() { return values.end(); }
+	const_iterator begin() const { return values.begin(); }
+	const_iterator end() const { return values.end(); }
+
+	T& operator [] (unsigned int idx) { return values[idx]; }
+	const T& operator [] (unsigned int idx) const { return values[idx]; }
+
+private:
+	int GetIndex(int id) const {
+		const unsigned int slot = id & INDEX_MASK;
+
+		if (id < 0 || slot >= slotIndices.size())
+			return -1;
+		if (slotGenerations[slot] != ((id >> INDEX_BITS) & GENERATION_MASK))
+			return -1;
+
+		return slotIndices[slot];
+	}
+
+	void ReleaseSlot(int id) {
+		const int slot = id & INDEX_MASK;
+
+		slotIndices[slot] = -1;
+		slotGenerations[slot] = (slotGenerations[slot] + 1) & GENERATION_MASK;
+		freeSlots.push_back(slot);
+	}
+
+public: //!needed by CREG
+	std::vector<T> values;
+	std::vector<int> valueIDs;
+
+	std::vector<int> slotIndices;
+	std::vector<int> slotGenerations;
+	std::deque<int> freeSlots;
+};
+
+#endif // SLOT_MAP_H
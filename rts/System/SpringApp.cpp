@@ -632,6 +632,8 @@ void SpringApp::ParseCmdLine(const std::string& binaryName)
 	cmdline->AddSwitch('t', "textureatlas",       "Dump each finalized textureatlas in textureatlasN.tga");
 	cmdline->AddInt(   0,   "benchmark",          "Enable benchmark mode (writes a benchmark.data file). The given number specifies the timespan to test.");
 	cmdline->AddInt(   0,   "benchmarkstart",     "Benchmark start time in minutes.");
+	cmdline->AddString(0,   "benchmark-timings",  "Write per-SimFrame subsystem timings (tab-separated, in ms) to the given file and run the simulation unthrottled. Implies --benchmark.");
+	cmdline->AddString(0,   "benchmark-pathsearches", "Write the tested blocks and time of a fixed set of long path-searches, with 0 up to all coarse estimator levels, to the given file at the benchmark start. Implies --benchmark.");
 
 	cmdline->AddSwitch(0,   "list-ai-interfaces", "Dump a list of available AI Interfaces to stdout");
 	cmdline->AddSwitch(0,   "list-skirmish-ais",  "Dump a list of available Skirmish AIs to stdout");
@@ -751,12 +753,22 @@ void SpringApp::ParseCmdLine(const std::string& binaryName)
 		}
 	}
 
-	if (cmdline->IsSet("benchmark")) {
+	if (cmdline->IsSet("benchmark") || cmdline->IsSet("benchmark-timings") || cmdline->IsSet("benchmark-pathsearches")) {
 		CBenchmark::enabled = true;
 		if (cmdline->IsSet("benchmarkstart")) {
 			CBenchmark::startFrame = cmdline->GetInt("benchmarkstart") * 60 * GAME_SPEED;
 		}
-		CBenchmark::endFrame = CBenchmark::startFrame + cmdline->GetInt("benchmark") * 60 * GAME_SPEED;
+		if (cmdline->IsSet("benchmark")) {
+			CBenchmark::endFrame = CBenchmark::startFrame + cmdline->GetInt("benchmark") * 60 * GAME_SPEED;
+		} else {
+			CBenchmark::endFrame = CBenchmark::startFrame + 5 * 60 * GAME_SPEED;
+		}
+		if (cmdline->IsSet("benchmark-timings")) {
+			CBenchmark::timingsFileName = cmdline->GetString("benchmark-timings");
+		}
+		if (cmdline->IsSet("benchmark-pathsearches")) {
+			CBenchmark::pathSearchesFileName = cmdline->GetString("benchmark-pathsearches");
+		}
 	}
 }
 
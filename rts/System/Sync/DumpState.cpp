@@ -217,7 +217,7 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod)
 
 	#ifdef DUMP_PROJECTILE_DATA
 	for (projectilesIt = projectiles.begin(); projectilesIt != projectiles.end(); ++projectilesIt) {
-		const CProjectile* p = *projectilesIt;
+		const CProjectile* p = projectilesIt->first;
 
 		file << "\t\tprojectileID: " << p->id << "\n";
 		file << "\t\t\tpos: <" << p->pos.x << ", " << p->pos.y << ", " << p->pos.z << ">\n";
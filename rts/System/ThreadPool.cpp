@@ -7,6 +7,7 @@
 #include "Util.h"
 #if !defined(UNITSYNC) && !defined(UNIT_TEST)
 	#include "OffscreenGLContext.h"
+	#include "lib/streflop/streflop_cond.h"
 #endif
 
 #include <deque>
@@ -136,7 +137,7 @@ static bool DoTask(boost::shared_lock<boost::shared_mutex>& lk_)
 static bool DoTask(std::shared_ptr<ITaskGroup> tg)
 {
 	auto p = tg->GetTask();
-	const bool f = p;
+	const bool f = bool(p);
 	if (f) {
 		SCOPED_MT_TIMER("::ThreadWorkers (accumulated)");
 		(*p)();
@@ -150,6 +151,12 @@ static void WorkerLoop(int id)
 {
 	SetThreadNum(id);
 	Threading::SetThreadName(IntToString(id, "worker%i"));
+#if !defined(UNITSYNC) && !defined(UNIT_TEST)
+	// workers run synced code (eg. LOS raycasts, piece matrices, path-
+	// estimator offsets) and must use the same FPU settings as the main
+	// thread
+	streflop::streflop_init<streflop::Simple>();
+#endif
 	boost::shared_lock<boost::shared_mutex> lk(taskMutex, boost::defer_lock);
 	boost::mutex m;
 	boost::unique_lock<boost::mutex> lk2(m);
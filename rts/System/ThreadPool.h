@@ -66,6 +66,8 @@ static inline auto parallel_reduce(F&& f, G&& g) -> typename std::result_of<F()>
 #undef gt
 #include <boost/chrono/include.hpp>
 #include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
 #include <memory>
 
 #ifdef UNITSYNC
@@ -90,6 +92,8 @@ public:
 	bool wait_for(const boost::chrono::duration<Rep, Period>& rel_time) const {
 		const auto end = boost::chrono::high_resolution_clock::now() + rel_time;
 		while (!IsFinished() && (boost::chrono::high_resolution_clock::now() < end)) {
+			// the remaining tasks are already running on other threads
+			boost::this_thread::yield();
 		}
 		return IsFinished();
 	}
@@ -286,6 +290,158 @@ public:
 
 
 
+/**
+ * @brief Loop over an index range with per-thread subranges and range stealing
+ *
+ * The iterations are split evenly into one subrange per thread. A thread
+ * works off the front of its own subrange in chunks that shrink with the
+ * remaining work (guided scheduling); once that is exhausted it steals the
+ * back half of the fullest other subrange. Each subrange is packed into a
+ * single 64bit atomic, so both sides only need a CAS to claim work.
+ *
+ * Every thread that calls GetTask() gets the same drain-task, which keeps
+ * running chunks until no work is left anywhere.
+ */
+class RangeTaskGroup : public ITaskGroup
+{
+public:
+	RangeTaskGroup(int _start, int _step, int numIters, const std::function<void(const int)>& _f)
+		: start(_start)
+		, step(_step)
+		, remainingIters(numIters)
+		, ranges(ThreadPool::GetNumThreads())
+		, f(_f)
+	{
+		const int numRanges = ranges.size();
+
+		for (int n = 0; n < numRanges; n++) {
+			ranges[n] = PackRange((numIters * n) / numRanges, (numIters * (n + 1)) / numRanges);
+		}
+
+		task = [this]{ Drain(); };
+	}
+
+	boost::optional<std::function<void()>> GetTask() {
+		if (IsEmpty())
+			return boost::optional<std::function<void()>>();
+
+		return task;
+	}
+
+	bool IsEmpty() const {
+		for (const auto& r: ranges) {
+			if (RangeSize(r.load(std::memory_order_relaxed)) > 0)
+				return false;
+		}
+		return true;
+	}
+	bool IsFinished() const { return (remainingIters == 0); }
+	int RemainingTasks() const { return remainingIters; }
+
+private:
+	static boost::uint64_t PackRange(boost::uint32_t b, boost::uint32_t e) { return ((boost::uint64_t(b) << 32) | e); }
+	static boost::uint32_t RangeBeg(boost::uint64_t r) { return (r >> 32); }
+	static boost::uint32_t RangeEnd(boost::uint64_t r) { return (r & 0xFFFFFFFF); }
+	static int RangeSize(boost::uint64_t r) { return (int(RangeEnd(r)) - int(RangeBeg(r))); }
+
+	/// claims [b, e) from the front of our own range
+	bool PopChunk(std::atomic<boost::uint64_t>& range, boost::uint32_t& b, boost::uint32_t& e) {
+		boost::uint64_t r = range.load();
+
+		while (RangeSize(r) > 0) {
+			const int numThreads = ranges.size();
+			const int chunkSize = std::max(1, RangeSize(r) / (numThreads * 2));
+
+			b = RangeBeg(r);
+			e = b + chunkSize;
+
+			if (range.compare_exchange_weak(r, PackRange(e, RangeEnd(r))))
+				return true;
+		}
+
+		return false;
+	}
+
+	/// moves the back half of the largest other range into our own (empty) one
+	bool Steal(std::atomic<boost::uint64_t>& ownRange, boost::uint32_t& b, boost::uint32_t& e) {
+		while (true) {
+			std::atomic<boost::uint64_t>* victim = NULL;
+			int victimSize = 0;
+
+			for (auto& r: ranges) {
+				const int size = RangeSize(r.load(std::memory_order_relaxed));
+
+				if (size > victimSize) {
+					victim = &r;
+					victimSize = size;
+				}
+			}
+
+			if (victim == NULL)
+				return false;
+
+			boost::uint64_t r = victim->load();
+
+			if (RangeSize(r) <= 0)
+				continue;
+
+			const boost::uint32_t mid = RangeEnd(r) - (RangeSize(r) + 1) / 2;
+
+			if (!victim->compare_exchange_weak(r, PackRange(RangeBeg(r), mid)))
+				continue;
+
+			b = mid;
+			e = RangeEnd(r);
+
+			// threads can share a range (GetThreadNum is 0 for all non-workers);
+			// if one of them refilled it meanwhile, the loot stays private
+			boost::uint64_t own = ownRange.load();
+
+			if (RangeSize(own) <= 0 && ownRange.compare_exchange_strong(own, PackRange(b, e)))
+				b = e;
+
+			return true;
+		}
+	}
+
+	void Drain() {
+		auto& ownRange = ranges[ThreadPool::GetThreadNum() % ranges.size()];
+		boost::uint32_t b = 0;
+		boost::uint32_t e = 0;
+
+		do {
+			// non-empty [b, e) here means stolen work that could not be shared
+			Run(b, e);
+
+			while (PopChunk(ownRange, b, e)) {
+				Run(b, e);
+			}
+		} while (Steal(ownRange, b, e));
+	}
+
+	void Run(boost::uint32_t b, boost::uint32_t e) {
+		if (b == e)
+			return;
+
+		for (boost::uint32_t n = b; n < e; n++) {
+			f(start + n * step);
+		}
+
+		remainingIters -= (e - b);
+	}
+
+private:
+	const int start;
+	const int step;
+
+	std::atomic<int> remainingIters;
+	std::vector<std::atomic<boost::uint64_t>> ranges;
+
+	const std::function<void(const int)>& f;
+	std::function<void()> task;
+};
+
+
 static inline void for_mt(int start, int end, int step, const std::function<void(const int i)>&& f)
 {
 	if (end <= start)
@@ -307,10 +463,7 @@ static inline void for_mt(int start, int end, int step, const std::function<void
 
 	ThreadPool::NotifyWorkerThreads();
 	SCOPED_MT_TIMER("::ThreadWorkers (real)");
-	auto taskgroup = std::make_shared<TaskGroup<const std::function<void(const int)>, const int>>((end-start)/step);
-	for (int i = start; i < end; i += step) { //FIXME optimize worksize (group tasks in bigger ones than 1-steps)
-		taskgroup->enqueue(f, i);
-	}
+	auto taskgroup = std::make_shared<RangeTaskGroup>(start, step, (end - start + step - 1) / step, f);
 	ThreadPool::PushTaskGroup(taskgroup);
 	ThreadPool::WaitForFinished(taskgroup);
 }
@@ -2,6 +2,9 @@
 
 #include "System/TimeProfiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstring>
 #include <boost/unordered_map.hpp>
 #include <boost/thread/mutex.hpp>
@@ -9,6 +12,7 @@
 
 #include "System/Log/ILog.h"
 #include "System/UnsyncedRNG.h"
+#include "System/maindefines.h"
 #ifdef THREADPOOL
 	#include "System/ThreadPool.h"
 #endif
@@ -18,6 +22,43 @@ static std::map<int, std::string> hashToName;
 static std::map<int, int> refs;
 
 
+struct TraceEvent {
+	const std::string* name;
+	spring_time begin;
+	spring_time end;
+};
+
+// one ring entry; <seq> is odd while the owner writes <event> and equal
+// to 2 * (index + 1) once event number <index> is complete, so a reader
+// can tell if the slot still holds the event it expects (a seqlock)
+struct TraceSlot {
+	TraceSlot(): seq(0) {}
+
+	std::atomic<unsigned> seq;
+	TraceEvent event;
+};
+
+// single-producer ring of the most recent trace events of one thread
+struct TraceRing {
+	TraceRing(int _tid, int _poolThreadNum): tid(_tid), poolThreadNum(_poolThreadNum), head(0) {}
+
+	static const unsigned NUM_EVENTS = 1 << 14;
+	static const unsigned INDEX_MASK = NUM_EVENTS - 1;
+
+	int tid;
+	int poolThreadNum;
+
+	// number of events ever written; the writer publishes a slot by bumping it
+	std::atomic<unsigned> head;
+	TraceSlot slots[NUM_EVENTS];
+};
+
+// rings are never freed, a thread may die any time before a dump
+static boost::mutex traceRingsMutex;
+static std::vector<TraceRing*> traceRings;
+static __thread TraceRing* threadTraceRing = NULL;
+
+
 
 static unsigned hash_(const std::string& s)
 {
@@ -103,8 +144,12 @@ ScopedTimer::ScopedTimer(const char* name, bool autoShow)
 ScopedTimer::~ScopedTimer()
 {
 	int& ref = it->second;
-	if (--ref == 0)
-		profiler.AddTime(GetName(), spring_difftime(spring_gettime(), starttime), autoShowGraph);
+	if (--ref == 0) {
+		const spring_time endtime = spring_gettime();
+
+		profiler.AddTime(GetName(), spring_difftime(endtime, starttime), autoShowGraph);
+		profiler.AddTraceEvent(&GetName(), starttime, endtime);
+	}
 }
 
 ScopedOnceTimer::~ScopedOnceTimer()
@@ -130,10 +175,13 @@ ScopedMtTimer::ScopedMtTimer(const char* name, bool autoShow)
 
 ScopedMtTimer::~ScopedMtTimer()
 {
-	profiler.AddTime(GetName(), spring_difftime(spring_gettime(), starttime), autoShowGraph);
+	const spring_time endtime = spring_gettime();
+
+	profiler.AddTime(GetName(), spring_difftime(endtime, starttime), autoShowGraph);
+	profiler.AddTraceEvent(&GetName(), starttime, endtime);
 #ifdef THREADPOOL
 	auto& list = profiler.profileCore[ThreadPool::GetThreadNum()];
-	list.emplace_back(starttime, spring_gettime());
+	list.emplace_back(starttime, endtime);
 #endif
 }
 
@@ -210,6 +258,19 @@ float CTimeProfiler::GetPercent(const char* name)
 	return profile[name].percent;
 }
 
+spring_time CTimeProfiler::GetTotal(const std::string& name)
+{
+	boost::unique_lock<boost::mutex> ulk(m, boost::defer_lock);
+	while (!ulk.try_lock()) {}
+
+	const auto pi = profile.find(name);
+
+	if (pi == profile.end())
+		return spring_notime;
+
+	return pi->second.total;
+}
+
 void CTimeProfiler::AddTime(const std::string& name, const spring_time time, const bool showGraph)
 {
 	auto pi = profile.find(name);
@@ -255,3 +316,128 @@ void CTimeProfiler::PrintProfilingInfo() const
 		LOG("%35s %16.2fms %5.2f%%", name.c_str(), tr.total.toMilliSecsf(), tr.percent * 100);
 	}
 }
+
+
+
+void CTimeProfiler::AddTraceEvent(const std::string* name, const spring_time begin, const spring_time end)
+{
+	if (threadTraceRing == NULL) {
+		boost::unique_lock<boost::mutex> ulk(traceRingsMutex);
+
+	#ifdef THREADPOOL
+		threadTraceRing = new TraceRing(traceRings.size(), ThreadPool::GetThreadNum());
+	#else
+		threadTraceRing = new TraceRing(traceRings.size(), 0);
+	#endif
+		traceRings.push_back(threadTraceRing);
+	}
+
+	TraceRing* ring = threadTraceRing;
+	const unsigned head = ring->head.load(std::memory_order_relaxed);
+
+	TraceSlot& slot = ring->slots[head & TraceRing::INDEX_MASK];
+
+	slot.seq.store(head * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.event.name  = name;
+	slot.event.begin = begin;
+	slot.event.end   = end;
+
+	slot.seq.store(head * 2 + 2, std::memory_order_release);
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+
+static void WriteTraceString(FILE* file, const std::string& str)
+{
+	fputc('"', file);
+
+	for (size_t n = 0; n < str.size(); n++) {
+		if (str[n] == '"' || str[n] == '\\')
+			fputc('\\', file);
+		if (str[n] < ' ')
+			continue;
+
+		fputc(str[n], file);
+	}
+
+	fputc('"', file);
+}
+
+bool CTimeProfiler::DumpTrace(const std::string& fileName) const
+{
+	std::vector<TraceRing*> rings;
+	std::vector<TraceEvent> events;
+
+	{
+		boost::unique_lock<boost::mutex> ulk(traceRingsMutex);
+		rings = traceRings;
+	}
+
+	FILE* file = fopen(fileName.c_str(), "w");
+
+	if (file == NULL) {
+		LOG_L(L_ERROR, "[%s] could not open \"%s\" for writing", __FUNCTION__, fileName.c_str());
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	bool firstEvent = true;
+	size_t numEvents = 0;
+
+	for (const TraceRing* ring: rings) {
+		const unsigned head = ring->head.load(std::memory_order_acquire);
+		const unsigned tail = head - std::min(head, TraceRing::NUM_EVENTS);
+
+		events.clear();
+		events.reserve(head - tail);
+
+		// the owning thread keeps writing while we copy; keep
+		// only the events whose slot was not (being) reused
+		for (unsigned n = tail; n != head; n++) {
+			const TraceSlot& slot = ring->slots[n & TraceRing::INDEX_MASK];
+
+			const unsigned seq = slot.seq.load(std::memory_order_acquire);
+			const TraceEvent e = slot.event;
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (seq != (n * 2 + 2))
+				continue;
+			if (slot.seq.load(std::memory_order_relaxed) != seq)
+				continue;
+
+			events.push_back(e);
+		}
+
+		fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, \"args\": {\"name\": ", (firstEvent? "": ",\n"), ring->tid);
+		if (ring->poolThreadNum > 0) {
+			fprintf(file, "\"ThreadPool::%d\"}}", ring->poolThreadNum);
+		} else {
+			fprintf(file, "\"Thread %d\"}}", ring->tid);
+		}
+
+		firstEvent = false;
+
+		for (size_t n = 0; n < events.size(); n++) {
+			const TraceEvent& e = events[n];
+
+			fprintf(file, ",\n{\"name\": ");
+			WriteTraceString(file, *e.name);
+			fprintf(file, ", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %lld, \"dur\": %lld}",
+				ring->tid,
+				(long long) e.begin.toMicroSecsi(),
+				(long long) (e.end - e.begin).toMicroSecsi());
+
+			numEvents++;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	LOG("[%s] wrote " _STPF_ " events of " _STPF_ " threads to \"%s\"", __FUNCTION__, numEvents, rings.size(), fileName.c_str());
+	return true;
+}
@@ -89,12 +89,27 @@ public:
 	static CTimeProfiler& GetInstance();
 
 	float GetPercent(const char *name);
+	/// accumulated time of <name> since startup (zero if never measured)
+	spring_time GetTotal(const std::string& name);
 	void Update();
 
 	void PrintProfilingInfo() const;
 
 	void AddTime(const std::string& name, const spring_time time, const bool showGraph = false);
 
+	/**
+	 * Appends a finished timer scope to the calling thread's trace buffer.
+	 * Each thread owns a fixed-size ring (the oldest events are overwritten)
+	 * which only it writes to, so this never takes a lock after the first
+	 * call per thread. <name> must outlive the profiler.
+	 */
+	void AddTraceEvent(const std::string* name, const spring_time begin, const spring_time end);
+	/**
+	 * Writes the buffered events of all threads to <fileName> in Chrome's
+	 * trace-event JSON format (load in about:tracing or Perfetto).
+	 */
+	bool DumpTrace(const std::string& fileName) const;
+
 public:
 	struct TimeRecord {
 		TimeRecord()
@@ -0,0 +1,155 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Hierarchical timer wheel of values due at integer times
+ *
+ * Four levels of 256 slots each; level 0 has one slot per time unit, every
+ * further level covers 256 slots of the previous one. Values are inserted in
+ * O(1) into the level matching how far ahead they are due, and cascade down
+ * a level whenever the current time enters the range of their slot, so each
+ * value is touched at most once per level.
+ *
+ * Values are handed out ordered by due time and then by insertion, which
+ * does not depend on the layout of the wheel (as needed for sync).
+ */
+template<typename T>
+class TimerWheel {
+public:
+	TimerWheel(): curTime(0), numValues(0), insertCount(0) {}
+
+	/**
+	 * Schedule <v> for <time>; values due before the current
+	 * time are handed out at the next call to advance.
+	 */
+	void insert(const T& v, int time) {
+		const Entry e = {v, time, insertCount++};
+
+		place(e);
+		numValues++;
+	}
+
+	/**
+	 * @brief move the current time forward to <time>
+	 * Appends all values due before <time> to <due>.
+	 */
+	void advance(int time, std::vector<T>& due) {
+		if (numValues == 0) {
+			curTime = std::max(curTime, time);
+			return;
+		}
+
+		while (curTime < time) {
+			if ((curTime & SLOT_MASK) == 0)
+				cascade(1);
+
+			std::vector<Entry>& slot = slots[0][curTime & SLOT_MASK];
+
+			if (!slot.empty()) {
+				std::sort(slot.begin(), slot.end());
+
+				for (size_t n = 0; n < slot.size(); n++) {
+					due.push_back(slot[n].value);
+				}
+
+				numValues -= slot.size();
+				slot.clear();
+			}
+
+			curTime++;
+		}
+	}
+
+	/// removes all values, appending them to <values> in the order they are due
+	void clear(std::vector<T>& values) {
+		std::vector<Entry> entries;
+		entries.reserve(numValues);
+
+		for (int level = 0; level < NUM_LEVELS; level++) {
+			for (int n = 0; n < NUM_SLOTS; n++) {
+				entries.insert(entries.end(), slots[level][n].begin(), slots[level][n].end());
+				slots[level][n].clear();
+			}
+		}
+
+		std::sort(entries.begin(), entries.end());
+
+		for (size_t n = 0; n < entries.size(); n++) {
+			values.push_back(entries[n].value);
+		}
+
+		numValues = 0;
+	}
+
+	size_t size() const { return numValues; }
+	bool empty() const { return (numValues == 0); }
+
+	/// all values due before this time have been handed out
+	int time() const { return curTime; }
+
+private:
+	static const int NUM_LEVELS = 4;
+	static const int SLOT_BITS = 8;
+	static const int NUM_SLOTS = 1 << SLOT_BITS;
+	static const int SLOT_MASK = NUM_SLOTS - 1;
+
+	struct Entry {
+		bool operator < (const Entry& e) const {
+			if (time != e.time)
+				return (time < e.time);
+
+			return (order < e.order);
+		}
+
+		T value;
+		int time;
+		/// wraps around eventually, which is still deterministic
+		unsigned int order;
+	};
+
+	void place(const Entry& e) {
+		// overdue values go into the slot handed out next
+		const unsigned int delta = std::max(e.time - curTime, 0);
+
+		int level = 0;
+
+		while ((level + 1) < NUM_LEVELS && delta >= (1u << (SLOT_BITS * (level + 1))))
+			level++;
+
+		const int time = std::max(e.time, curTime);
+		const int slot = (time >> (SLOT_BITS * level)) & SLOT_MASK;
+
+		slots[level][slot].push_back(e);
+	}
+
+	/// moves the values of the slot at level <level> the current time entered
+	void cascade(int level) {
+		const int index = (curTime >> (SLOT_BITS * level)) & SLOT_MASK;
+
+		std::vector<Entry> entries;
+		entries.swap(slots[level][index]);
+
+		for (size_t n = 0; n < entries.size(); n++) {
+			place(entries[n]);
+		}
+
+		// the next level wrapped around as well
+		if (index == 0 && (level + 1) < NUM_LEVELS)
+			cascade(level + 1);
+	}
+
+private:
+	std::vector<Entry> slots[NUM_LEVELS][NUM_SLOTS];
+
+	int curTime;
+	size_t numValues;
+	unsigned int insertCount;
+};
+
+#endif // TIMER_WHEEL_H
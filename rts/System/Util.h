@@ -5,6 +5,7 @@
 
 #include <string>
 #include <sstream>
+#include <vector>
 #include <algorithm>
 #include <boost/utility.hpp>
 
@@ -212,6 +213,24 @@ inline I set_erase(S &s, I i) {
 #endif
 }
 
+/**
+ * @brief Removes the first occurrence of <e> from <v> in O(1) after the search
+ * Does NOT preserve the order of the remaining elements (the last one is
+ * moved into the gap), returns false if <e> was not found.
+ */
+template<typename T, typename E>
+static inline bool VectorErase(std::vector<T>& v, const E& e)
+{
+	typename std::vector<T>::iterator it = std::find(v.begin(), v.end(), e);
+
+	if (it == v.end())
+		return false;
+
+	*it = v.back();
+	v.pop_back();
+	return true;
+}
+
 
 
 
@@ -11,6 +11,7 @@
 #include "Game/GameData.h"
 #include "Game/GameVersion.h"
 #include "Net/GameServer.h"
+#include "Net/RelaySource.h"
 #include "System/FileSystem/DataDirLocater.h"
 #include "System/FileSystem/FileSystemInitializer.h"
 #include "System/FileSystem/ArchiveScanner.h"
@@ -131,6 +132,80 @@ void ParseCmdLine(int argc, char* argv[], std::string* script_txt)
 
 
 
+static CGameServer* CreateGameServer(const ClientSetup& settings, const std::string& scriptName, const std::string& scriptText)
+{
+	gameSetup = new CGameSetup(); // to store the gamedata inside
+
+	if (!gameSetup->Init(scriptText)) {
+		// read the script provided by cmdline
+		LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
+		return NULL;
+	}
+
+	// Create the server, it will run in a separate thread
+	GameData data;
+	UnsyncedRNG rng;
+
+	const unsigned seed = time(NULL) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
+	rng.Seed(seed);
+	data.SetRandomSeed(rng.RandInt());
+
+	//  Use script provided hashes if they exist
+	if (gameSetup->mapHash != 0) {
+		data.SetMapChecksum(gameSetup->mapHash);
+		gameSetup->LoadStartPositions(false); // reduced mode
+	} else {
+		data.SetMapChecksum(archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName));
+
+		CFileHandler f("maps/" + gameSetup->mapName);
+		if (!f.FileExists()) {
+			vfsHandler->AddArchiveWithDeps(gameSetup->mapName, false);
+		}
+		gameSetup->LoadStartPositions(); // full mode
+	}
+
+	if (gameSetup->modHash != 0) {
+		data.SetModChecksum(gameSetup->modHash);
+	} else {
+		const std::string& modArchive = archiveScanner->ArchiveFromName(gameSetup->modName);
+		const unsigned int modCheckSum = archiveScanner->GetArchiveCompleteChecksum(modArchive);
+		data.SetModChecksum(modCheckSum);
+	}
+
+	LOG("starting server...");
+
+	data.SetSetup(gameSetup->gameSetupText);
+	return (new CGameServer(settings.hostIP, settings.hostPort, &data, gameSetup));
+}
+
+static CGameServer* CreateRelayServer(const ClientSetup& settings)
+{
+	// join the upstream game as a spectator; its game data
+	// (with checksums and seed) is what we hand out ourselves
+	CRelaySource* relaySource = new CRelaySource(settings.relayHostIP, settings.relayHostPort, settings.myPlayerName, settings.myPasswd);
+
+	if (!relaySource->Connect(spring_secs(globalConfig->initialNetworkTimeout))) {
+		delete relaySource;
+		return NULL;
+	}
+
+	const GameData* data = relaySource->GetGameData();
+
+	gameSetup = new CGameSetup();
+
+	if (!gameSetup->Init(data->GetSetup())) {
+		LOG_L(L_ERROR, "upstream server sent an invalid script");
+		delete relaySource;
+		return NULL;
+	}
+
+	LOG("starting relay server...");
+
+	return (new CGameServer(settings.hostIP, settings.hostPort, data, gameSetup, relaySource));
+}
+
+
+
 int main(int argc, char* argv[])
 {
 	try {
@@ -167,48 +242,15 @@ int main(int argc, char* argv[])
 			throw content_error("script cannot be read: " + scriptName);
 
 		settings.LoadFromStartScript(scriptText);
-		gameSetup = new CGameSetup(); // to store the gamedata inside
-
-		if (!gameSetup->Init(scriptText)) {
-			// read the script provided by cmdline
-			LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
-			return 1;
-		}
-
-		// Create the server, it will run in a separate thread
-		GameData data;
-		UnsyncedRNG rng;
-
-		const unsigned seed = time(NULL) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
-		rng.Seed(seed);
-		data.SetRandomSeed(rng.RandInt());
-
-		//  Use script provided hashes if they exist
-		if (gameSetup->mapHash != 0) {
-			data.SetMapChecksum(gameSetup->mapHash);
-			gameSetup->LoadStartPositions(false); // reduced mode
-		} else {
-			data.SetMapChecksum(archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName));
 
-			CFileHandler f("maps/" + gameSetup->mapName);
-			if (!f.FileExists()) {
-				vfsHandler->AddArchiveWithDeps(gameSetup->mapName, false);
-			}
-			gameSetup->LoadStartPositions(); // full mode
-		}
-
-		if (gameSetup->modHash != 0) {
-			data.SetModChecksum(gameSetup->modHash);
+		if (settings.relayHostIP.empty()) {
+			server = CreateGameServer(settings, scriptName, scriptText);
 		} else {
-			const std::string& modArchive = archiveScanner->ArchiveFromName(gameSetup->modName);
-			const unsigned int modCheckSum = archiveScanner->GetArchiveCompleteChecksum(modArchive);
-			data.SetModChecksum(modCheckSum);
+			server = CreateRelayServer(settings);
 		}
 
-		LOG("starting server...");
-
-		data.SetSetup(gameSetup->gameSetupText);
-		server = new CGameServer(settings.hostIP, settings.hostPort, &data, gameSetup);
+		if (server == NULL)
+			return 1;
 
 		while (!server->HasGameID()) {
 			// wait until gameID has been generated or
@@ -0,0 +1,195 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/QuadFieldProjectileCells.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#define BOOST_TEST_MODULE QuadFieldStorage
+#include <boost/test/unit_test.hpp>
+
+// drives the projectile bookkeeping of CQuadField (which can not be built
+// standalone) with projectiles that only have what it uses: cell-data
+static const int NUM_QUADS_X = 16;
+static const int NUM_QUADS_Z = 16;
+static const int NUM_PROJECTILES = 2000;
+static const int NUM_STEPS = 20000;
+
+struct TestProjectile {
+	// same interface as CProjectile::QuadFieldCellData
+	struct QuadFieldCellData {
+		QuadFieldCellData() {
+			for (unsigned int n = 0; n < 3; n++) {
+				indices[n] = -1;
+			}
+		}
+
+		const int2& GetCoor(unsigned int idx) const { return coors[idx]; }
+		int GetIndex(unsigned int idx) const { return indices[idx]; }
+
+		void SetCoor(unsigned int idx, const int2& co) { coors[idx] = co; }
+		void SetIndex(unsigned int idx, int i) { indices[idx] = i; }
+
+	private:
+		int2 coors[3];
+		int indices[3];
+	};
+
+	TestProjectile(): hitscan(false), inserted(false) {}
+
+	QuadFieldCellData& GetQuadFieldCellData() { return qfCellData; }
+
+	QuadFieldCellData qfCellData;
+	bool hitscan;
+	bool inserted;
+};
+
+struct TestQuadField {
+	TestQuadField(): cells(NUM_QUADS_X * NUM_QUADS_Z) {}
+
+	std::vector<TestProjectile*>& operator () (const int2& coor) { return cells[coor.y * NUM_QUADS_X + coor.x]; }
+
+	// like CQuadField::AddProjectile, hit-scan ones span up to three cells
+	void AddProjectile(TestProjectile* p, const int2& pos) {
+		TestProjectile::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
+
+		qfcd.SetCoor(0, pos);
+		qfcd.SetCoor(1, int2(std::min(pos.x + 1, NUM_QUADS_X - 1), pos.y));
+		qfcd.SetCoor(2, int2(std::min(pos.x + 2, NUM_QUADS_X - 1), pos.y));
+
+		QuadFieldProjectileCells::Add(p, (p->hitscan)? 3: 1, Lookup(this));
+		p->inserted = true;
+	}
+
+	void RemoveProjectile(TestProjectile* p) {
+		QuadFieldProjectileCells::Remove(p, Lookup(this));
+		p->inserted = false;
+	}
+
+	struct Lookup {
+		Lookup(TestQuadField* qf): quadField(qf) {}
+		std::vector<TestProjectile*>& operator () (const int2& coor) const { return (*quadField)(coor); }
+		TestQuadField* quadField;
+	};
+
+	std::vector< std::vector<TestProjectile*> > cells;
+};
+
+
+// every cell-entry must be indexed by its projectile and vice versa
+static void CheckConsistency(TestQuadField& quadField, std::vector<TestProjectile>& projectiles)
+{
+	unsigned int numEntries = 0;
+	unsigned int numIndices = 0;
+
+	for (int z = 0; z < NUM_QUADS_Z; z++) {
+		for (int x = 0; x < NUM_QUADS_X; x++) {
+			const std::vector<TestProjectile*>& cell = quadField(int2(x, z));
+
+			for (int i = 0; i < int(cell.size()); i++) {
+				TestProjectile::QuadFieldCellData& qfcd = cell[i]->GetQuadFieldCellData();
+				bool indexed = false;
+
+				for (unsigned int n = 0; n < 3; n++) {
+					indexed |= (qfcd.GetIndex(n) == i && qfcd.GetCoor(n) == int2(x, z));
+				}
+
+				BOOST_CHECK(cell[i]->inserted);
+				BOOST_CHECK(indexed);
+			}
+
+			numEntries += cell.size();
+		}
+	}
+
+	for (unsigned int k = 0; k < projectiles.size(); k++) {
+		TestProjectile::QuadFieldCellData& qfcd = projectiles[k].GetQuadFieldCellData();
+
+		for (unsigned int n = 0; n < 3; n++) {
+			if (qfcd.GetIndex(n) < 0)
+				continue;
+
+			const std::vector<TestProjectile*>& cell = quadField(qfcd.GetCoor(n));
+
+			BOOST_REQUIRE(qfcd.GetIndex(n) < int(cell.size()));
+			BOOST_CHECK(cell[qfcd.GetIndex(n)] == &projectiles[k]);
+			numIndices++;
+		}
+
+		if (!projectiles[k].inserted) {
+			BOOST_CHECK(qfcd.GetIndex(0) < 0);
+		}
+	}
+
+	BOOST_CHECK_EQUAL(numEntries, numIndices);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( SwapRemove )
+{
+	TestQuadField quadField;
+	std::vector<TestProjectile> projectiles(3);
+
+	projectiles[2].hitscan = true;
+
+	quadField.AddProjectile(&projectiles[0], int2(1, 1));
+	quadField.AddProjectile(&projectiles[1], int2(1, 1));
+	quadField.AddProjectile(&projectiles[2], int2(0, 1));
+
+	BOOST_CHECK_EQUAL(quadField(int2(0, 1)).size(), 1);
+	BOOST_CHECK_EQUAL(quadField(int2(1, 1)).size(), 3);
+	BOOST_CHECK_EQUAL(quadField(int2(2, 1)).size(), 1);
+	BOOST_CHECK_EQUAL(projectiles[2].GetQuadFieldCellData().GetIndex(1), 2);
+
+	// the hit-scan projectile at the end of cell (1, 1) fills the gap
+	quadField.RemoveProjectile(&projectiles[0]);
+
+	BOOST_CHECK(quadField(int2(1, 1))[0] == &projectiles[2]);
+	BOOST_CHECK_EQUAL(projectiles[2].GetQuadFieldCellData().GetIndex(1), 0);
+	BOOST_CHECK_EQUAL(projectiles[2].GetQuadFieldCellData().GetIndex(0), 0);
+	CheckConsistency(quadField, projectiles);
+
+	quadField.RemoveProjectile(&projectiles[2]);
+	quadField.RemoveProjectile(&projectiles[1]);
+
+	for (unsigned int n = 0; n < quadField.cells.size(); n++) {
+		BOOST_CHECK(quadField.cells[n].empty());
+	}
+
+	CheckConsistency(quadField, projectiles);
+}
+
+BOOST_AUTO_TEST_CASE( RandomInsertMoveRemove )
+{
+	TestQuadField quadField;
+	std::vector<TestProjectile> projectiles(NUM_PROJECTILES);
+
+	srand(1234);
+
+	for (unsigned int k = 0; k < projectiles.size(); k++) {
+		projectiles[k].hitscan = ((k % 7) == 0);
+	}
+
+	for (int step = 0; step < NUM_STEPS; step++) {
+		TestProjectile* p = &projectiles[rand() % NUM_PROJECTILES];
+		const int2 pos(rand() % NUM_QUADS_X, rand() % NUM_QUADS_Z);
+
+		if (!p->inserted) {
+			quadField.AddProjectile(p, pos);
+		} else if ((rand() % 3) == 0) {
+			quadField.RemoveProjectile(p);
+		} else {
+			// CQuadField::MovedProjectile
+			quadField.RemoveProjectile(p);
+			quadField.AddProjectile(p, pos);
+		}
+
+		if ((step % 1000) == 0) {
+			CheckConsistency(quadField, projectiles);
+		}
+	}
+
+	CheckConsistency(quadField, projectiles);
+}
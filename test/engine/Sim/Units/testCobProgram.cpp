@@ -0,0 +1,232 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Units/Scripts/CobProgram.h"
+
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE CobProgram
+#include <boost/test/unit_test.hpp>
+
+static const int PUSH_CONSTANT  = 0x10021001;
+static const int GET_UNIT_VALUE = 0x10042000;
+static const int ADD            = 0x10031000;
+static const int CALL           = 0x10062000;
+static const int JUMP           = 0x10064000;
+static const int RETURN         = 0x10065000;
+static const int JUMP_NOT_EQUAL = 0x10066000;
+static const int SLEEP          = 0x10013000;
+static const int SHADE          = 0x1000D000;
+
+
+struct TestScripts
+{
+	void AddScript(const std::string& name, const std::vector<int>& scriptCode)
+	{
+		scriptNames.push_back(name);
+		scriptOffsets.push_back(code.size());
+		scriptLengths.push_back(scriptCode.size());
+		code.insert(code.end(), scriptCode.begin(), scriptCode.end());
+	}
+
+	void Translate() { program.Translate(code, scriptOffsets, scriptLengths, scriptNames); }
+
+	const CobInstruction& GetInstruction(int pc) const { return program.GetCode()[pc]; }
+
+	std::vector<int> code;
+	std::vector<int> scriptOffsets;
+	std::vector<int> scriptLengths;
+	std::vector<std::string> scriptNames;
+
+	CCobProgram program;
+};
+
+static std::vector<int> MakeCode(const int* words, size_t numWords)
+{
+	return std::vector<int>(words, words + numWords);
+}
+
+
+BOOST_AUTO_TEST_CASE(OperandsAndJumps)
+{
+	TestScripts scripts;
+
+	// loop: push 1; jne end; shade 0; jmp loop; end: push 0; return
+	const int loop[] = {
+		PUSH_CONSTANT, 1,
+		JUMP_NOT_EQUAL, 9,
+		SHADE, 0,
+		JUMP, 0,
+		0x12345678,
+		PUSH_CONSTANT, 0,
+		RETURN,
+	};
+
+	// the 0x12345678 word is never executed, which is not an error until it is
+	scripts.AddScript("Loop", MakeCode(loop, sizeof(loop) / sizeof(loop[0])));
+	scripts.Translate();
+
+	BOOST_CHECK_EQUAL(scripts.program.GetEntry(0), 0);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(0).opcode, COBOP_PUSH_CONSTANT);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(0).arg1, 1);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).opcode, COBOP_JUMP_NOT_EQUAL);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(2).opcode, COBOP_NOP);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(3).opcode, COBOP_JUMP);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(3).arg1, 0);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(4).opcode, COBOP_INVALID);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(4).arg1, 0x12345678);
+	BOOST_CHECK_EQUAL(scripts.program.GetCodeOffset(4), 8);
+
+	// decoding continues after the unknown opcode, so the jump past it
+	// lands on the code that follows
+	const int target = scripts.GetInstruction(1).arg1;
+
+	BOOST_CHECK_EQUAL(target, 5);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(target).opcode, COBOP_PUSH_CONSTANT);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(target).arg1, 0);
+	BOOST_CHECK_EQUAL(scripts.program.GetCodeOffset(target), 9);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(target + 1).opcode, COBOP_RETURN);
+}
+
+
+BOOST_AUTO_TEST_CASE(JumpsIntoOperands)
+{
+	TestScripts scripts;
+
+	// the operand of the push is also a valid opcode, and a jump target
+	const int overlap[] = {
+		JUMP, 3,
+		PUSH_CONSTANT, SLEEP,
+		RETURN,
+	};
+
+	scripts.AddScript("Overlap", MakeCode(overlap, sizeof(overlap) / sizeof(overlap[0])));
+	scripts.Translate();
+
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).opcode, COBOP_PUSH_CONSTANT);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).arg1, SLEEP);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(2).opcode, COBOP_RETURN);
+
+	// decoded from the target like the raw interpreter would, then
+	// rejoining the instructions that were decoded already
+	const int target = scripts.GetInstruction(0).arg1;
+
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(target).opcode, COBOP_SLEEP);
+	BOOST_CHECK_EQUAL(scripts.program.GetCodeOffset(target), 3);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(target + 1).opcode, COBOP_JUMP);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(target + 1).arg1, 2);
+}
+
+
+BOOST_AUTO_TEST_CASE(EmptyProgram)
+{
+	CCobProgram program;
+	program.Translate(std::vector<int>(), std::vector<int>(), std::vector<int>(), std::vector<std::string>());
+
+	BOOST_CHECK_EQUAL(program.GetNumInstructions(), 0);
+	BOOST_CHECK(program.GetCode() == NULL);
+}
+
+
+BOOST_AUTO_TEST_CASE(Calls)
+{
+	TestScripts scripts;
+
+	const int caller[] = {
+		PUSH_CONSTANT, 5,
+		CALL, 1, 1,
+		CALL, 2, 0,
+		CALL, 3, 0,
+		RETURN,
+	};
+	const int callee[] = {
+		RETURN,
+	};
+
+	scripts.AddScript("Caller", MakeCode(caller, sizeof(caller) / sizeof(caller[0])));
+	scripts.AddScript("Callee", MakeCode(callee, sizeof(callee) / sizeof(callee[0])));
+	scripts.AddScript("lua_Func", std::vector<int>());
+	scripts.AddScript("Empty", std::vector<int>());
+	scripts.Translate();
+
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).opcode, COBOP_CALL);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).arg1, 1);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).arg2, 1);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(2).opcode, COBOP_LUA_CALL);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(3).opcode, COBOP_NOP);
+
+	const int entry = scripts.program.GetEntry(1);
+
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(entry).opcode, COBOP_RETURN);
+	BOOST_CHECK_EQUAL(scripts.program.GetCodeOffset(entry), 12);
+
+	// running off the end of the last script fails like the padding it ran into
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(entry + 1).opcode, COBOP_INVALID);
+	BOOST_CHECK_EQUAL(scripts.program.GetEntry(2), entry + 1);
+	BOOST_CHECK_EQUAL(scripts.program.GetEntry(3), entry + 1);
+}
+
+
+BOOST_AUTO_TEST_CASE(ConstantUnitValues)
+{
+	TestScripts scripts;
+
+	const int getters[] = {
+		PUSH_CONSTANT, 4,    // HEALTH
+		GET_UNIT_VALUE,
+		PUSH_CONSTANT, 112,  // LUA2
+		GET_UNIT_VALUE,
+		ADD,
+		PUSH_CONSTANT, 4,
+		GET_UNIT_VALUE,      // jumped to, not fused
+		JUMP, 9,
+	};
+
+	scripts.AddScript("Getters", MakeCode(getters, sizeof(getters) / sizeof(getters[0])));
+	scripts.Translate();
+
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(0).opcode, COBOP_GET_UNIT_VALUE_CONST);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(0).arg1, 4);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).opcode, COBOP_GET_LUA_ARG);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(1).arg1, 2);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(2).opcode, COBOP_ADD);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(3).opcode, COBOP_PUSH_CONSTANT);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(4).opcode, COBOP_GET_UNIT_VALUE);
+	BOOST_CHECK_EQUAL(scripts.GetInstruction(5).arg1, 4);
+}
+
+
+BOOST_AUTO_TEST_CASE(ManyScripts)
+{
+	// a typical animation loop, repeated over many scripts
+	const int anim[] = {
+		PUSH_CONSTANT, 4,
+		GET_UNIT_VALUE,
+		PUSH_CONSTANT, 50,
+		ADD,
+		SLEEP,
+		PUSH_CONSTANT, 1,
+		JUMP_NOT_EQUAL, 0,
+		RETURN,
+	};
+	const int numWords = sizeof(anim) / sizeof(anim[0]);
+	const int numScripts = 1000;
+
+	TestScripts scripts;
+
+	for (int n = 0; n < numScripts; n++) {
+		std::vector<int> scriptCode = MakeCode(anim, numWords);
+		scriptCode[10] = n * numWords;
+		scripts.AddScript("Anim", scriptCode);
+	}
+
+	scripts.Translate();
+
+	// (fused get-unit-value, plus the INVALID after the last script)
+	BOOST_CHECK_EQUAL(scripts.program.GetNumInstructions(), numScripts * 7 + 1);
+
+	for (int n = 0; n < numScripts; n++) {
+		BOOST_CHECK_EQUAL(scripts.program.GetEntry(n), n * 7);
+		BOOST_CHECK_EQUAL(scripts.GetInstruction(n * 7 + 5).arg1, n * 7);
+	}
+}
@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/FileSystem/Archives/ArchiveFileCache.h"
+
+#define BOOST_TEST_MODULE ArchiveFileCache
+#include <boost/test/unit_test.hpp>
+
+static const int archiveA = 0;
+static const int archiveB = 1;
+
+static std::vector<boost::uint8_t> MakeFile(size_t size, boost::uint8_t value)
+{
+	return std::vector<boost::uint8_t>(size, value);
+}
+
+
+BOOST_AUTO_TEST_CASE(HitMiss)
+{
+	CArchiveFileCache cache(1024);
+	std::vector<boost::uint8_t> buffer;
+	bool exists = false;
+
+	BOOST_CHECK(!cache.Get(&archiveA, 0, buffer, exists));
+
+	cache.Insert(&archiveA, 0, MakeFile(100, 1), true);
+	cache.Insert(&archiveA, 1, MakeFile(0, 0), false);
+
+	BOOST_CHECK(cache.Get(&archiveA, 0, buffer, exists));
+	BOOST_CHECK(exists);
+	BOOST_CHECK(buffer == MakeFile(100, 1));
+
+	// failed extractions are remembered too
+	BOOST_CHECK(cache.Get(&archiveA, 1, buffer, exists));
+	BOOST_CHECK(!exists);
+
+	BOOST_CHECK(!cache.Get(&archiveB, 0, buffer, exists));
+
+	const CArchiveFileCache::Stats stats = cache.GetStats();
+	BOOST_CHECK_EQUAL(stats.hits, 2);
+	BOOST_CHECK_EQUAL(stats.misses, 2);
+	BOOST_CHECK_EQUAL(stats.numFiles, 2);
+	BOOST_CHECK_EQUAL(stats.usedBytes, 100);
+}
+
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+	CArchiveFileCache cache(300);
+	std::vector<boost::uint8_t> buffer;
+	bool exists = false;
+
+	cache.Insert(&archiveA, 0, MakeFile(100, 0), true);
+	cache.Insert(&archiveA, 1, MakeFile(100, 1), true);
+	cache.Insert(&archiveA, 2, MakeFile(100, 2), true);
+
+	// touch the oldest, so file 1 becomes the least recently used
+	BOOST_CHECK(cache.Get(&archiveA, 0, buffer, exists));
+
+	cache.Insert(&archiveA, 3, MakeFile(100, 3), true);
+
+	BOOST_CHECK(!cache.Get(&archiveA, 1, buffer, exists));
+	BOOST_CHECK(cache.Get(&archiveA, 0, buffer, exists));
+	BOOST_CHECK(cache.Get(&archiveA, 2, buffer, exists));
+	BOOST_CHECK(cache.Get(&archiveA, 3, buffer, exists));
+
+	// larger than the budget, never cached
+	cache.Insert(&archiveA, 4, MakeFile(301, 4), true);
+	BOOST_CHECK(!cache.Get(&archiveA, 4, buffer, exists));
+
+	BOOST_CHECK_EQUAL(cache.GetStats().evictions, 1);
+	BOOST_CHECK_EQUAL(cache.GetStats().usedBytes, 300);
+
+	cache.SetMaxSize(150);
+	BOOST_CHECK_EQUAL(cache.GetStats().numFiles, 1);
+	BOOST_CHECK_EQUAL(cache.GetStats().usedBytes, 100);
+	BOOST_CHECK(cache.Get(&archiveA, 3, buffer, exists));
+}
+
+
+BOOST_AUTO_TEST_CASE(RemoveArchive)
+{
+	CArchiveFileCache cache(1024);
+	std::vector<boost::uint8_t> buffer;
+	bool exists = false;
+
+	cache.Insert(&archiveA, 0, MakeFile(10, 0), true);
+	cache.Insert(&archiveA, 7, MakeFile(10, 0), true);
+	cache.Insert(&archiveB, 0, MakeFile(10, 0), true);
+
+	cache.Remove(&archiveA);
+
+	BOOST_CHECK(!cache.Get(&archiveA, 0, buffer, exists));
+	BOOST_CHECK(!cache.Get(&archiveA, 7, buffer, exists));
+	BOOST_CHECK(cache.Get(&archiveB, 0, buffer, exists));
+	BOOST_CHECK_EQUAL(cache.GetStats().numFiles, 1);
+	BOOST_CHECK_EQUAL(cache.GetStats().usedBytes, 10);
+}
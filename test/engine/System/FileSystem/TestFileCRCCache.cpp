@@ -0,0 +1,106 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/FileSystem/Archives/FileCRCCache.h"
+#include "System/CRC.h"
+
+#include <cstdio>
+#include <string>
+
+#define BOOST_TEST_MODULE FileCRCCache
+#include <boost/test/unit_test.hpp>
+
+static const std::string testFile = "testFileCRCCache.txt";
+static const std::string cacheFile = "testFileCRCCache.dat";
+
+static void WriteFile(const std::string& filePath, const std::string& content)
+{
+	FILE* file = fopen(filePath.c_str(), "wb");
+	BOOST_REQUIRE(file != NULL);
+	fwrite(content.data(), 1, content.size(), file);
+	fclose(file);
+}
+
+static unsigned int StringCRC(const std::string& content)
+{
+	CRC crc;
+	crc.Update(content.data(), content.size());
+	return crc.GetDigest();
+}
+
+
+BOOST_AUTO_TEST_CASE(HashAndPersist)
+{
+	CFileCRCCache& cache = CFileCRCCache::GetInstance();
+
+	WriteFile(testFile, "some content");
+	BOOST_CHECK_EQUAL(cache.GetCRC(testFile), StringCRC("some content"));
+	BOOST_CHECK(cache.Save(cacheFile));
+
+	// a different size invalidates the entry
+	WriteFile(testFile, "other, longer content");
+	BOOST_CHECK(cache.Load(cacheFile));
+	BOOST_CHECK_EQUAL(cache.GetCRC(testFile), StringCRC("other, longer content"));
+
+	// empty and missing files hash like no data
+	WriteFile(testFile, "");
+	BOOST_CHECK_EQUAL(cache.GetCRC(testFile), CRC().GetDigest());
+
+	remove(testFile.c_str());
+	BOOST_CHECK_EQUAL(cache.GetCRC(testFile), CRC().GetDigest());
+	BOOST_CHECK(cache.Save(cacheFile));
+	remove(cacheFile.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(CachedEntriesAreUsed)
+{
+	CFileCRCCache& cache = CFileCRCCache::GetInstance();
+
+	WriteFile(testFile, "abcd");
+	const unsigned int crc = cache.GetCRC(testFile);
+	BOOST_CHECK(cache.Save(cacheFile));
+
+	// same size, and (within a second) the same mtime and inode: the
+	// stale CRC comes from the cache, proving the file was not read again
+	FILE* file = fopen(testFile.c_str(), "r+b");
+	BOOST_REQUIRE(file != NULL);
+	fwrite("dcba", 1, 4, file);
+	fclose(file);
+
+	BOOST_CHECK(cache.Load(cacheFile));
+	BOOST_CHECK_EQUAL(cache.GetCRC(testFile), crc);
+
+	remove(testFile.c_str());
+	remove(cacheFile.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(SaveReplacesCache)
+{
+	CFileCRCCache& cache = CFileCRCCache::GetInstance();
+
+	WriteFile(cacheFile, "not a cache");
+	BOOST_CHECK(!cache.Load(cacheFile));
+
+	WriteFile(testFile, "abcd");
+	cache.GetCRC(testFile);
+	BOOST_CHECK(cache.Save(cacheFile));
+
+	// the temporary was renamed over the old cache
+	BOOST_CHECK(fopen((cacheFile + ".tmp").c_str(), "rb") == NULL);
+	BOOST_CHECK(cache.Load(cacheFile));
+
+	remove(testFile.c_str());
+	remove(cacheFile.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE(InvalidCacheFile)
+{
+	CFileCRCCache& cache = CFileCRCCache::GetInstance();
+
+	WriteFile(cacheFile, "not a cache");
+	BOOST_CHECK(!cache.Load(cacheFile));
+	BOOST_CHECK(!cache.Load("nonexistingFileCRCCache.dat"));
+	remove(cacheFile.c_str());
+}
@@ -0,0 +1,83 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Net/PacketBlock.h"
+#include "System/Net/RawPacket.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+
+#include <string>
+
+#define BOOST_TEST_MODULE PacketBlock
+#include <boost/test/unit_test.hpp>
+
+typedef boost::shared_ptr<const netcode::RawPacket> PacketPtr;
+
+static bool SamePacket(const PacketPtr& a, const PacketPtr& b)
+{
+	return (a->length == b->length && std::equal(a->data, a->data + a->length, b->data));
+}
+
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+	CBaseNetProtocol& proto = CBaseNetProtocol::Get();
+	std::vector<PacketPtr> packets;
+
+	for (int n = 0; n < 500; n++) {
+		packets.push_back(proto.SendNewFrame());
+
+		if ((n % 16) == 0)
+			packets.push_back(proto.SendKeyFrame(n));
+		if ((n % 50) == 0)
+			packets.push_back(proto.SendSystemMessage(n % 10, "message " + std::string(n % 37, 'x')));
+	}
+
+	PacketPtr block(netcode::PacketBlock::Pack(packets));
+	BOOST_REQUIRE(block);
+	BOOST_CHECK(netcode::PacketBlock::IsBlock(block.get()));
+
+	std::deque<PacketPtr> unpacked;
+	BOOST_REQUIRE(netcode::PacketBlock::Unpack(block.get(), unpacked));
+	BOOST_REQUIRE_EQUAL(unpacked.size(), packets.size());
+
+	for (size_t n = 0; n < packets.size(); n++) {
+		BOOST_CHECK(SamePacket(packets[n], unpacked[n]));
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(Oversized)
+{
+	std::vector<PacketPtr> packets;
+
+	// 48 * 1k sysmsgs exceed MAX_CONTENT_SIZE
+	for (int n = 0; n < 48; n++) {
+		packets.push_back(CBaseNetProtocol::Get().SendSystemMessage(0, std::string(1024, 'a')));
+	}
+
+	BOOST_CHECK(netcode::PacketBlock::Pack(packets) == NULL);
+	BOOST_CHECK(netcode::PacketBlock::Pack(std::vector<PacketPtr>()) == NULL);
+}
+
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+	std::vector<PacketPtr> packets(1, CBaseNetProtocol::Get().SendNewFrame());
+	PacketPtr block(netcode::PacketBlock::Pack(packets));
+	BOOST_REQUIRE(block);
+
+	// corrupt the compressed data
+	netcode::RawPacket corrupt(block->data, block->length);
+	corrupt.data[corrupt.length - 1] ^= 0xFF;
+
+	// claim more content than a block can hold
+	netcode::RawPacket bloated(block->data, block->length);
+	bloated.data[3] = 0xFF;
+	bloated.data[4] = 0xFF;
+	bloated.data[5] = 0xFF;
+
+	std::deque<PacketPtr> unpacked;
+	BOOST_CHECK(!netcode::PacketBlock::Unpack(&corrupt, unpacked));
+	BOOST_CHECK(!netcode::PacketBlock::Unpack(&bloated, unpacked));
+	BOOST_CHECK(!netcode::PacketBlock::Unpack(packets[0].get(), unpacked));
+	BOOST_CHECK(unpacked.empty());
+}
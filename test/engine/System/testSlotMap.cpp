@@ -0,0 +1,99 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/SlotMap.h"
+
+#include <vector>
+
+#define BOOST_TEST_MODULE SlotMap
+#include <boost/test/unit_test.hpp>
+
+
+BOOST_AUTO_TEST_CASE( InsertFindErase )
+{
+	SlotMap<int> sm;
+
+	const int id0 = sm.insert(10);
+	const int id1 = sm.insert(11);
+	const int id2 = sm.insert(12);
+
+	BOOST_CHECK(sm.size() == 3);
+	BOOST_CHECK(*sm.find(id0) == 10);
+	BOOST_CHECK(*sm.find(id1) == 11);
+	BOOST_CHECK(*sm.find(id2) == 12);
+
+	// swap-remove keeps the other IDs valid
+	BOOST_CHECK(sm.erase(id0));
+	BOOST_CHECK(!sm.erase(id0));
+	BOOST_CHECK(sm.find(id0) == NULL);
+	BOOST_CHECK(*sm.find(id1) == 11);
+	BOOST_CHECK(*sm.find(id2) == 12);
+	BOOST_CHECK(sm.size() == 2);
+
+	BOOST_CHECK(sm.find(-1) == NULL);
+	BOOST_CHECK(sm.find(12345) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE( StaleIDs )
+{
+	SlotMap<int> sm;
+
+	const int id0 = sm.insert(0);
+	sm.erase(id0);
+
+	// released slots are reused FIFO and a reused slot gets a new generation
+	std::vector<int> ids;
+	for (int i = 0; i < 8; i++) {
+		ids.push_back(sm.insert(i));
+	}
+
+	for (int i = 0; i < 8; i++) {
+		BOOST_CHECK(ids[i] != id0);
+		BOOST_CHECK(ids[i] < (1 << 24));
+		BOOST_CHECK(*sm.find(ids[i]) == i);
+	}
+
+	BOOST_CHECK(sm.find(id0) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE( Filter )
+{
+	SlotMap<int> sm;
+	std::vector<int> ids;
+
+	for (int i = 0; i < 10; i++) {
+		ids.push_back(sm.insert(i));
+	}
+
+	int numVisited = 0;
+
+	// drop odd values, append one new value per multiple of 4 while iterating
+	sm.filter([&](int v) -> bool {
+		numVisited++;
+
+		// every surviving value is still reachable by its ID mid-pass
+		for (int i = 0; i < 10; i += 2) {
+			BOOST_CHECK(*sm.find(ids[i]) == i);
+		}
+
+		if (v < 10 && (v % 4) == 0)
+			sm.insert(100 + v);
+
+		return ((v % 2) == 0);
+	});
+
+	BOOST_CHECK(numVisited == 10 + 3);
+	BOOST_CHECK(sm.size() == 5 + 3);
+
+	const int expected[] = {0, 2, 4, 6, 8, 100, 104, 108};
+
+	for (unsigned int n = 0; n < sm.size(); n++) {
+		BOOST_CHECK(sm[n] == expected[n]);
+	}
+	for (int i = 0; i < 10; i++) {
+		BOOST_CHECK((sm.find(ids[i]) != NULL) == ((i % 2) == 0));
+	}
+
+	sm.clear();
+	BOOST_CHECK(sm.empty());
+	BOOST_CHECK(sm.find(ids[0]) == NULL);
+}
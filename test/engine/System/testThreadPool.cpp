@@ -125,6 +125,28 @@ BOOST_AUTO_TEST_CASE( testThreadPool7 )
 	});
 }
 
+BOOST_AUTO_TEST_CASE( testThreadPool8 )
+{
+	LOG_L(L_WARNING, "testThreadPool8");
+
+	// heavily unbalanced work, the cheap ranges should steal from the expensive ones
+	std::vector<std::atomic<int>> visits(20000);
+	for (auto& v: visits)
+		v = 0;
+
+	for_mt(0, visits.size(), [&](const int i) {
+		if (i < 1000) {
+			volatile float x = 0.0f;
+			for (int n = 0; n < 2000; n++) x += math::sqrt(float(n));
+		}
+		visits[i]++;
+	});
+
+	for (auto& v: visits) {
+		BOOST_CHECK(v == 1);
+	}
+}
+
 struct do_once {
 	do_once()   {}
 	~do_once()  {
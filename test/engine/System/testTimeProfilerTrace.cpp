@@ -0,0 +1,123 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/thread.hpp>
+
+#define BOOST_TEST_MODULE TimeProfilerTrace
+#include <boost/test/unit_test.hpp>
+
+
+static std::string ReadFile(const std::string& fileName)
+{
+	std::ifstream ifs(fileName.c_str());
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	return ss.str();
+}
+
+static size_t CountOccurrences(const std::string& str, const std::string& pattern)
+{
+	size_t count = 0;
+
+	for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1)) {
+		count++;
+	}
+
+	return count;
+}
+
+static void WorkerTimers()
+{
+	for (int n = 0; n < 10; n++) {
+		ScopedMtTimer timer("TraceTest::Worker");
+	}
+}
+
+static volatile bool stopFlooding = false;
+
+static void FloodTimers()
+{
+	while (!stopFlooding) {
+		ScopedMtTimer timer("TraceTest::Concurrent");
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(DumpTrace)
+{
+	spring_clock::PushTickRate();
+	spring_time::setstarttime(spring_time::gettime(true));
+
+	for (int n = 0; n < 5; n++) {
+		SCOPED_TIMER("TraceTest::Main");
+	}
+
+	boost::thread worker(&WorkerTimers);
+	worker.join();
+
+	const std::string fileName = "testTimeProfilerTrace.json";
+	BOOST_CHECK(profiler.DumpTrace(fileName));
+
+	const std::string trace = ReadFile(fileName);
+	std::remove(fileName.c_str());
+
+	BOOST_CHECK(trace.find("{\"displayTimeUnit\"") == 0);
+	BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"thread_name\""), 2);
+	BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"TraceTest::Main\""), 5);
+	BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"TraceTest::Worker\""), 10);
+}
+
+
+BOOST_AUTO_TEST_CASE(RingOverwritesOldest)
+{
+	// more events than fit into one ring; only the newest ones survive
+	for (int n = 0; n < (1 << 15); n++) {
+		SCOPED_TIMER("TraceTest::Flood");
+	}
+
+	const std::string fileName = "testTimeProfilerTrace.json";
+	BOOST_CHECK(profiler.DumpTrace(fileName));
+
+	const std::string trace = ReadFile(fileName);
+	std::remove(fileName.c_str());
+
+	BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"TraceTest::Main\""), 0);
+	BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"TraceTest::Flood\""), 1 << 14);
+	BOOST_CHECK_EQUAL(CountOccurrences(trace, "\"TraceTest::Worker\""), 10);
+}
+
+
+BOOST_AUTO_TEST_CASE(DumpWhileWriting)
+{
+	// the dumping thread races the owner of a ring that wraps many times
+	// over; every event it writes out must still be a complete one
+	boost::thread flooder(&FloodTimers);
+
+	const std::string fileName = "testTimeProfilerTrace.json";
+
+	for (int n = 0; n < 20; n++) {
+		BOOST_CHECK(profiler.DumpTrace(fileName));
+
+		const std::string trace = ReadFile(fileName);
+		const size_t numEvents = CountOccurrences(trace, "\"ph\": \"X\"");
+		const size_t numNamed =
+			CountOccurrences(trace, "\"TraceTest::Main\"") +
+			CountOccurrences(trace, "\"TraceTest::Flood\"") +
+			CountOccurrences(trace, "\"TraceTest::Worker\"") +
+			CountOccurrences(trace, "\"TraceTest::Concurrent\"");
+
+		BOOST_CHECK_EQUAL(numEvents, numNamed);
+		BOOST_CHECK(CountOccurrences(trace, "\"TraceTest::Concurrent\"") <= (1 << 14));
+	}
+
+	stopFlooding = true;
+	flooder.join();
+
+	std::remove(fileName.c_str());
+}
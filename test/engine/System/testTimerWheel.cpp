@@ -0,0 +1,124 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/TimerWheel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE TimerWheel
+#include <boost/test/unit_test.hpp>
+
+
+BOOST_AUTO_TEST_CASE( DueOrder )
+{
+	TimerWheel<int> tw;
+	std::vector<int> due;
+
+	tw.insert(0, 10);
+	tw.insert(1, 5);
+	tw.insert(2, 10);
+	tw.insert(3, 5);
+	BOOST_CHECK(tw.size() == 4);
+
+	// due strictly before the given time
+	tw.advance(5, due);
+	BOOST_CHECK(due.empty());
+
+	tw.advance(11, due);
+	BOOST_CHECK(tw.empty());
+	BOOST_CHECK(tw.time() == 11);
+	BOOST_CHECK(due.size() == 4);
+
+	// by time, then by insertion
+	BOOST_CHECK(due[0] == 1);
+	BOOST_CHECK(due[1] == 3);
+	BOOST_CHECK(due[2] == 0);
+	BOOST_CHECK(due[3] == 2);
+}
+
+BOOST_AUTO_TEST_CASE( Overdue )
+{
+	TimerWheel<int> tw;
+	std::vector<int> due;
+
+	tw.insert(0, 100);
+	tw.advance(50, due);
+	BOOST_CHECK(due.empty());
+
+	tw.insert(1, 10);
+	tw.insert(2, 50);
+	tw.advance(51, due);
+
+	BOOST_CHECK(due.size() == 2);
+	BOOST_CHECK(due[0] == 1);
+	BOOST_CHECK(due[1] == 2);
+	BOOST_CHECK(tw.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE( Cascade )
+{
+	// delays crossing every level boundary, advanced in frame-sized steps
+	const int delays[] = {1, 255, 256, 257, 65535, 65536, 65537, 300000, 16777215, 16777216, 20000000};
+	const int numDelays = sizeof(delays) / sizeof(delays[0]);
+
+	TimerWheel<int> tw;
+	std::vector<int> due;
+
+	tw.advance(1000, due);
+
+	for (int n = 0; n < numDelays; n++) {
+		tw.insert(n, tw.time() + delays[n]);
+	}
+
+	for (int n = 0; n < numDelays; n++) {
+		const int dueTime = 1000 + delays[n];
+
+		due.clear();
+		tw.advance(dueTime, due);
+		BOOST_CHECK(due.empty());
+
+		tw.advance(dueTime + 1, due);
+		BOOST_CHECK(due.size() == 1);
+		BOOST_CHECK(!due.empty() && due[0] == n);
+	}
+
+	BOOST_CHECK(tw.empty());
+}
+
+BOOST_AUTO_TEST_CASE( MatchesSortedOrder )
+{
+	TimerWheel<int> tw;
+	std::vector< std::pair<int, int> > expected;
+	std::vector<int> due;
+
+	srand(42);
+
+	// sleep/wake like COB threads, with the time advancing by 33ms per frame
+	int value = 0;
+
+	for (int frame = 0; frame < 2000; frame++) {
+		for (int n = rand() % 20; n > 0; n--) {
+			const int time = tw.time() + ((rand() % 4 == 0)? (rand() % 100000): (rand() % 1000));
+
+			tw.insert(value, time);
+			expected.push_back(std::make_pair(time, value++));
+		}
+
+		tw.advance(tw.time() + 33, due);
+	}
+
+	std::vector<int> rest;
+	tw.clear(rest);
+	BOOST_CHECK(tw.empty());
+
+	due.insert(due.end(), rest.begin(), rest.end());
+	std::stable_sort(expected.begin(), expected.end());
+
+	BOOST_CHECK(due.size() == expected.size());
+
+	for (size_t n = 0; n < std::min(due.size(), expected.size()); n++) {
+		BOOST_CHECK(due[n] == expected[n].second);
+	}
+}
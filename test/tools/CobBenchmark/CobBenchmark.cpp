@@ -0,0 +1,220 @@
+// Times the translation of COB code by CCobProgram, as done for every script at load.
+// g++ -std=c++11 -Wall -O2 -o cobbench CobBenchmark.cpp ../../../rts/Sim/Units/Scripts/CobProgram.cpp -I ../../../rts/
+//
+// Drives the real CCobProgram::Translate (like testCobProgram) over generated
+// unit scripts shaped like compiled BOS: local-variable arithmetic, piece
+// moves and turns, unit-value lookups, sleeps, calls and loops. Every "file"
+// gets its own CCobProgram like a CCobFile does, and all runs must produce
+// the same instructions (with no INVALID ones but the end-of-code guard).
+//
+// The interpreter itself (CCobThread) needs live units; it is timed in-game
+// by the CobEngine::Tick column of tools/benchmark/benchmark_headless.sh.
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Sim/Units/Scripts/CobProgram.h"
+
+static const int MOVE             = 0x10001000;
+static const int TURN             = 0x10002000;
+static const int SLEEP            = 0x10013000;
+static const int PUSH_CONSTANT    = 0x10021001;
+static const int PUSH_LOCAL_VAR   = 0x10021002;
+static const int PUSH_STATIC      = 0x10021004;
+static const int CREATE_LOCAL_VAR = 0x10022000;
+static const int POP_LOCAL_VAR    = 0x10023002;
+static const int ADD              = 0x10031000;
+static const int MUL              = 0x10033000;
+static const int GET_UNIT_VALUE   = 0x10042000;
+static const int SET_LESS         = 0x10051000;
+static const int CALL             = 0x10062000;
+static const int JUMP             = 0x10064000;
+static const int RETURN           = 0x10065000;
+static const int JUMP_NOT_EQUAL   = 0x10066000;
+
+static const int NUM_FILES = 500;
+static const int NUM_SCRIPTS_PER_FILE = 60;
+static const int NUM_STATEMENTS_PER_SCRIPT = 12;
+static const int NUM_PIECES = 24;
+static const int NUM_RUNS = 5;
+
+
+struct CobFileCode {
+	std::vector<int> code;
+	std::vector<int> scriptOffsets;
+	std::vector<int> scriptLengths;
+	std::vector<std::string> scriptNames;
+};
+
+
+static void AddStatement(std::vector<int>& code, int numScripts)
+{
+	switch (rand() % 7) {
+		case 0: {
+			// x = x + k * y
+			const int words[] = {
+				PUSH_LOCAL_VAR, 0,
+				PUSH_CONSTANT, rand() % 100,
+				PUSH_LOCAL_VAR, 1,
+				MUL,
+				ADD,
+				POP_LOCAL_VAR, 0,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+		case 1: {
+			// turn piece to <angle> speed <speed>
+			const int words[] = {
+				PUSH_CONSTANT, rand() % 65536,
+				PUSH_CONSTANT, rand() % 1000,
+				TURN, rand() % NUM_PIECES, rand() % 3,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+		case 2: {
+			// move piece to <pos> speed <speed>
+			const int words[] = {
+				PUSH_STATIC, rand() % 8,
+				PUSH_CONSTANT, rand() % 1000,
+				MOVE, rand() % NUM_PIECES, rand() % 3,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+		case 3: {
+			// y = get HEALTH (fused into one instruction)
+			const int words[] = {
+				PUSH_CONSTANT, 4,
+				GET_UNIT_VALUE,
+				POP_LOCAL_VAR, 1,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+		case 4: {
+			// if (x < k) { sleep 33; }
+			const int skip = code.size() + 10;
+			const int words[] = {
+				PUSH_LOCAL_VAR, 0,
+				PUSH_CONSTANT, rand() % 100,
+				SET_LESS,
+				JUMP_NOT_EQUAL, skip,
+				PUSH_CONSTANT, 33,
+				SLEEP,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+		case 5: {
+			// call-script another one of this file
+			const int words[] = {
+				PUSH_LOCAL_VAR, 0,
+				CALL, rand() % numScripts, 1,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+		case 6: {
+			// while (x < k) { x = x + 1; }
+			const int loop = code.size();
+			const int done = loop + 16;
+			const int words[] = {
+				PUSH_LOCAL_VAR, 0,
+				PUSH_CONSTANT, rand() % 100,
+				SET_LESS,
+				JUMP_NOT_EQUAL, done,
+				PUSH_LOCAL_VAR, 0,
+				PUSH_CONSTANT, 1,
+				ADD,
+				POP_LOCAL_VAR, 0,
+				JUMP, loop,
+			};
+			code.insert(code.end(), words, words + sizeof(words) / sizeof(words[0]));
+		} break;
+	}
+}
+
+static CobFileCode MakeFile()
+{
+	CobFileCode file;
+
+	for (int s = 0; s < NUM_SCRIPTS_PER_FILE; s++) {
+		const int offset = file.code.size();
+
+		file.code.push_back(CREATE_LOCAL_VAR);
+		file.code.push_back(CREATE_LOCAL_VAR);
+
+		for (int n = 0; n < NUM_STATEMENTS_PER_SCRIPT; n++) {
+			AddStatement(file.code, NUM_SCRIPTS_PER_FILE);
+		}
+
+		file.code.push_back(PUSH_CONSTANT);
+		file.code.push_back(0);
+		file.code.push_back(RETURN);
+
+		file.scriptOffsets.push_back(offset);
+		file.scriptLengths.push_back(file.code.size() - offset);
+		file.scriptNames.push_back("Script" + std::to_string(s));
+	}
+
+	return file;
+}
+
+
+int main()
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	srand(1234);
+
+	std::vector<CobFileCode> files(NUM_FILES);
+	size_t numWords = 0;
+
+	for (unsigned int n = 0; n < files.size(); n++) {
+		files[n] = MakeFile();
+		numWords += files[n].code.size();
+	}
+
+	std::printf("%d files of %d scripts, %lu code words\n", NUM_FILES, NUM_SCRIPTS_PER_FILE, (unsigned long) numWords);
+
+	double bestSecs = 1e9;
+	size_t firstNumIns = 0;
+
+	for (int run = 0; run < NUM_RUNS; run++) {
+		size_t numIns = 0;
+		size_t numInvalid = 0;
+
+		const Clock::time_point t0 = Clock::now();
+
+		for (unsigned int n = 0; n < files.size(); n++) {
+			const CobFileCode& file = files[n];
+
+			CCobProgram program;
+			program.Translate(file.code, file.scriptOffsets, file.scriptLengths, file.scriptNames);
+
+			numIns += program.GetNumInstructions();
+
+			for (int i = 0; i < program.GetNumInstructions(); i++) {
+				numInvalid += (program.GetCode()[i].opcode == COBOP_INVALID);
+			}
+		}
+
+		const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+
+		if (run == 0)
+			firstNumIns = numIns;
+
+		if (numIns != firstNumIns || numInvalid != NUM_FILES) {
+			std::printf("run %d: %lu instructions (%lu invalid), expected %lu\n", run, (unsigned long) numIns, (unsigned long) numInvalid, (unsigned long) firstNumIns);
+			return 1;
+		}
+
+		bestSecs = std::min(bestSecs, secs);
+	}
+
+	std::printf("translate: %lu instructions, %.2fms (%.1f M words/s, %.1f us per file)\n",
+		(unsigned long) firstNumIns,
+		bestSecs * 1e3,
+		(numWords / bestSecs) * 1e-6,
+		(bestSecs / NUM_FILES) * 1e6);
+	return 0;
+}
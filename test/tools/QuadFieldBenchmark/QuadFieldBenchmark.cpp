@@ -0,0 +1,279 @@
+// Times the projectile bookkeeping and queries of CQuadField on a large map.
+// g++ -std=c++11 -Wall -O2 -DNOT_USING_CREG -DNOT_USING_STREFLOP -DBUILDING_AI -o qfbench QuadFieldBenchmark.cpp -I ../../../rts/ -I ../../../rts/lib/
+//
+// CQuadField can not run without the simulation, so this drives the code it
+// uses for projectiles (QuadFieldProjectileCells.h) with its cell layout:
+//   list      the former std::list cells, erased through stored iterators
+//   vector    the flat cells of QuadFieldProjectileCells (swap-remove)
+// Each frame every non-hit-scan projectile moves (re-inserted when it leaves
+// its cell, like CQuadField::MovedProjectile), some are replaced by new ones
+// and a number of GetProjectilesExact-style radius queries run. Both layouts
+// see the same sequence and must return the same number of projectiles.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <vector>
+#include "Sim/Misc/QuadFieldProjectileCells.h"
+
+// a 32x32 map, with CQuadField::BASE_QUAD_SIZE
+static const int MAP_SIZE = 32 * 512;
+static const int QUAD_SIZE = 128;
+static const int NUM_QUADS = MAP_SIZE / QUAD_SIZE;
+
+static const int NUM_PROJECTILES = 40000;
+static const int NUM_FRAMES = 300;
+static const int NUM_RESPAWNS_PER_FRAME = 400;
+static const int NUM_QUERIES_PER_FRAME = 2000;
+static const float QUERY_RADIUS = 300.0f;
+
+
+static inline int CellIdx(float wpx) { return std::max(0, std::min(int(wpx / QUAD_SIZE), NUM_QUADS - 1)); }
+
+
+struct BenchProjectile {
+	// same interface as CProjectile::QuadFieldCellData
+	struct QuadFieldCellData {
+		QuadFieldCellData() {
+			for (unsigned int n = 0; n < 3; n++) {
+				indices[n] = -1;
+			}
+		}
+
+		const int2& GetCoor(unsigned int idx) const { return coors[idx]; }
+		int GetIndex(unsigned int idx) const { return indices[idx]; }
+
+		void SetCoor(unsigned int idx, const int2& co) { coors[idx] = co; }
+		void SetIndex(unsigned int idx, int i) { indices[idx] = i; }
+
+	private:
+		int2 coors[3];
+		int indices[3];
+	};
+
+	QuadFieldCellData& GetQuadFieldCellData() { return qfCellData; }
+
+	// what the list cells stored instead of the indices
+	std::list<BenchProjectile*>::iterator iters[3];
+	bool inList[3];
+
+	QuadFieldCellData qfCellData;
+
+	float px, pz;
+	float vx, vz;
+	float radius;
+	bool hitscan;
+};
+
+
+struct ListQuadField {
+	ListQuadField(): cells(NUM_QUADS * NUM_QUADS) {}
+
+	std::list<BenchProjectile*>& Cell(const int2& c) { return cells[c.y * NUM_QUADS + c.x]; }
+
+	void AddProjectile(BenchProjectile* p) {
+		BenchProjectile::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
+		const unsigned int numCoors = SetCoors(p);
+
+		for (unsigned int n = 0; n < 3; n++) {
+			p->inList[n] = (n < numCoors && (n == 0 || qfcd.GetCoor(n) != qfcd.GetCoor(n - 1)));
+
+			if (!p->inList[n])
+				continue;
+
+			std::list<BenchProjectile*>& list = Cell(qfcd.GetCoor(n));
+			p->iters[n] = list.insert(list.end(), p);
+		}
+	}
+
+	void RemoveProjectile(BenchProjectile* p) {
+		BenchProjectile::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
+
+		for (unsigned int n = 0; n < 3; n++) {
+			if (!p->inList[n])
+				continue;
+
+			Cell(qfcd.GetCoor(n)).erase(p->iters[n]);
+			p->inList[n] = false;
+		}
+	}
+
+	static unsigned int SetCoors(BenchProjectile* p);
+
+	std::vector< std::list<BenchProjectile*> > cells;
+};
+
+
+struct VectorQuadField {
+	VectorQuadField(): cells(NUM_QUADS * NUM_QUADS) {}
+
+	std::vector<BenchProjectile*>& Cell(const int2& c) { return cells[c.y * NUM_QUADS + c.x]; }
+
+	struct Lookup {
+		Lookup(VectorQuadField* qf): quadField(qf) {}
+		std::vector<BenchProjectile*>& operator () (const int2& c) const { return quadField->Cell(c); }
+		VectorQuadField* quadField;
+	};
+
+	void AddProjectile(BenchProjectile* p) {
+		QuadFieldProjectileCells::Add(p, ListQuadField::SetCoors(p), Lookup(this));
+	}
+
+	void RemoveProjectile(BenchProjectile* p) {
+		QuadFieldProjectileCells::Remove(p, Lookup(this));
+	}
+
+	std::vector< std::vector<BenchProjectile*> > cells;
+};
+
+
+// like CQuadField::AddProjectile; returns the number of coordinates used
+unsigned int ListQuadField::SetCoors(BenchProjectile* p)
+{
+	BenchProjectile::QuadFieldCellData& qfcd = p->GetQuadFieldCellData();
+
+	qfcd.SetCoor(0, int2(CellIdx(p->px), CellIdx(p->pz)));
+
+	if (!p->hitscan)
+		return 1;
+
+	qfcd.SetCoor(1, int2(CellIdx(p->px + p->vx * 0.5f), CellIdx(p->pz + p->vz * 0.5f)));
+	qfcd.SetCoor(2, int2(CellIdx(p->px + p->vx       ), CellIdx(p->pz + p->vz       )));
+	return 3;
+}
+
+
+static void InitProjectile(BenchProjectile* p)
+{
+	p->px = (rand() % MAP_SIZE);
+	p->pz = (rand() % MAP_SIZE);
+	p->hitscan = ((rand() % 10) == 0);
+	p->radius = 2.0f + (rand() % 8);
+
+	// hit-scan "speeds" span up to a few quads
+	const float speed = (p->hitscan)? (200.0f + (rand() % 400)): (2.0f + (rand() % 30));
+	const float angle = (rand() % 6283) * 0.001f;
+
+	p->vx = speed * std::cos(angle);
+	p->vz = speed * std::sin(angle);
+}
+
+
+template<typename Cells>
+static size_t Query(const Cells& cells, float x, float z, float radius)
+{
+	// same cells as CQuadField::GetQuads(pos, radius)
+	const int minX = CellIdx(x - radius), maxX = CellIdx(x + radius);
+	const int minZ = CellIdx(z - radius), maxZ = CellIdx(z + radius);
+
+	size_t numFound = 0;
+
+	for (int cz = minZ; cz <= maxZ; cz++) {
+		for (int cx = minX; cx <= maxX; cx++) {
+			const typename Cells::value_type& cell = cells[cz * NUM_QUADS + cx];
+
+			for (typename Cells::value_type::const_iterator it = cell.begin(); it != cell.end(); ++it) {
+				const BenchProjectile* p = *it;
+				const float dx = x - p->px;
+				const float dz = z - p->pz;
+
+				if ((dx * dx + dz * dz) >= ((radius + p->radius) * (radius + p->radius)))
+					continue;
+
+				numFound++;
+			}
+		}
+	}
+
+	return numFound;
+}
+
+
+template<typename QF>
+static void Run(const char* name)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	std::vector<BenchProjectile> projectiles(NUM_PROJECTILES);
+	QF quadField;
+
+	srand(1234);
+
+	for (unsigned int n = 0; n < projectiles.size(); n++) {
+		InitProjectile(&projectiles[n]);
+		quadField.AddProjectile(&projectiles[n]);
+	}
+
+	double moveSecs = 0.0;
+	double querySecs = 0.0;
+	size_t numMoves = 0;
+	size_t numQueries = 0;
+	size_t numFound = 0;
+
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		const Clock::time_point t0 = Clock::now();
+
+		// CProjectileHandler::UpdateProjectileContainer + CQuadField::MovedProjectile
+		for (unsigned int n = 0; n < projectiles.size(); n++) {
+			BenchProjectile* p = &projectiles[n];
+
+			if (p->hitscan)
+				continue;
+
+			if (p->px + p->vx < 0.0f || p->px + p->vx >= MAP_SIZE) { p->vx = -p->vx; }
+			if (p->pz + p->vz < 0.0f || p->pz + p->vz >= MAP_SIZE) { p->vz = -p->vz; }
+
+			p->px += p->vx;
+			p->pz += p->vz;
+
+			if (p->GetQuadFieldCellData().GetCoor(0) == int2(CellIdx(p->px), CellIdx(p->pz)))
+				continue;
+
+			quadField.RemoveProjectile(p);
+			quadField.AddProjectile(p);
+			numMoves++;
+		}
+
+		// expired projectiles replaced by new ones
+		for (int n = 0; n < NUM_RESPAWNS_PER_FRAME; n++) {
+			BenchProjectile* p = &projectiles[rand() % NUM_PROJECTILES];
+
+			quadField.RemoveProjectile(p);
+			InitProjectile(p);
+			quadField.AddProjectile(p);
+			numMoves++;
+		}
+
+		const Clock::time_point t1 = Clock::now();
+
+		for (int n = 0; n < NUM_QUERIES_PER_FRAME; n++) {
+			numFound += Query(quadField.cells, rand() % MAP_SIZE, rand() % MAP_SIZE, QUERY_RADIUS);
+			numQueries++;
+		}
+
+		const Clock::time_point t2 = Clock::now();
+
+		moveSecs += std::chrono::duration<double>(t1 - t0).count();
+		querySecs += std::chrono::duration<double>(t2 - t1).count();
+	}
+
+	std::printf("%-8s moves=%lu (%.2f M/s) queries=%lu (%.2f K/s, %.1f found each) total=%.2fms\n",
+		name,
+		(unsigned long) numMoves, (numMoves / moveSecs) * 1e-6,
+		(unsigned long) numQueries, (numQueries / querySecs) * 1e-3,
+		double(numFound) / numQueries,
+		(moveSecs + querySecs) * 1e3);
+}
+
+
+int main()
+{
+	std::printf("%d projectiles on %dx%d quads, %d frames\n", NUM_PROJECTILES, NUM_QUADS, NUM_QUADS, NUM_FRAMES);
+
+	Run<ListQuadField>("list");
+	Run<VectorQuadField>("vector");
+	return 0;
+}
@@ -0,0 +1,27 @@
+#!/bin/bash
+
+# replays a demo unthrottled with the headless engine and collects the
+# per-SimFrame subsystem timings (one tab-separated file per run)
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 demo.sdf [minutes [runs]]"
+	exit 1
+fi
+
+DEMOFILE=$1
+MINUTES=${2:-5}
+TESTRUNS=${3:-3}
+
+CMD="./spring-headless --benchmark $MINUTES --benchmarkstart 0"
+
+PREFIX=$PWD/bench_results_$(date +"%Y-%m-%d_%H-%M-%S")
+
+mkdir "$PREFIX"
+
+for (( i=1; i <= TESTRUNS; i++ )); do
+	echo Round $i/$TESTRUNS
+	${CMD} --benchmark-timings "$PREFIX/timings-${i}.tsv" "$DEMOFILE" >/dev/null 2>&1
+	rm -f benchmark.data
+done
@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# replays a demo with the headless engine once with MultiThreadedUnitUpdate
+# off and once with it on, and checks that both runs produce the same sync
+# checksum in every SimFrame (timings of both runs are kept for comparison)
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 demo.sdf [minutes]"
+	exit 1
+fi
+
+DEMOFILE=$1
+MINUTES=${2:-5}
+
+CMD="./spring-headless --benchmark $MINUTES --benchmarkstart 0"
+
+PREFIX=$PWD/bench_mt_sync_$(date +"%Y-%m-%d_%H-%M-%S")
+
+mkdir "$PREFIX"
+
+for MT in 0 1; do
+	echo "MultiThreadedUnitUpdate = $MT" > "$PREFIX/springsettings-mt${MT}.cfg"
+
+	echo Run MultiThreadedUnitUpdate=$MT
+	${CMD} --config "$PREFIX/springsettings-mt${MT}.cfg" --benchmark-timings "$PREFIX/timings-mt${MT}.tsv" "$DEMOFILE" >/dev/null 2>&1
+	rm -f benchmark.data
+
+	# frame and sync_checksum columns
+	cut -f 1,2 "$PREFIX/timings-mt${MT}.tsv" > "$PREFIX/checksums-mt${MT}.tsv"
+done
+
+if ! diff -q "$PREFIX/checksums-mt0.tsv" "$PREFIX/checksums-mt1.tsv" >/dev/null; then
+	echo "sync checksums differ, first mismatching frames:"
+	diff "$PREFIX/checksums-mt0.tsv" "$PREFIX/checksums-mt1.tsv" | head -n 10
+	exit 1
+fi
+
+echo "sync checksums match in all $(($(wc -l < "$PREFIX/checksums-mt0.tsv") - 1)) frames"
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# loads a demo with the headless engine and writes the tested blocks and
+# time of a fixed set of long path-searches for every MoveDef, once with
+# no coarse estimator levels and once per level the game stacked (set by
+# the modrule system.pathFinderEstimatorLevels)
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 demo.sdf [startminute]"
+	exit 1
+fi
+
+DEMOFILE=$1
+STARTMINUTE=${2:-0}
+
+CMD="./spring-headless --benchmark 1 --benchmarkstart $STARTMINUTE"
+
+RESULTS=$PWD/bench_pathsearches_$(date +"%Y-%m-%d_%H-%M-%S").tsv
+
+${CMD} --benchmark-pathsearches "$RESULTS" "$DEMOFILE" >/dev/null 2>&1
+rm -f benchmark.data
+
+column -t -s "$(printf '\t')" "$RESULTS"